@@ -38,7 +38,9 @@
 	#endif
 	#define PKG_ST7735R_DC      GET_PIN(PKG_ST7735R_DC_GPIO, PKG_ST7735R_DC_PIN)
 	#define PKG_ST7735R_RES     GET_PIN(PKG_ST7735R_RES_GPIO, PKG_ST7735R_RES_PIN)
-	#define PKG_ST7735R_CLEAR_SEND_NUMBER 5760
+	#ifdef PKG_ST7735R_USING_TE
+		#define PKG_ST7735R_TE      GET_PIN(PKG_ST7735R_TE_GPIO, PKG_ST7735R_TE_PIN)
+	#endif
 #endif
 
 #define ST7735R_NOP 0x00	 // NOP
@@ -46,6 +48,7 @@
 #define ST7735R_RDDID 0x04   // Read Display ID
 #define ST7735R_SLPIN 0x10   // Sleep In
 #define ST7735R_SLPOUT 0x11  // Sleep Out
+#define ST7735R_NORON 0x13   // Normal Display Mode On
 #define ST7735R_INVOFF 0x20  // Display Inversion Off
 #define ST7735R_INVON 0x21   // Display Inversion On
 #define ST7735R_DISPOFF 0x28 // Display Off
@@ -53,7 +56,12 @@
 #define ST7735R_CASET 0x2A   // Column Address Set
 #define ST7735R_RASET 0x2B   // Row Address Set
 #define ST7735R_RAMWR 0x2C   // Memory Write
+#define ST7735R_RAMRD 0x2E   // Memory Read
+#define ST7735R_VSCRDEF 0x33 // Vertical Scrolling Definition
+#define ST7735R_TEOFF 0x34   // Tearing Effect Line Off
+#define ST7735R_TEON 0x35    // Tearing Effect Line On
 #define ST7735R_MADCTL 0x36  // Memory Data Access Control
+#define ST7735R_VSCSAD 0x37  // Vertical Scroll Start Address
 #define ST7735R_COLMOD 0x3A  // Interface Pixel Format
 #define ST7735R_FRMCTR1 0xB1 // Frame Rate Control (in normal mode)
 #define ST7735R_INVCTR 0xB4  // Display Inversion Control
@@ -66,314 +74,3439 @@
 #define ST7735R_GMCTRP1 0xE0 // Gamma (+ polarity) Correction Characteristics Setting
 #define ST7735R_GMCTRN1 0xE1 // Gamma (- polarity) Correction Characteristics Setting
 
-static rt_st7735r_t graphics_lcd;
+#define ST7735R_MADCTL_BGR (1 << 3)
+#define ST7735R_MADCTL_ML (1 << 4)  // Vertical Refresh Order
+#define ST7735R_MADCTL_MV (1 << 5)  // Row/Column Exchange
+#define ST7735R_MADCTL_MX (1 << 6)  // Column Address Order
+#define ST7735R_MADCTL_MY (1 << 7)  // Row Address Order
+
+#ifdef PKG_ST7735R_FPS
+	#define ST7735R_DEFAULT_FPS PKG_ST7735R_FPS
+#else
+	#define ST7735R_DEFAULT_FPS 60
+#endif
+
+#if defined(PKG_ST7735R_PANEL_REDTAB)
+	#define ST7735R_DEFAULT_PANEL RT_ST7735R_PANEL_REDTAB
+#elif defined(PKG_ST7735R_PANEL_GREENTAB)
+	#define ST7735R_DEFAULT_PANEL RT_ST7735R_PANEL_GREENTAB
+#else
+	#define ST7735R_DEFAULT_PANEL RT_ST7735R_PANEL_BLACKTAB
+#endif
+
+#if defined(PKG_ST7735R_COLMOD_12BIT)
+	#define ST7735R_DEFAULT_COLMOD RT_ST7735R_COLMOD_12BIT
+#elif defined(PKG_ST7735R_COLMOD_18BIT)
+	#define ST7735R_DEFAULT_COLMOD RT_ST7735R_COLMOD_18BIT
+#else
+	#define ST7735R_DEFAULT_COLMOD RT_ST7735R_COLMOD_16BIT
+#endif
+
+/* The write cycle of the ST7735R is 66 ns */
+#ifndef PKG_ST7735R_SPI_MAX_HZ
+	#define PKG_ST7735R_SPI_MAX_HZ 15000000
+#endif
+
+#ifdef PKG_ST7735R_SPI_3WIRE
+	#define ST7735R_SPI_MODE (RT_SPI_MASTER | RT_SPI_MODE_0 | RT_SPI_MSB | RT_SPI_3WIRE)
+#else
+	#define ST7735R_SPI_MODE (RT_SPI_MASTER | RT_SPI_MODE_0 | RT_SPI_MSB)
+#endif
+
+#ifdef PKG_ST7735R_USING_READBACK
+	#ifndef PKG_ST7735R_READ_MAX_HZ
+		#define PKG_ST7735R_READ_MAX_HZ 6000000
+	#endif
+	#ifndef PKG_ST7735R_RAMRD_DUMMY_BITS
+		#define PKG_ST7735R_RAMRD_DUMMY_BITS 8
+	#endif
+	#ifdef PKG_ST7735R_USING_SPI_TUNE
+		#ifndef PKG_ST7735R_SPI_TUNE_MAX_HZ
+			#define PKG_ST7735R_SPI_TUNE_MAX_HZ 40000000
+		#endif
+		#ifndef PKG_ST7735R_SPI_TUNE_STEP_HZ
+			#define PKG_ST7735R_SPI_TUNE_STEP_HZ 1000000
+		#endif
+		#ifndef PKG_ST7735R_SPI_TUNE_MARGIN
+			#define PKG_ST7735R_SPI_TUNE_MARGIN 10
+		#endif
+	#endif
+#endif
+
+#ifdef PKG_ST7735R_USING_RENDER
+	#ifndef PKG_ST7735R_RENDER_RING_SIZE
+		#define PKG_ST7735R_RENDER_RING_SIZE 32
+	#endif
+	#ifndef PKG_ST7735R_RENDER_THREAD_STACK
+		#define PKG_ST7735R_RENDER_THREAD_STACK 1024
+	#endif
+	#ifndef PKG_ST7735R_RENDER_THREAD_PRIORITY
+		#define PKG_ST7735R_RENDER_THREAD_PRIORITY 10
+	#endif
+#endif
+
+#ifdef PKG_ST7735R_USING_TILE_DIFF
+	#ifndef PKG_ST7735R_TILE_SIZE
+		#define PKG_ST7735R_TILE_SIZE 16
+	#endif
+#endif
+
+#ifdef PKG_ST7735R_USING_TEXT
+	#ifndef PKG_ST7735R_GLYPH_CACHE_SIZE
+		#define PKG_ST7735R_GLYPH_CACHE_SIZE 16
+	#endif
+	#ifndef PKG_ST7735R_GLYPH_MAX_PIXELS
+		#define PKG_ST7735R_GLYPH_MAX_PIXELS 128
+	#endif
+#endif
+
+#ifdef PKG_ST7735R_USING_STATS
+	#define ST7735R_STAT_ADD(dev, field, n)     ((dev)->stats.field += (n))
+	#define ST7735R_STAT_BEGIN()                rt_tick_t stat_start = rt_tick_get()
+	#define ST7735R_STAT_END(dev)               st7735r_stat_busy(dev, stat_start)
+#else
+	#define ST7735R_STAT_ADD(dev, field, n)
+	#define ST7735R_STAT_BEGIN()
+	#define ST7735R_STAT_END(dev)
+#endif
+
+#ifndef PKG_ST7735R_MAX_GRAPHIC_DEV
+	#define PKG_ST7735R_MAX_GRAPHIC_DEV 1
+#endif
+
+#ifdef PKG_ST7735R_USING_ASYNC
+static rt_err_t st7735r_async_wait(rt_st7735r_t dev, rt_int32_t timeout);
+#endif
 
-rt_inline rt_err_t st7735r_send(rt_st7735r_t dev, rt_bool_t is_data, rt_uint8_t data)
+#ifdef PKG_ST7735R_USING_STATS
+/* Account the time a caller was blocked in a write path since `start` */
+static void st7735r_stat_busy(rt_st7735r_t dev, rt_tick_t start)
 {
-    rt_pin_write(dev->dc_pin, is_data);
-    if (rt_spi_send(dev->spi, (const void *)(&data), 1) != 1)
-    {
-        LOG_E(LOG_TAG" send %s %d failed", is_data ? "data" : "command", data);
-        return -RT_ERROR;
-    }
-    else
-    {
-        return RT_EOK;
-    }
+	const rt_tick_t ticks = rt_tick_get() - start;
+	dev->stats.busy_ticks += ticks;
+	if (ticks > dev->stats.busy_max)
+	{
+		dev->stats.busy_max = ticks;
+	}
 }
+#endif
 
-static void st7735r_init_ori(rt_st7735r_t dev, rt_uint8_t orientation)
+static void st7735r_lock(rt_st7735r_t dev)
+{
+	rt_mutex_take(&dev->lock, RT_WAITING_FOREVER);
+}
+
+static void st7735r_unlock(rt_st7735r_t dev)
+{
+	rt_mutex_release(&dev->lock);
+}
+
+/*
+ * The dc level is only recorded here and driven by each transfer while it
+ * holds the bus, so panels sharing a bus, and even a dc pin, never see
+ * each other's level.
+ */
+static void st7735r_dc(rt_st7735r_t dev, rt_uint8_t level)
+{
+	dev->dc_level = level;
+}
+
+/* Set the write clock, reads slow the bus down further by themselves */
+static void st7735r_spi_clock(rt_st7735r_t dev, rt_uint32_t hz)
+{
+	struct rt_spi_configuration config;
+	config.data_width = 8;
+	config.mode = ST7735R_SPI_MODE;
+	config.max_hz = hz;
+	rt_spi_configure(dev->spi, &config);
+	dev->spi_hz = hz;
+}
+
+static rt_err_t st7735r_spi_send(rt_st7735r_t dev, const void *buf, rt_size_t len)
 {
-	uint8_t param = 0;
-	switch (orientation)
+	rt_err_t result = RT_EOK;
+	++dev->spi_transfers;
+	ST7735R_STAT_ADD(dev, bytes, len);
+#ifdef PKG_ST7735R_USING_TRACE
+	if (dev->trace)
 	{
-	case 1:
-		param = 1 << 5 | 1 << 7;
-		break;
-	case 2:
-		param = 1 << 7 | 1 << 6;
-		break;
-	case 3:
-		param = 1 << 5 | 1 << 6;
-		break;
-	default:
-		break;
+		dev->trace(dev, dev->dc_level == PIN_HIGH, buf, len);
 	}
-	// param |= config.is_bgr << 4;
-
-	st7735r_send(dev, RT_FALSE, ST7735R_MADCTL);
-	st7735r_send(dev, RT_TRUE, param);
+#endif
+	rt_spi_take_bus(dev->spi);
+	rt_pin_write(dev->dc_pin, dev->dc_level);
+	if (rt_spi_send(dev->spi, buf, len) != len)
+	{
+		LOG_E(LOG_TAG" send %d bytes failed", len);
+		ST7735R_STAT_ADD(dev, errors, 1);
+		result = -RT_ERROR;
+	}
+	rt_spi_release_bus(dev->spi);
+	return result;
 }
 
-static void st7735r_init_frmctr(rt_st7735r_t dev, rt_uint8_t fps)
+/*
+ * Send the same `len` bytes `times` times. Up to ST7735R_REPEAT_MESSAGES
+ * copies are chained into one message list so the bus is only taken once.
+ */
+#define ST7735R_REPEAT_MESSAGES 8
+
+static rt_err_t st7735r_spi_repeat(rt_st7735r_t dev, const void *buf, rt_size_t len, rt_uint32_t times)
 {
-	const rt_uint8_t line = 160;
-	const rt_uint32_t fosc = 850000;
-	rt_uint32_t best_rtna = 0;
-	rt_uint32_t best_fpa = 0;
-	rt_uint32_t best_bpa = 0;
-	rt_uint32_t min_diff = (rt_uint32_t)(-1);
-	for (rt_uint32_t rtna = 0; rtna <= 0x0F; ++rtna)
+	struct rt_spi_message msg[ST7735R_REPEAT_MESSAGES];
+	while (times)
 	{
-		const rt_uint32_t this_rtna = rtna * 2 + 40;
-		for (rt_uint32_t fpa = 1; fpa <= 0x3F; ++fpa)
+		const rt_uint32_t n = times < ST7735R_REPEAT_MESSAGES ? times : ST7735R_REPEAT_MESSAGES;
+		for (rt_uint32_t i = 0; i < n; ++i)
 		{
-			for (rt_uint32_t bpa = 1; bpa <= 0x3F; ++bpa)
+			msg[i].send_buf = buf;
+			msg[i].recv_buf = RT_NULL;
+			msg[i].length = len;
+			msg[i].cs_take = i == 0;
+			msg[i].cs_release = i == n - 1;
+			msg[i].next = i == n - 1 ? RT_NULL : &msg[i + 1];
+#ifdef PKG_ST7735R_USING_TRACE
+			if (dev->trace)
 			{
-				const rt_uint32_t this_rate = fosc / (this_rtna * (line + fpa + bpa + 2));
-				const rt_uint32_t this_diff = (int32_t)(this_rate - fps) < 0 ? fps - this_rate : this_rate - fps;
-				if (this_diff < min_diff)
-				{
-					min_diff = this_diff;
-					best_rtna = rtna;
-					best_fpa = fpa;
-					best_bpa = bpa;
-				}
-				if (min_diff == 0)
-				{
-					break;
-				}
+				dev->trace(dev, dev->dc_level == PIN_HIGH, buf, len);
 			}
+#endif
+		}
+		++dev->spi_transfers;
+		ST7735R_STAT_ADD(dev, bytes, n * len);
+		rt_spi_take_bus(dev->spi);
+		rt_pin_write(dev->dc_pin, dev->dc_level);
+		const rt_bool_t failed = rt_spi_transfer_message(dev->spi, msg) != RT_NULL;
+		rt_spi_release_bus(dev->spi);
+		if (failed)
+		{
+			LOG_E(LOG_TAG" send %d x %d bytes failed", n, len);
+			ST7735R_STAT_ADD(dev, errors, 1);
+			return -RT_ERROR;
 		}
+		times -= n;
 	}
+	return RT_EOK;
+}
 
-	st7735r_send(dev, RT_FALSE, ST7735R_FRMCTR1);
-	st7735r_send(dev, RT_TRUE, best_rtna);
-	st7735r_send(dev, RT_TRUE, best_fpa);
-	st7735r_send(dev, RT_TRUE, best_bpa);
-}
-
-static void st7735r_init_pwctr(rt_st7735r_t dev)
-{
-	st7735r_send(dev, RT_FALSE, ST7735R_PWCTR1);
-	st7735r_send(dev, RT_TRUE, 0xA2);
-	st7735r_send(dev, RT_TRUE, 0x02);
-	st7735r_send(dev, RT_TRUE, 0x84);
-
-	st7735r_send(dev, RT_FALSE, ST7735R_PWCTR2);
-	st7735r_send(dev, RT_TRUE, 0xC5);
-
-	st7735r_send(dev, RT_FALSE, ST7735R_PWCTR3);
-	st7735r_send(dev, RT_TRUE, 0x0A);
-	st7735r_send(dev, RT_TRUE, 0x00);
-
-	st7735r_send(dev, RT_FALSE, ST7735R_PWCTR4);
-	st7735r_send(dev, RT_TRUE, 0x8A);
-	st7735r_send(dev, RT_TRUE, 0x2A);
-
-	st7735r_send(dev, RT_FALSE, ST7735R_PWCTR5);
-	st7735r_send(dev, RT_TRUE, 0x8A);
-	st7735r_send(dev, RT_TRUE, 0xEE);
-}
-
-static void st7735r_init_gamma(rt_st7735r_t dev)
-{
-	st7735r_send(dev, RT_FALSE, ST7735R_GMCTRP1);
-	st7735r_send(dev, RT_TRUE, 0x02);
-	st7735r_send(dev, RT_TRUE, 0x1C);
-	st7735r_send(dev, RT_TRUE, 0x07);
-	st7735r_send(dev, RT_TRUE, 0x12);
-	st7735r_send(dev, RT_TRUE, 0x37);
-	st7735r_send(dev, RT_TRUE, 0x32);
-	st7735r_send(dev, RT_TRUE, 0x29);
-	st7735r_send(dev, RT_TRUE, 0x2D);
-	st7735r_send(dev, RT_TRUE, 0x29);
-	st7735r_send(dev, RT_TRUE, 0x25);
-	st7735r_send(dev, RT_TRUE, 0x2B);
-	st7735r_send(dev, RT_TRUE, 0x39);
-	st7735r_send(dev, RT_TRUE, 0x00);
-	st7735r_send(dev, RT_TRUE, 0x01);
-	st7735r_send(dev, RT_TRUE, 0x03);
-	st7735r_send(dev, RT_TRUE, 0x10);
-
-	st7735r_send(dev, RT_FALSE, ST7735R_GMCTRN1);
-	st7735r_send(dev, RT_TRUE, 0x03);
-	st7735r_send(dev, RT_TRUE, 0x1D);
-	st7735r_send(dev, RT_TRUE, 0x07);
-	st7735r_send(dev, RT_TRUE, 0x06);
-	st7735r_send(dev, RT_TRUE, 0x2E);
-	st7735r_send(dev, RT_TRUE, 0x2C);
-	st7735r_send(dev, RT_TRUE, 0x29);
-	st7735r_send(dev, RT_TRUE, 0x2D);
-	st7735r_send(dev, RT_TRUE, 0x2E);
-	st7735r_send(dev, RT_TRUE, 0x2E);
-	st7735r_send(dev, RT_TRUE, 0x37);
-	st7735r_send(dev, RT_TRUE, 0x3F);
-	st7735r_send(dev, RT_TRUE, 0x00);
-	st7735r_send(dev, RT_TRUE, 0x00);
-	st7735r_send(dev, RT_TRUE, 0x02);
-	st7735r_send(dev, RT_TRUE, 0x10);
+/* Send a command followed by its parameters as a single data burst */
+static rt_err_t st7735r_write_cmd(rt_st7735r_t dev, rt_uint8_t cmd, const rt_uint8_t *param, rt_size_t len)
+{
+#ifdef PKG_ST7735R_USING_ASYNC
+	/* Synchronous commands must not cut into a queued write */
+	st7735r_async_wait(dev, RT_WAITING_FOREVER);
+#endif
+	// any command ends a RAMWR run
+	dev->ramwr_open = RT_FALSE;
+	rt_err_t result;
+	rt_spi_take_bus(dev->spi);
+	st7735r_dc(dev, PIN_LOW);
+	result = st7735r_spi_send(dev, &cmd, 1);
+	if (result == RT_EOK && len)
+	{
+		st7735r_dc(dev, PIN_HIGH);
+		result = st7735r_spi_send(dev, param, len);
+	}
+	rt_spi_release_bus(dev->spi);
+	return result;
 }
 
-void st7735r_set_active_rect(rt_st7735r_t dev, rt_uint8_t x, rt_uint8_t y, rt_uint8_t width, rt_uint8_t height)
+/*
+ * A burst is one graphic op, window and pixels, sent while holding the bus.
+ * Queued writes go first, their tx thread needs the bus to drain.
+ */
+static void st7735r_burst_begin(rt_st7735r_t dev)
+{
+#ifdef PKG_ST7735R_USING_ASYNC
+	st7735r_async_wait(dev, RT_WAITING_FOREVER);
+#endif
+	rt_spi_take_bus(dev->spi);
+}
+
+static void st7735r_burst_end(rt_st7735r_t dev)
 {
-	st7735r_send(dev, RT_FALSE, ST7735R_CASET);
-	// start
-	st7735r_send(dev, RT_TRUE, 0x00);
-	st7735r_send(dev, RT_TRUE, x);
-	// end
-	st7735r_send(dev, RT_TRUE, 0x00);
-	st7735r_send(dev, RT_TRUE, x + width - 1);
+	rt_spi_release_bus(dev->spi);
+}
 
-	st7735r_send(dev, RT_FALSE, ST7735R_RASET);
-	st7735r_send(dev, RT_TRUE, 0x00);
-	st7735r_send(dev, RT_TRUE, y);
-	st7735r_send(dev, RT_TRUE, 0x00);
-	st7735r_send(dev, RT_TRUE, y + height - 1);
+/*
+ * Pixel streaming: RAMWR is issued once and DC is left high, pixels are then
+ * staged big-endian into tx_buf, packed to the interface pixel format and
+ * sent PKG_ST7735R_TX_BUF_SIZE bytes at a time.
+ */
+static void st7735r_ramwr_begin(rt_st7735r_t dev)
+{
+	st7735r_write_cmd(dev, ST7735R_RAMWR, RT_NULL, 0);
+	st7735r_dc(dev, PIN_HIGH);
+	dev->tx_len = 0;
+	dev->ramwr_open = RT_TRUE;
+	dev->ramwr_pos = 0;
+	dev->pack.odd = RT_FALSE;
+	ST7735R_STAT_ADD(dev, ramwr, 1);
 }
 
-void st7735r_clear(rt_st7735r_t dev, rt_uint16_t color)
+/*
+ * Whether the open RAMWR run writes its next `count` pixels to (x, y)..(x + count - 1, y),
+ * so they can be appended without touching the window.
+ */
+static rt_bool_t st7735r_ramwr_continues(rt_st7735r_t dev, int x, int y, rt_size_t count)
 {
-    st7735r_set_active_rect(dev, 0, 0, dev->width, dev->height);
-	st7735r_fill_color(dev, color);
+	if (!dev->ramwr_open || dev->rect.width == 0 || dev->rect.height == 0)
+	{
+		return RT_FALSE;
+	}
+	const rt_uint32_t col = dev->ramwr_pos % dev->rect.width;
+	const rt_uint32_t row = dev->ramwr_pos / dev->rect.width % dev->rect.height;
+	return dev->rect.x + col == (rt_uint32_t)x && dev->rect.y + row == (rt_uint32_t)y && col + count <= dev->rect.width;
 }
 
-void st7735r_fill_color(rt_st7735r_t dev, rt_uint16_t color)
+/* Send what is staged, a 12-bit pixel waiting for its pair stays behind */
+static void st7735r_ramwr_drain(rt_st7735r_t dev)
 {
-	st7735r_send(dev, RT_FALSE, ST7735R_RAMWR);
-	const rt_uint32_t max = 128 * 160;
-	for (rt_uint32_t i = 0; i < max; ++i)
+	if (dev->tx_len)
 	{
-		st7735r_send(dev, RT_TRUE, color >> 8);
-		st7735r_send(dev, RT_TRUE, color);
+		st7735r_spi_send(dev, dev->tx_buf, dev->tx_len);
+		dev->tx_len = 0;
 	}
 }
 
-void st7735r_show_grayscale_pixel(rt_st7735r_t dev, const rt_uint8_t *pixel, rt_size_t length)
+static void st7735r_ramwr_flush(rt_st7735r_t dev)
 {
-	st7735r_send(dev, RT_FALSE, ST7735R_RAMWR);
-	for (rt_uint32_t i = 0; i < length; ++i)
+	rt_size_t pad = st7735r_pack_finish(&dev->pack, dev->tx_buf + dev->tx_len);
+	if (pad)
 	{
-		rt_uint8_t gs_color = pixel[i];
-		const uint16_t color = ((gs_color >> 3) << 11) | ((gs_color >> 2) << 5) | (gs_color >> 3);
-		st7735r_send(dev, RT_TRUE, color >> 8);
-		st7735r_send(dev, RT_TRUE, color);
+		// the padded pixel leaves half a pixel in the controller, the run can not be continued
+		dev->tx_len += pad;
+		dev->ramwr_open = RT_FALSE;
 	}
+	st7735r_ramwr_drain(dev);
 }
 
-void st7735r_show_color_pixel(rt_st7735r_t dev, const rt_uint16_t *pixel, rt_size_t length)
+/* Stage `count` pixels of one color */
+static void st7735r_ramwr_stage(rt_st7735r_t dev, rt_uint16_t color, rt_uint32_t count)
 {
-	st7735r_send(dev, RT_FALSE, ST7735R_RAMWR);
-	for (rt_uint32_t i = 0; i < length; ++i)
+	while (count)
 	{
-		st7735r_send(dev, RT_TRUE, pixel[i] >> 8);
-		st7735r_send(dev, RT_TRUE, pixel[i]);
+		rt_uint32_t n = st7735r_pack_room(&dev->pack, PKG_ST7735R_TX_BUF_SIZE - dev->tx_len);
+		if (n == 0)
+		{
+			st7735r_ramwr_drain(dev);
+			continue;
+		}
+		if (n > count)
+		{
+			n = count;
+		}
+		rt_uint8_t *buf = st7735r_pack_src(&dev->pack, dev->tx_buf + dev->tx_len, n);
+		for (rt_uint32_t i = 0; i < n; ++i)
+		{
+			*buf++ = color >> 8;
+			*buf++ = color;
+		}
+		dev->tx_len += st7735r_pack(&dev->pack, dev->tx_buf + dev->tx_len, n);
+		dev->ramwr_pos += n;
+		ST7735R_STAT_ADD(dev, pixels, n);
+		count -= n;
 	}
 }
 
-void st7735r_set_bl(rt_st7735r_t dev, rt_bool_t on)
+/*
+ * Stream `count` pixels of one color. Fills larger than the staging buffer
+ * replicate the packed color across tx_buf once and send that block again
+ * and again, the rest goes out as a prefix of it.
+ */
+static void st7735r_ramwr_fill(rt_st7735r_t dev, rt_uint16_t color, rt_uint32_t count)
 {
-#ifdef PKG_ST7735R_ADJ_BL
-	if (on)
+	// pixels and bytes of the smallest repeating unit, 12-bit pixels pair up into 3 bytes
+	const rt_uint32_t unit = dev->pack.bits == 12 ? 2 : 1;
+	const rt_size_t unit_len = dev->pack.bits == 16 ? 2 : 3;
+	const rt_size_t block = PKG_ST7735R_TX_BUF_SIZE / unit_len * unit_len;
+	const rt_uint32_t block_pixels = block / unit_len * unit;
+	if (dev->pack.odd && count)
 	{
-		rt_size_t period = 1000000000 / PKG_ST7735R_BL_PWM_FREQ;
-		rt_pwm_set(dev->bl_pwm, dev->bl_channel, period, period * dev->bl_value / 100);
-		rt_pwm_enable(dev->bl_pwm, dev->bl_channel);
+		st7735r_ramwr_stage(dev, color, 1);
+		--count;
 	}
-	else
+	if (count < block_pixels)
 	{
-		rt_pwm_disable(dev->bl_pwm, dev->bl_channel);
+		st7735r_ramwr_stage(dev, color, count);
+		return;
+	}
+	st7735r_ramwr_drain(dev);
+	rt_uint8_t *buf = st7735r_pack_src(&dev->pack, dev->tx_buf, unit);
+	for (rt_uint32_t i = 0; i < unit; ++i)
+	{
+		*buf++ = color >> 8;
+		*buf++ = color;
+	}
+	st7735r_pack(&dev->pack, dev->tx_buf, unit);
+	for (rt_size_t len = unit_len; len < block; len *= 2)
+	{
+		rt_memcpy(dev->tx_buf + len, dev->tx_buf, len * 2 <= block ? len : block - len);
+	}
+	const rt_uint32_t rest = count % block_pixels;
+	st7735r_spi_repeat(dev, dev->tx_buf, block, count / block_pixels);
+	if (rest >= unit)
+	{
+		st7735r_spi_send(dev, dev->tx_buf, rest / unit * unit_len);
 	}
+	dev->ramwr_pos += count - rest % unit;
+	ST7735R_STAT_ADD(dev, pixels, count - rest % unit);
+	// an unpaired 12-bit pixel is staged for the flush to pad
+	st7735r_ramwr_stage(dev, color, rest % unit);
+}
+
+/*
+ * Write formats, indexed by the RT_ST7735R_WRITE_* codes. Sub-byte formats
+ * are packed MSB first and always converted in whole source bytes. Streams
+ * (bits 0) are decoded through cvt_ctx.rle and have no source offset.
+ * Wire formats are already what a 16-bit interface sends, long runs of
+ * them go out straight from the caller's buffer.
+ */
+#ifdef PKG_ST7735R_CVT_REFERENCE
+	#define ST7735R_CVT(name)   st7735r_cvt_##name##_ref
 #else
-	rt_pin_write(dev->bl_pin, on);
+	#define ST7735R_CVT(name)   st7735r_cvt_##name
 #endif
+
+#define ST7735R_FORMAT_PALETTE  0x01
+#define ST7735R_FORMAT_WIRE     0x02
+
+struct st7735r_format
+{
+	st7735r_cvt_t cvt;
+	rt_uint8_t bits;
+	rt_uint8_t flags;
+};
+
+static const struct st7735r_format st7735r_formats[] =
+{
+	[RT_ST7735R_WRITE_COLOR_PIXEL] = {ST7735R_CVT(rgb565), 16},
+	[RT_ST7735R_WRITE_GRAYSCALE_PIXEL] = {ST7735R_CVT(gray8), 8},
+	[RT_ST7735R_WRITE_RGB888_PIXEL] = {ST7735R_CVT(rgb888), 24},
+	[RT_ST7735R_WRITE_ARGB8888_PIXEL] = {ST7735R_CVT(argb8888), 32},
+	[RT_ST7735R_WRITE_RGB332_PIXEL] = {ST7735R_CVT(rgb332), 8},
+	[RT_ST7735R_WRITE_INDEX1_PIXEL] = {ST7735R_CVT(index1), 1, ST7735R_FORMAT_PALETTE},
+	[RT_ST7735R_WRITE_INDEX2_PIXEL] = {ST7735R_CVT(index2), 2, ST7735R_FORMAT_PALETTE},
+	[RT_ST7735R_WRITE_INDEX4_PIXEL] = {ST7735R_CVT(index4), 4, ST7735R_FORMAT_PALETTE},
+	[RT_ST7735R_WRITE_INDEX8_PIXEL] = {ST7735R_CVT(index8), 8, ST7735R_FORMAT_PALETTE},
+	[RT_ST7735R_WRITE_RLE565_PIXEL] = {st7735r_cvt_rle565, 0},
+	[RT_ST7735R_WRITE_COLOR_SWAP_PIXEL] = {st7735r_cvt_rgb565be, 16, ST7735R_FORMAT_WIRE},
+};
+
+static const struct st7735r_format *st7735r_get_format(rt_st7735r_t dev, rt_off_t pos)
+{
+	if (pos < 0 || (rt_size_t)pos >= sizeof(st7735r_formats) / sizeof(st7735r_formats[0]) || st7735r_formats[pos].cvt == RT_NULL)
+	{
+		return RT_NULL;
+	}
+	if ((st7735r_formats[pos].flags & ST7735R_FORMAT_PALETTE) && dev->cvt_ctx.palette == RT_NULL)
+	{
+		LOG_E(LOG_TAG" indexed write without a palette");
+		return RT_NULL;
+	}
+	return &st7735r_formats[pos];
 }
 
-static rt_err_t st7735r_init(rt_device_t dev)
+/* How many of `count` pixels to convert when `n` more fit in the staging buffer */
+static rt_uint32_t st7735r_format_chunk(const struct st7735r_format *fmt, rt_uint32_t n, rt_uint32_t count)
 {
-	rt_st7735r_t st7735r_dev = (rt_st7735r_t)dev;
-    struct rt_spi_configuration spi_config;
-    spi_config.data_width = 8;
-    spi_config.mode = RT_SPI_MASTER | RT_SPI_MODE_0 | RT_SPI_MSB;
-    /* Max freq of ST7735R is 15MHz */
-	spi_config.max_hz = 15 * 1000 * 1000;
-    rt_spi_configure(st7735r_dev->spi, &spi_config);
-	
-	rt_pin_write(st7735r_dev->res_pin, PIN_LOW);
-	rt_thread_mdelay(100);
-	rt_pin_write(st7735r_dev->res_pin, PIN_HIGH);
-#if !defined(PKG_ST7735R_ADJ_BL)
-		rt_pin_write(st7735r_dev->bl_pin, PIN_LOW);
+	if (n >= count)
+	{
+		return count;
+	}
+	return fmt->bits && fmt->bits < 8 ? n - n % (8 / fmt->bits) : n;
+}
+
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+#define ST7735R_FB_WRITE        0x00
+#define ST7735R_FB_FILL         0x01
+#define ST7735R_FB_READ         0x02
+
+static void st7735r_fb_access(rt_st7735r_t dev, const struct rt_st7735r_rect *rect, rt_uint8_t mode, const void *src, void *dst, rt_uint32_t start, rt_size_t count);
 #endif
-	rt_pin_write(st7735r_dev->dc_pin, PIN_HIGH);
 
-    st7735r_send(st7735r_dev, RT_FALSE, ST7735R_SWRESET);
-    rt_thread_mdelay(10);
+/*
+ * Stream `count` pixels through a converter, the staged pixels are also
+ * copied into the framebuffer when `mirror` is set.
+ */
+static void st7735r_ramwr_convert(rt_st7735r_t dev, const struct st7735r_format *fmt, const void *src, rt_uint32_t count, rt_bool_t mirror)
+{
+#ifndef PKG_ST7735R_USING_FRAMEBUFFER
+	(void)mirror;
+#endif
+	const rt_uint8_t *pixel = (const rt_uint8_t *)src;
+	if ((fmt->flags & ST7735R_FORMAT_WIRE) && dev->pack.bits == 16 && count * 2 >= PKG_ST7735R_TX_BUF_SIZE)
+	{
+		// a whole staging buffer or more, skip the copy
+		st7735r_ramwr_drain(dev);
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+		if (mirror && dev->framebuffer)
+		{
+			st7735r_fb_access(dev, &dev->rect, ST7735R_FB_WRITE, pixel, RT_NULL, dev->ramwr_pos, count);
+		}
+#endif
+		st7735r_spi_send(dev, pixel, count * 2);
+		dev->ramwr_pos += count;
+		ST7735R_STAT_ADD(dev, pixels, count);
+		return;
+	}
+	while (count)
+	{
+		rt_uint32_t n = st7735r_format_chunk(fmt, st7735r_pack_room(&dev->pack, PKG_ST7735R_TX_BUF_SIZE - dev->tx_len), count);
+		if (n == 0)
+		{
+			st7735r_ramwr_drain(dev);
+			continue;
+		}
+		rt_uint8_t *buf = st7735r_pack_src(&dev->pack, dev->tx_buf + dev->tx_len, n);
+		fmt->cvt(buf, pixel, n, &dev->cvt_ctx);
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+		if (mirror && dev->framebuffer)
+		{
+			st7735r_fb_access(dev, &dev->rect, ST7735R_FB_WRITE, buf, RT_NULL, dev->ramwr_pos, n);
+		}
+#endif
+		dev->tx_len += st7735r_pack(&dev->pack, dev->tx_buf + dev->tx_len, n);
+		dev->ramwr_pos += n;
+		ST7735R_STAT_ADD(dev, pixels, n);
+		pixel += n * fmt->bits / 8;
+		count -= n;
+	}
+}
 
-    st7735r_send(st7735r_dev, RT_FALSE, ST7735R_SLPOUT);
-	rt_thread_mdelay(120);
+/* Stream `count` pixels into the open RAMWR, RLE runs go out through the fill path */
+static void st7735r_ramwr_write(rt_st7735r_t dev, const struct st7735r_format *fmt, const void *src, rt_uint32_t count)
+{
+	if (fmt->bits)
+	{
+		st7735r_ramwr_convert(dev, fmt, src, count, RT_TRUE);
+		return;
+	}
+	struct st7735r_rle rle;
+	st7735r_rle_init(&rle, src);
+	dev->cvt_ctx.rle = &rle;
+	while (count)
+	{
+		rt_uint32_t n = st7735r_rle_next(&rle);
+		if (n > count)
+		{
+			n = count;
+		}
+		if (rle.run)
+		{
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+			if (dev->framebuffer)
+			{
+				st7735r_fb_access(dev, &dev->rect, ST7735R_FB_FILL, &rle.color, RT_NULL, dev->ramwr_pos, n);
+			}
+#endif
+			st7735r_ramwr_fill(dev, rle.color, n);
+			rle.left -= n;
+		}
+		else
+		{
+			st7735r_ramwr_convert(dev, fmt, RT_NULL, n, RT_TRUE);
+		}
+		count -= n;
+	}
+	dev->cvt_ctx.rle = RT_NULL;
+}
 
-    st7735r_init_ori(st7735r_dev, st7735r_dev->ori);
+/* Send `height` rows of `width` pixels, `stride` bytes apart, to one window in one RAMWR */
+static void st7735r_ramwr_blit(rt_st7735r_t dev, const struct st7735r_format *fmt, const rt_uint8_t *src, rt_size_t stride, rt_uint16_t x, rt_uint16_t y, rt_uint16_t width, rt_uint16_t height, rt_bool_t mirror)
+{
+	const struct rt_st7735r_rect rect = dev->rect;
+	ST7735R_STAT_BEGIN();
+	st7735r_burst_begin(dev);
+	st7735r_set_active_rect(dev, x, y, width, height);
+	st7735r_ramwr_begin(dev);
+	for (rt_uint16_t row = 0; row < height; ++row)
+	{
+		st7735r_ramwr_convert(dev, fmt, src + row * stride, width, mirror);
+	}
+	st7735r_ramwr_flush(dev);
+	st7735r_set_active_rect(dev, rect.x, rect.y, rect.width, rect.height);
+	st7735r_burst_end(dev);
+	ST7735R_STAT_END(dev);
+}
 
-	// 16-bit
-	st7735r_send(st7735r_dev, RT_FALSE, ST7735R_COLMOD);
-	st7735r_send(st7735r_dev, RT_TRUE, 0x05);
+/*
+ * Init scripts: command, parameter count, parameters, and a delay in ms
+ * after the parameters when the count has ST7735R_SCRIPT_DELAY set.
+ */
+#define ST7735R_SCRIPT_DELAY 0x80
 
-    /* Set to 60FPS */
-	st7735r_init_frmctr(st7735r_dev, 60);
-	st7735r_init_pwctr(st7735r_dev);
-	st7735r_init_gamma(st7735r_dev);
+/* Only run on a cold init, a hot reinit keeps the controller awake */
+static const rt_uint8_t st7735r_script_reset[] =
+{
+	ST7735R_SWRESET, ST7735R_SCRIPT_DELAY, 10,
+	ST7735R_SLPOUT, ST7735R_SCRIPT_DELAY, 120,
+};
 
-	st7735r_send(st7735r_dev, RT_FALSE, ST7735R_VMCTR1);
-	st7735r_send(st7735r_dev, RT_TRUE, 0x0E);
+/*
+ * Power and gamma setup. The tabs only differ in how the glass is wired to
+ * the GRAM (colour order, GRAM size and offset), which the panel table
+ * below covers, so they share this script. A module that needs its own
+ * settings gets its own script in the table.
+ */
+static const rt_uint8_t st7735r_script_config[] =
+{
+	ST7735R_PWCTR1, 3, 0xA2, 0x02, 0x84,
+	ST7735R_PWCTR2, 1, 0xC5,
+	ST7735R_PWCTR3, 2, 0x0A, 0x00,
+	ST7735R_PWCTR4, 2, 0x8A, 0x2A,
+	ST7735R_PWCTR5, 2, 0x8A, 0xEE,
+	ST7735R_GMCTRP1, 16,
+		0x02, 0x1C, 0x07, 0x12, 0x37, 0x32, 0x29, 0x2D,
+		0x29, 0x25, 0x2B, 0x39, 0x00, 0x01, 0x03, 0x10,
+	ST7735R_GMCTRN1, 16,
+		0x03, 0x1D, 0x07, 0x06, 0x2E, 0x2C, 0x29, 0x2D,
+		0x2E, 0x2E, 0x37, 0x3F, 0x00, 0x00, 0x02, 0x10,
+	ST7735R_VMCTR1, 1, 0x0E,
+	// leaves scroll mode after a hot reinit
+	ST7735R_NORON, 0,
+};
 
-	st7735r_set_active_rect(st7735r_dev, 0, 0, st7735r_dev->width, st7735r_dev->height);
+struct st7735r_panel
+{
+	const rt_uint8_t *script;
+	rt_uint16_t script_len;
+	/* MADCTL bits ORed into every orientation */
+	rt_uint8_t madctl;
+	/* GRAM size set by the GM pins of the module, 132x162 or 128x160 */
+	rt_uint8_t gram_width;
+	rt_uint8_t gram_height;
+	/* GRAM offset of the visible area in orientation 0 */
+	rt_uint8_t x_offset;
+	rt_uint8_t y_offset;
+};
 
-	st7735r_send(st7735r_dev, RT_FALSE, ST7735R_DISPON);
-	rt_thread_mdelay(10);
-	return RT_EOK;
-}
+static const struct st7735r_panel st7735r_panels[] =
+{
+	// the black tab shows the far corner of its GRAM, at address 0 in the default orientation 2
+	[RT_ST7735R_PANEL_BLACKTAB] = {st7735r_script_config, sizeof(st7735r_script_config), 0, 132, 162, 4, 2},
+	[RT_ST7735R_PANEL_REDTAB] = {st7735r_script_config, sizeof(st7735r_script_config), ST7735R_MADCTL_BGR, 128, 160, 0, 0},
+	[RT_ST7735R_PANEL_GREENTAB] = {st7735r_script_config, sizeof(st7735r_script_config), ST7735R_MADCTL_BGR, 132, 162, 2, 1},
+};
 
-static rt_err_t st7735r_open(rt_device_t dev, rt_uint16_t oflag)
+static void st7735r_run_script(rt_st7735r_t dev, const rt_uint8_t *script, rt_size_t len)
 {
-	rt_st7735r_t lcd = (rt_st7735r_t)dev;
-    st7735r_clear(lcd, 0x0);
-	st7735r_set_bl(lcd, RT_TRUE);
-	return RT_EOK;
+	const rt_uint8_t *end = script + len;
+	while (script < end)
+	{
+		const rt_uint8_t cmd = *script++;
+		const rt_uint8_t count = *script & ~ST7735R_SCRIPT_DELAY;
+		const rt_bool_t delay = (*script++ & ST7735R_SCRIPT_DELAY) != 0;
+		st7735r_write_cmd(dev, cmd, script, count);
+		script += count;
+		if (delay)
+		{
+			rt_thread_mdelay(*script++);
+		}
+	}
 }
 
-static rt_err_t st7735r_close(rt_device_t dev)
+/* MADCTL of each orientation, before the panel's own bits */
+static const rt_uint8_t st7735r_ori_madctl[4] =
 {
-	if (dev->ref_count == 0)
-	{
-		rt_st7735r_t lcd = (rt_st7735r_t)dev;
-    	st7735r_clear(lcd, 0x0);
-#ifdef PKG_ST7735R_ADJ_BL
-		rt_pwm_disable(lcd->bl_pwm, lcd->bl_channel);
+	0,
+	ST7735R_MADCTL_MV | ST7735R_MADCTL_MY,
+	ST7735R_MADCTL_MY | ST7735R_MADCTL_MX,
+	ST7735R_MADCTL_MV | ST7735R_MADCTL_MX,
+};
+
+#ifdef PKG_ST7735R_USING_VSYNC
+/* Refresh bottom to top when the rows are addressed bottom to top, so a write can follow the scan */
+#define ST7735R_MADCTL_SCAN(madctl) (((madctl) & (ST7735R_MADCTL_MV | ST7735R_MADCTL_MY)) == ST7735R_MADCTL_MY ? ST7735R_MADCTL_ML : 0)
 #else
-		rt_pin_write(lcd->bl_pin, PIN_LOW);
+#define ST7735R_MADCTL_SCAN(madctl) 0
 #endif
-	}
-	return RT_EOK;
-}
 
-static rt_size_t st7735r_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+static void st7735r_init_ori(rt_st7735r_t dev, rt_uint8_t orientation)
 {
-	//TODO: finding a way to complete this function without adding a frame buffer
-	return 0;
+	const rt_uint8_t madctl = st7735r_ori_madctl[orientation & 3];
+	const rt_uint8_t param = madctl | ST7735R_MADCTL_SCAN(madctl) | st7735r_panels[dev->panel].madctl;
+	st7735r_write_cmd(dev, ST7735R_MADCTL, &param, 1);
 }
 
-static rt_size_t st7735r_write(rt_device_t _dev, rt_off_t pos, const void *buffer, rt_size_t size)
+/*
+ * Frame rate = fosc / ((RTNA * 2 + 40) * (LINE + FPA + BPA + 2)), RTNA is 0 to 15
+ * and FPA/BPA are 1 to 63, which limits the rate to ST7735R_FPS_MIN..ST7735R_FPS_MAX.
+ */
+#define ST7735R_FOSC 850000
+#define ST7735R_FRMCTR_LINE 160
+#define ST7735R_FPS_MIN 43
+#define ST7735R_FPS_MAX 129
+
+#ifdef PKG_ST7735R_FRMCTR_TABLE
+/* {RTNA, FPA, BPA} closest to each integer rate, generated with st7735r_frmctr_solve() */
+static const rt_uint8_t st7735r_frmctr_table[ST7735R_FPS_MAX - ST7735R_FPS_MIN + 1][3] =
 {
-	rt_st7735r_t dev = (rt_st7735r_t)_dev;
-	switch (pos)
-	{
-	case RT_ST7735R_WRITE_COLOR_PIXEL:
+	{0x0F, 0x3C, 0x3C}, {0x0F, 0x39, 0x39}, {0x0F, 0x36, 0x36}, {0x0D, 0x3B, 0x3B}, // 43-46
+	{0x0D, 0x38, 0x38}, {0x0F, 0x2D, 0x2E}, {0x0C, 0x36, 0x37}, {0x0E, 0x2C, 0x2C}, // 47-50
+	{0x0E, 0x29, 0x2A}, {0x09, 0x3C, 0x3C}, {0x0D, 0x28, 0x29}, {0x0C, 0x2A, 0x2A}, // 51-54
+	{0x08, 0x39, 0x39}, {0x0A, 0x2D, 0x2E}, {0x0C, 0x23, 0x24}, {0x0C, 0x21, 0x22}, // 55-58
+	{0x06, 0x39, 0x3A}, {0x08, 0x2D, 0x2E}, {0x06, 0x35, 0x35}, {0x07, 0x2E, 0x2E}, // 59-62
+	{0x04, 0x3B, 0x3C}, {0x09, 0x21, 0x22}, {0x0A, 0x1C, 0x1C}, {0x03, 0x3B, 0x3B}, // 63-66
+	{0x06, 0x29, 0x29}, {0x05, 0x2C, 0x2C}, {0x02, 0x3B, 0x3B}, {0x02, 0x39, 0x39}, // 67-70
+	{0x01, 0x3D, 0x3E}, {0x06, 0x20, 0x21}, {0x0A, 0x10, 0x10}, {0x02, 0x31, 0x32}, // 71-74
+	{0x06, 0x1C, 0x1C}, {0x04, 0x23, 0x24}, {0x00, 0x39, 0x39}, {0x04, 0x20, 0x21}, // 75-78
+	{0x00, 0x35, 0x36}, {0x0C, 0x02, 0x02}, {0x0C, 0x01, 0x01}, {0x04, 0x1B, 0x1B}, // 79-82
+	{0x00, 0x2F, 0x2F}, {0x00, 0x2D, 0x2E}, {0x00, 0x2C, 0x2C}, {0x07, 0x0A, 0x0B}, // 83-86
+	{0x02, 0x1E, 0x1E}, {0x01, 0x22, 0x22}, {0x05, 0x0E, 0x0F}, {0x00, 0x25, 0x25}, // 87-90
+	{0x07, 0x05, 0x06}, {0x00, 0x22, 0x23}, {0x05, 0x0A, 0x0B}, {0x00, 0x20, 0x20}, // 91-94
+	{0x01, 0x19, 0x1A}, {0x07, 0x01, 0x01}, {0x00, 0x1C, 0x1D}, {0x02, 0x11, 0x12}, // 95-98
+	{0x02, 0x10, 0x11}, {0x05, 0x04, 0x04}, {0x03, 0x0A, 0x0B}, {0x03, 0x09, 0x0A}, // 99-102
+	{0x05, 0x01, 0x02}, {0x02, 0x0C, 0x0C}, {0x02, 0x0B, 0x0B}, {0x04, 0x02, 0x03}, // 103-106
+	{0x01, 0x0D, 0x0E}, {0x04, 0x01, 0x01}, {0x00, 0x10, 0x11}, {0x01, 0x0B, 0x0B}, // 107-110
+	{0x02, 0x06, 0x06}, {0x03, 0x01, 0x02}, {0x02, 0x04, 0x05}, {0x00, 0x0C, 0x0C}, // 111-114
+	{0x01, 0x07, 0x07}, {0x00, 0x0A, 0x0B}, {0x01, 0x05, 0x06}, {0x00, 0x09, 0x09}, // 115-118
+	{0x01, 0x04, 0x04}, {0x00, 0x07, 0x08}, {0x01, 0x02, 0x03}, {0x01, 0x02, 0x02}, // 119-122
+	{0x00, 0x05, 0x06}, {0x00, 0x04, 0x05}, {0x00, 0x04, 0x04}, {0x00, 0x03, 0x04}, // 123-126
+	{0x00, 0x02, 0x03}, {0x00, 0x02, 0x02}, {0x00, 0x01, 0x02}, // 127-129
+};
+#else
+static void st7735r_frmctr_solve(rt_uint8_t fps, rt_uint8_t *param)
+{
+	rt_uint32_t min_diff = (rt_uint32_t)(-1);
+	for (rt_uint32_t rtna = 0; rtna <= 0x0F; ++rtna)
 	{
-		st7735r_show_color_pixel(dev, (const rt_uint16_t *)buffer, size);
-		return size;
+		const rt_uint32_t div = rtna * 2 + 40;
+		// round to the closest total line count, then clamp to what FPA + BPA can reach
+		rt_uint32_t lines = (ST7735R_FOSC + fps * div / 2) / (fps * div);
+		if (lines < ST7735R_FRMCTR_LINE + 4)
+		{
+			lines = ST7735R_FRMCTR_LINE + 4;
+		}
+		else if (lines > ST7735R_FRMCTR_LINE + 128)
+		{
+			lines = ST7735R_FRMCTR_LINE + 128;
+		}
+		// compare in mHz so rounding does not hide the better candidate
+		const rt_uint32_t rate = ST7735R_FOSC * 1000 / (div * lines);
+		const rt_uint32_t diff = rate > fps * 1000 ? rate - fps * 1000 : fps * 1000 - rate;
+		if (diff < min_diff)
+		{
+			const rt_uint32_t porch = lines - ST7735R_FRMCTR_LINE - 2;
+			min_diff = diff;
+			param[0] = rtna;
+			param[1] = porch / 2;
+			param[2] = porch - porch / 2;
+		}
+	}
+}
+#endif
+
+static void st7735r_init_frmctr(rt_st7735r_t dev, rt_uint8_t fps)
+{
+	rt_uint8_t param[3];
+	if (fps < ST7735R_FPS_MIN)
+	{
+		fps = ST7735R_FPS_MIN;
+	}
+	else if (fps > ST7735R_FPS_MAX)
+	{
+		fps = ST7735R_FPS_MAX;
+	}
+#ifdef PKG_ST7735R_FRMCTR_TABLE
+	rt_memcpy(param, st7735r_frmctr_table[fps - ST7735R_FPS_MIN], sizeof(param));
+#else
+	st7735r_frmctr_solve(fps, param);
+#endif
+	st7735r_write_cmd(dev, ST7735R_FRMCTR1, param, sizeof(param));
+	dev->fps = fps;
+#ifdef PKG_ST7735R_USING_VSYNC
+	dev->vsync.line_ns = (param[0] * 2 + 40) * 1000000 / (ST7735R_FOSC / 1000);
+	dev->vsync.porch = param[1] + param[2] + 2;
+	dev->vsync.lines = ST7735R_FRMCTR_LINE + dev->vsync.porch;
+	// the model assumes the frame restarts here
+	dev->vsync.tick = rt_tick_get();
+#endif
+}
+
+/* Set the window in controller addresses, inclusive */
+static void st7735r_set_window(rt_st7735r_t dev, rt_uint16_t x0, rt_uint16_t y0, rt_uint16_t x1, rt_uint16_t y1)
+{
+	rt_uint8_t param[4];
+	// the controller keeps the window until the next CASET/RASET, skip unchanged ones
+	if (dev->win.x0 != x0 || dev->win.x1 != x1)
+	{
+		// start
+		param[0] = x0 >> 8;
+		param[1] = x0;
+		// end
+		param[2] = x1 >> 8;
+		param[3] = x1;
+		st7735r_write_cmd(dev, ST7735R_CASET, param, sizeof(param));
+		ST7735R_STAT_ADD(dev, windows, 1);
+		dev->win.x0 = x0;
+		dev->win.x1 = x1;
+	}
+	if (dev->win.y0 != y0 || dev->win.y1 != y1)
+	{
+		param[0] = y0 >> 8;
+		param[1] = y0;
+		param[2] = y1 >> 8;
+		param[3] = y1;
+		st7735r_write_cmd(dev, ST7735R_RASET, param, sizeof(param));
+		ST7735R_STAT_ADD(dev, windows, 1);
+		dev->win.y0 = y0;
+		dev->win.y1 = y1;
+	}
+	// RAMWR restarts from the window origin, a new run has to start with it
+	dev->ramwr_open = RT_FALSE;
+}
+
+/*
+ * Offset of the visible area in controller addresses. Row/column exchanged
+ * orientations swap it, and a mirrored axis counts from the far end of the
+ * GRAM, past the margin on the other side of the panel.
+ */
+static rt_uint16_t st7735r_gram_offset(rt_st7735r_t dev, rt_bool_t row)
+{
+	const struct st7735r_panel *panel = &st7735r_panels[dev->panel];
+	const rt_uint8_t madctl = st7735r_ori_madctl[dev->ori & 3];
+	if (row)
+	{
+		const rt_uint16_t rows = dev->ori & 1 ? dev->width : dev->height;
+		return madctl & ST7735R_MADCTL_MY ? panel->gram_height - rows - panel->y_offset : panel->y_offset;
+	}
+	const rt_uint16_t cols = dev->ori & 1 ? dev->height : dev->width;
+	return madctl & ST7735R_MADCTL_MX ? panel->gram_width - cols - panel->x_offset : panel->x_offset;
+}
+
+static rt_uint16_t st7735r_x_offset(rt_st7735r_t dev)
+{
+	return st7735r_gram_offset(dev, dev->ori & 1);
+}
+
+static rt_uint16_t st7735r_y_offset(rt_st7735r_t dev)
+{
+	return st7735r_gram_offset(dev, !(dev->ori & 1));
+}
+
+void st7735r_set_active_rect(rt_st7735r_t dev, rt_uint8_t x, rt_uint8_t y, rt_uint8_t width, rt_uint8_t height)
+{
+	st7735r_lock(dev);
+	dev->rect.x = x;
+	dev->rect.y = y;
+	dev->rect.width = width;
+	dev->rect.height = height;
+	const rt_uint16_t x0 = x + st7735r_x_offset(dev);
+	const rt_uint16_t y0 = y + st7735r_y_offset(dev);
+	st7735r_set_window(dev, x0, y0, x0 + width - 1, y0 + height - 1);
+	st7735r_unlock(dev);
+}
+
+/*
+ * Hardware scrolling moves whole GRAM rows, i.e. logical rows in portrait
+ * and logical columns in landscape, called lines below. Orientations with
+ * MY set count GRAM rows from the other end.
+ */
+static rt_uint16_t st7735r_scroll_lines(rt_st7735r_t dev)
+{
+	return dev->ori & 1 ? dev->width : dev->height;
+}
+
+static rt_bool_t st7735r_scroll_mirrored(rt_st7735r_t dev)
+{
+	return dev->ori == 1 || dev->ori == 2;
+}
+
+/* First GRAM row of the scroll area */
+static rt_uint16_t st7735r_scroll_tfa(rt_st7735r_t dev)
+{
+	const rt_uint16_t row = dev->scroll.top + st7735r_gram_offset(dev, RT_TRUE);
+	return st7735r_scroll_mirrored(dev) ? st7735r_panels[dev->panel].gram_height - row - dev->scroll.height : row;
+}
+
+static void st7735r_write_scroll(rt_st7735r_t dev)
+{
+	const rt_uint16_t height = dev->scroll.height;
+	const rt_uint16_t ssa = st7735r_scroll_tfa(dev) + (st7735r_scroll_mirrored(dev) ? (height - dev->scroll.offset) % height : dev->scroll.offset);
+	const rt_uint8_t param[2] = {ssa >> 8, ssa};
+	st7735r_write_cmd(dev, ST7735R_VSCSAD, param, sizeof(param));
+}
+
+/*
+ * Scroll `height` lines starting at line `top`, the lines around them stay
+ * fixed. A height of 0 leaves scroll mode.
+ */
+rt_err_t st7735r_set_scroll_area(rt_st7735r_t dev, rt_uint16_t top, rt_uint16_t height)
+{
+	if (top + height > st7735r_scroll_lines(dev))
+	{
+		LOG_E(LOG_TAG" scroll area %d+%d is out of the panel", top, height);
+		return -RT_ERROR;
+	}
+	dev->scroll.top = top;
+	dev->scroll.height = height;
+	dev->scroll.offset = 0;
+	if (height == 0)
+	{
+		return st7735r_write_cmd(dev, ST7735R_NORON, RT_NULL, 0);
+	}
+	const rt_uint16_t tfa = st7735r_scroll_tfa(dev);
+	const rt_uint16_t bfa = st7735r_panels[dev->panel].gram_height - tfa - height;
+	const rt_uint8_t param[6] = {tfa >> 8, tfa, height >> 8, height, bfa >> 8, bfa};
+	st7735r_write_cmd(dev, ST7735R_VSCRDEF, param, sizeof(param));
+	st7735r_write_scroll(dev);
+	return RT_EOK;
+}
+
+/* Show line top + offset of the scroll area at its first line */
+void st7735r_set_scroll(rt_st7735r_t dev, rt_uint16_t offset)
+{
+	if (dev->scroll.height == 0)
+	{
+		return;
+	}
+	dev->scroll.offset = offset % dev->scroll.height;
+	st7735r_write_scroll(dev);
+}
+
+/* The line to write so that it shows at screen line `line` */
+rt_uint16_t st7735r_scroll_map(rt_st7735r_t dev, rt_uint16_t line)
+{
+	if (line < dev->scroll.top || line >= dev->scroll.top + dev->scroll.height)
+	{
+		return line;
+	}
+	return dev->scroll.top + (line - dev->scroll.top + dev->scroll.offset) % dev->scroll.height;
+}
+
+/* Make one screen line the active rect, in scrolled coordinates */
+void st7735r_set_scroll_line(rt_st7735r_t dev, rt_uint16_t line)
+{
+	line = st7735r_scroll_map(dev, line);
+	if (dev->ori & 1)
+	{
+		st7735r_set_active_rect(dev, line, 0, 1, dev->height);
+	}
+	else
+	{
+		st7735r_set_active_rect(dev, 0, line, dev->width, 1);
+	}
+}
+
+#ifdef PKG_ST7735R_USING_READBACK
+/*
+ * CS has to stay low from a read command to its last byte, so reads drive
+ * the bus by hand with the slower read clock instead of going through
+ * st7735r_write_cmd. `saved` keeps the write configuration to restore.
+ */
+static void st7735r_read_begin(rt_st7735r_t dev, rt_uint8_t cmd, struct rt_spi_configuration *saved)
+{
+	struct rt_spi_configuration config;
+#ifdef PKG_ST7735R_USING_ASYNC
+	st7735r_async_wait(dev, RT_WAITING_FOREVER);
+#endif
+	dev->ramwr_open = RT_FALSE;
+	*saved = dev->spi->config;
+	config = *saved;
+	if (config.max_hz > PKG_ST7735R_READ_MAX_HZ)
+	{
+		config.max_hz = PKG_ST7735R_READ_MAX_HZ;
+	}
+	rt_spi_take_bus(dev->spi);
+	rt_spi_configure(dev->spi, &config);
+	rt_spi_take(dev->spi);
+	rt_pin_write(dev->dc_pin, PIN_LOW);
+#ifdef PKG_ST7735R_USING_TRACE
+	if (dev->trace)
+	{
+		dev->trace(dev, RT_FALSE, &cmd, 1);
+	}
+#endif
+	rt_spi_transfer(dev->spi, &cmd, RT_NULL, 1);
+	st7735r_dc(dev, PIN_HIGH);
+	rt_pin_write(dev->dc_pin, PIN_HIGH);
+	++dev->spi_transfers;
+	ST7735R_STAT_ADD(dev, bytes, 1);
+}
+
+static void st7735r_read_end(rt_st7735r_t dev, struct rt_spi_configuration *saved)
+{
+	rt_spi_release(dev->spi);
+	rt_spi_configure(dev->spi, saved);
+	rt_spi_release_bus(dev->spi);
+}
+
+static void st7735r_read_id(rt_st7735r_t dev, rt_uint8_t id[4])
+{
+	struct rt_spi_configuration saved;
+	st7735r_read_begin(dev, ST7735R_RDDID, &saved);
+	rt_spi_transfer(dev->spi, RT_NULL, id, 4);
+	st7735r_read_end(dev, &saved);
+}
+
+/*
+ * Whether MISO, or SDA in 3-wire mode, is wired: an unconnected line reads
+ * RDDID as all zeros or all ones.
+ */
+static rt_bool_t st7735r_probe_read(rt_st7735r_t dev)
+{
+	rt_uint8_t id[4];
+	st7735r_read_id(dev, id);
+	for (rt_size_t i = 1; i < sizeof(id); ++i)
+	{
+		if (id[i] != id[0])
+		{
+			return RT_TRUE;
+		}
+	}
+	return id[0] != 0x00 && id[0] != 0xFF;
+}
+
+/*
+ * Read `count` rgb565 pixels of the active rect from its first pixel.
+ * RAMRD sends 18-bit pixels whatever the interface pixel format is, one
+ * byte per component with the value in the top 6 bits, after
+ * PKG_ST7735R_RAMRD_DUMMY_BITS dummy clocks. A dummy that is not a whole
+ * byte shifts the stream, which is realigned bit-wise.
+ */
+rt_err_t st7735r_read_pixel(rt_st7735r_t dev, rt_uint16_t *pixel, rt_size_t count)
+{
+	const rt_uint8_t shift = PKG_ST7735R_RAMRD_DUMMY_BITS % 8;
+	const rt_size_t room = PKG_ST7735R_TX_BUF_SIZE / 3 * 3;
+	struct rt_spi_configuration saved;
+	rt_uint8_t *buf = dev->tx_buf;
+	rt_uint8_t carry = 0;
+	rt_err_t result = RT_EOK;
+
+	if (!dev->ramrd)
+	{
+		return -RT_ENOSYS;
+	}
+	ST7735R_STAT_BEGIN();
+	st7735r_read_begin(dev, ST7735R_RAMRD, &saved);
+	for (rt_size_t i = 0; i < PKG_ST7735R_RAMRD_DUMMY_BITS / 8; ++i)
+	{
+		rt_spi_transfer(dev->spi, RT_NULL, &carry, 1);
+	}
+	if (shift)
+	{
+		rt_spi_transfer(dev->spi, RT_NULL, &carry, 1);
+	}
+	while (count)
+	{
+		const rt_size_t len = count * 3 < room ? count * 3 : room;
+		if (rt_spi_transfer(dev->spi, RT_NULL, buf, len) != len)
+		{
+			LOG_E(LOG_TAG" read %d bytes failed", len);
+			ST7735R_STAT_ADD(dev, errors, 1);
+			result = -RT_ERROR;
+			break;
+		}
+		++dev->spi_transfers;
+		ST7735R_STAT_ADD(dev, bytes, len);
+		if (shift)
+		{
+			for (rt_size_t i = 0; i < len; ++i)
+			{
+				const rt_uint8_t b = buf[i];
+				buf[i] = (rt_uint8_t)(carry << shift) | b >> (8 - shift);
+				carry = b;
+			}
+		}
+		for (rt_size_t i = 0; i < len; i += 3)
+		{
+			*pixel++ = (buf[i] >> 3) << 11 | (buf[i + 1] >> 2) << 5 | buf[i + 2] >> 3;
+		}
+		count -= len / 3;
+	}
+	st7735r_read_end(dev, &saved);
+	ST7735R_STAT_END(dev);
+	return result;
+}
+#endif
+
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+#ifdef PKG_ST7735R_FRAMEBUFFER_STATIC
+static rt_uint16_t st7735r_static_fb[PKG_ST7735R_WIDTH * PKG_ST7735R_HEIGHT];
+static rt_bool_t st7735r_static_fb_used;
+#endif
+
+static void st7735r_fb_mark(rt_st7735r_t dev, rt_uint16_t x, rt_uint16_t y, rt_uint16_t width, rt_uint16_t height)
+{
+	if (x >= dev->width || y >= dev->height || width == 0 || height == 0)
+	{
+		return;
+	}
+	rt_uint16_t x1 = x + width - 1 < dev->width ? x + width - 1 : dev->width - 1;
+	rt_uint16_t y1 = y + height - 1 < dev->height ? y + height - 1 : dev->height - 1;
+	if (dev->dirty.x0 > dev->dirty.x1)
+	{
+		dev->dirty.x0 = x;
+		dev->dirty.y0 = y;
+		dev->dirty.x1 = x1;
+		dev->dirty.y1 = y1;
+		return;
+	}
+	dev->dirty.x0 = x < dev->dirty.x0 ? x : dev->dirty.x0;
+	dev->dirty.y0 = y < dev->dirty.y0 ? y : dev->dirty.y0;
+	dev->dirty.x1 = x1 > dev->dirty.x1 ? x1 : dev->dirty.x1;
+	dev->dirty.y1 = y1 > dev->dirty.y1 ? y1 : dev->dirty.y1;
+}
+
+/* The stage thread mirrors queued writes into the framebuffer, let it catch up first */
+static void st7735r_fb_sync(rt_st7735r_t dev)
+{
+#ifdef PKG_ST7735R_USING_ASYNC
+	st7735r_async_wait(dev, RT_WAITING_FOREVER);
+#else
+	(void)dev;
+#endif
+}
+
+/* Fill a rect of the framebuffer clipped to the panel */
+static void st7735r_fb_fill(rt_st7735r_t dev, rt_uint16_t x, rt_uint16_t y, rt_uint16_t width, rt_uint16_t height, rt_uint16_t color)
+{
+	st7735r_fb_sync(dev);
+	if (x >= dev->width || y >= dev->height)
+	{
+		return;
+	}
+	width = x + width > dev->width ? dev->width - x : width;
+	height = y + height > dev->height ? dev->height - y : height;
+	for (rt_uint16_t row = 0; row < height; ++row)
+	{
+		rt_uint16_t *fb = dev->framebuffer + (y + row) * dev->width + x;
+		for (rt_uint16_t i = 0; i < width; ++i)
+		{
+			fb[i] = color;
+		}
+	}
+	st7735r_fb_mark(dev, x, y, width, height);
+}
+
+/*
+ * Walk `count` pixels through `rect` the same way RAMWR fills it, starting
+ * `start` pixels in, either mirroring written big-endian pixels into the
+ * framebuffer or reading them back.
+ */
+static void st7735r_fb_access(rt_st7735r_t dev, const struct rt_st7735r_rect *rect, rt_uint8_t mode, const void *src, void *dst, rt_uint32_t start, rt_size_t count)
+{
+	const rt_uint8_t *in = (const rt_uint8_t *)src;
+	rt_uint16_t *out = (rt_uint16_t *)dst;
+	if (rect->width == 0 || rect->height == 0)
+	{
+		return;
+	}
+	rt_uint32_t col = start % rect->width, row = start / rect->width % rect->height;
+	while (count)
+	{
+		rt_size_t n = rect->width - col < count ? rect->width - col : count;
+		const rt_uint32_t x = rect->x + col;
+		const rt_uint32_t y = rect->y + row;
+		// only the part of the rect inside the panel is backed by the framebuffer
+		rt_size_t visible = x < dev->width && y < dev->height ? (dev->width - x < n ? dev->width - x : n) : 0;
+		rt_uint16_t *fb = dev->framebuffer + y * dev->width + x;
+		switch (mode)
+		{
+		case ST7735R_FB_WRITE:
+			for (rt_size_t i = 0; i < visible; ++i)
+			{
+				fb[i] = (in[i * 2] << 8) | in[i * 2 + 1];
+			}
+			in += n * 2;
+			break;
+		case ST7735R_FB_FILL:
+			for (rt_size_t i = 0; i < visible; ++i)
+			{
+				fb[i] = *(const rt_uint16_t *)src;
+			}
+			break;
+		default:
+			rt_memcpy(out, fb, visible * 2);
+			rt_memset(out + visible, 0x0, (n - visible) * 2);
+			out += n;
+			break;
+		}
+		count -= n;
+		col += n;
+		if (col == rect->width)
+		{
+			col = 0;
+			if (++row == rect->height)
+			{
+				row = 0;
+			}
+		}
+	}
+}
+
+/* Send a region of the framebuffer, the active rect is restored afterwards */
+static void st7735r_fb_flush(rt_st7735r_t dev, rt_uint16_t x, rt_uint16_t y, rt_uint16_t width, rt_uint16_t height)
+{
+	st7735r_ramwr_blit(dev, &st7735r_formats[RT_ST7735R_WRITE_COLOR_PIXEL], (const rt_uint8_t *)(dev->framebuffer + y * dev->width + x), dev->width * 2, x, y, width, height, RT_FALSE);
+}
+
+/* Flush the dirty region merged with `rect` (GUI writes straight into the framebuffer) */
+static void st7735r_fb_update(rt_st7735r_t dev, const struct rt_device_rect_info *rect)
+{
+	if (rect)
+	{
+		st7735r_fb_mark(dev, rect->x, rect->y, rect->width, rect->height);
+	}
+	if (dev->dirty.x0 > dev->dirty.x1)
+	{
+		return;
+	}
+	st7735r_fb_flush(dev, dev->dirty.x0, dev->dirty.y0, dev->dirty.x1 - dev->dirty.x0 + 1, dev->dirty.y1 - dev->dirty.y0 + 1);
+	dev->dirty.x0 = 1;
+	dev->dirty.x1 = 0;
+}
+#endif
+
+void st7735r_clear(rt_st7735r_t dev, rt_uint16_t color)
+{
+	st7735r_lock(dev);
+	st7735r_burst_begin(dev);
+	st7735r_set_active_rect(dev, 0, 0, dev->width, dev->height);
+	st7735r_fill_color(dev, color);
+	st7735r_burst_end(dev);
+	st7735r_unlock(dev);
+}
+
+/* Fill the active rect with one color */
+void st7735r_fill_color(rt_st7735r_t dev, rt_uint16_t color)
+{
+	st7735r_lock(dev);
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+	if (dev->framebuffer)
+	{
+		st7735r_fb_sync(dev);
+		st7735r_fb_access(dev, &dev->rect, ST7735R_FB_FILL, &color, RT_NULL, 0, dev->rect.width * dev->rect.height);
+	}
+#endif
+	ST7735R_STAT_BEGIN();
+	st7735r_burst_begin(dev);
+	st7735r_ramwr_begin(dev);
+	st7735r_ramwr_fill(dev, color, dev->rect.width * dev->rect.height);
+	st7735r_ramwr_flush(dev);
+	st7735r_burst_end(dev);
+	ST7735R_STAT_END(dev);
+	st7735r_unlock(dev);
+}
+
+/*
+ * Clip `len` pixels from `pos` to 0..limit - 1, RT_FALSE when none are left.
+ * GUIs draw shapes that stick out of the panel on either side.
+ */
+static rt_bool_t st7735r_gfx_clip(int *pos, int *len, int limit)
+{
+	if (*pos < 0)
+	{
+		*len += *pos;
+		*pos = 0;
+	}
+	if (*len > limit - *pos)
+	{
+		*len = limit - *pos;
+	}
+	return *len > 0;
+}
+
+/*
+ * Fill a rect with one color clipped to the panel, the active rect is left
+ * unchanged. -RT_EINVAL when the rect is outside the panel.
+ */
+rt_err_t st7735r_fill_rect(rt_st7735r_t dev, rt_uint8_t x, rt_uint8_t y, rt_uint8_t width, rt_uint8_t height, rt_uint16_t color)
+{
+	int x0 = x, y0 = y, w = width, h = height;
+	if (width == 0 || height == 0)
+	{
+		return RT_EOK;
+	}
+	if (!st7735r_gfx_clip(&x0, &w, dev->width) || !st7735r_gfx_clip(&y0, &h, dev->height))
+	{
+		return -RT_EINVAL;
+	}
+	st7735r_lock(dev);
+	const struct rt_st7735r_rect rect = dev->rect;
+	st7735r_burst_begin(dev);
+	st7735r_set_active_rect(dev, x0, y0, w, h);
+	st7735r_fill_color(dev, color);
+	st7735r_set_active_rect(dev, rect.x, rect.y, rect.width, rect.height);
+	st7735r_burst_end(dev);
+	st7735r_unlock(dev);
+	return RT_EOK;
+}
+
+#ifdef PKG_ST7735R_USING_VSYNC
+/*
+ * Tear-free pacing. The controller refreshes the panel line by line from
+ * the GRAM, a write tears where the scan passes it half way. A write
+ * faster than the scan starts with the vertical blanking and stays ahead
+ * of it. A slower one starts once the scan has passed its first row and
+ * follows it, the next refresh shows it whole as long as it is less than
+ * about twice as slow. The blanking comes from the TE pin, or without one
+ * from the FRMCTR1 timing counted from when it was written. The model
+ * gets the rate right but only assumes the phase, it paces writes to the
+ * refresh without ruling tearing out.
+ */
+#define ST7735R_VSYNC_TE        0x01
+
+static void st7735r_te_isr(void *args)
+{
+	rt_st7735r_t dev = (rt_st7735r_t)args;
+	dev->vsync.tick = rt_tick_get();
+	rt_event_send(&dev->vsync.event, ST7735R_VSYNC_TE);
+}
+
+static void st7735r_init_te(rt_st7735r_t dev)
+{
+	if (dev->vsync.te_pin >= 0)
+	{
+		// mode 0, TE only goes high for the vertical blanking
+		const rt_uint8_t mode = 0x00;
+		st7735r_write_cmd(dev, ST7735R_TEON, &mode, 1);
+	}
+	else
+	{
+		st7735r_write_cmd(dev, ST7735R_TEOFF, RT_NULL, 0);
+	}
+}
+
+/* Take the blanking from a TE input, or model it again for -1 */
+rt_err_t st7735r_set_te_pin(rt_st7735r_t dev, rt_base_t te_pin)
+{
+	if (dev->vsync.te_pin >= 0)
+	{
+		rt_pin_irq_enable(dev->vsync.te_pin, PIN_IRQ_DISABLE);
+		rt_pin_detach_irq(dev->vsync.te_pin);
+		dev->vsync.te_pin = -1;
+	}
+	rt_err_t result = RT_EOK;
+	if (te_pin >= 0)
+	{
+		rt_pin_mode(te_pin, PIN_MODE_INPUT);
+		if (rt_pin_attach_irq(te_pin, PIN_IRQ_MODE_RISING, st7735r_te_isr, dev) == RT_EOK
+			&& rt_pin_irq_enable(te_pin, PIN_IRQ_ENABLE) == RT_EOK)
+		{
+			dev->vsync.te_pin = te_pin;
+		}
+		else
+		{
+			LOG_E(LOG_TAG" attach te pin %d failed", te_pin);
+			rt_pin_detach_irq(te_pin);
+			result = -RT_ERROR;
+		}
+	}
+	st7735r_init_te(dev);
+	return result;
+}
+
+/*
+ * Time from the blanking start to start writing the active rect, in us, 0
+ * for a write that outruns the scan. In the row/column exchanged
+ * orientations every row of the rect crosses the scan, those writes only
+ * start with the blanking.
+ */
+static rt_uint32_t st7735r_vsync_delay(rt_st7735r_t dev)
+{
+	if ((dev->ori & 1) || dev->spi_hz == 0)
+	{
+		return 0;
+	}
+	// the clock alone is a lower bound, gaps between transfers slow a write down
+	rt_uint32_t byte_ns = 8000000000ULL / dev->spi_hz;
+	if (byte_ns < dev->vsync.byte_ns)
+	{
+		byte_ns = dev->vsync.byte_ns;
+	}
+	const rt_uint32_t row_ns = (rt_uint64_t)dev->rect.width * dev->pack.bits * byte_ns / 8;
+	if (row_ns <= dev->vsync.line_ns)
+	{
+		return 0;
+	}
+	// one line late, so the first row is not written while it is scanned
+	return (rt_uint64_t)(dev->vsync.porch + st7735r_y_offset(dev) + dev->rect.y + 1) * dev->vsync.line_ns / 1000;
+}
+
+/* Wait for the next blanking start plus `delay_us` */
+static rt_err_t st7735r_vsync_slot(rt_st7735r_t dev, rt_uint32_t delay_us)
+{
+	const rt_uint32_t frame_us = dev->vsync.line_ns * dev->vsync.lines / 1000;
+	rt_uint32_t wait_us = delay_us;
+	if (dev->vsync.te_pin >= 0)
+	{
+		// an edge latched before the call may be long gone
+		rt_event_recv(&dev->vsync.event, ST7735R_VSYNC_TE, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, RT_WAITING_NO, RT_NULL);
+		if (rt_event_recv(&dev->vsync.event, ST7735R_VSYNC_TE, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR,
+				rt_tick_from_millisecond(frame_us * 2 / 1000 + 1), RT_NULL) != RT_EOK)
+		{
+			return -RT_ETIMEOUT;
+		}
+	}
+	else
+	{
+		const rt_uint32_t elapsed_us = (rt_uint64_t)(rt_tick_t)(rt_tick_get() - dev->vsync.tick) * 1000000 / RT_TICK_PER_SECOND % frame_us;
+		wait_us += (frame_us - elapsed_us) % frame_us;
+	}
+	// ticks are only good to one either way, a write that follows the scan may start late and one that outruns it early
+	const rt_tick_t ticks = delay_us ? ((rt_uint64_t)wait_us * RT_TICK_PER_SECOND + 999999) / 1000000 + 1 : (rt_uint64_t)wait_us * RT_TICK_PER_SECOND / 1000000;
+	if (ticks)
+	{
+		rt_thread_delay(ticks);
+	}
+	return RT_EOK;
+}
+
+/* Wait until the active rect can be written without tearing */
+rt_err_t st7735r_vsync_wait(rt_st7735r_t dev)
+{
+#ifdef PKG_ST7735R_USING_ASYNC
+	st7735r_async_wait(dev, RT_WAITING_FOREVER);
+#endif
+	return st7735r_vsync_slot(dev, st7735r_vsync_delay(dev));
+}
+
+/* Keep the throughput of a paced write of `bytes` that started at `start` */
+static void st7735r_vsync_measure(rt_st7735r_t dev, rt_tick_t start, rt_size_t bytes)
+{
+	const rt_tick_t ticks = rt_tick_get() - start;
+	// shorter writes cannot be told apart from the clock estimate
+	if (bytes && ticks >= 4)
+	{
+		dev->vsync.byte_ns = (rt_uint64_t)ticks * (1000000000 / RT_TICK_PER_SECOND) / bytes;
+	}
+}
+
+/* Writes of the whole active rect are paced when it covers a quarter of the panel or more */
+static rt_bool_t st7735r_vsync_paced(rt_st7735r_t dev, rt_size_t size)
+{
+	const rt_size_t area = (rt_size_t)dev->rect.width * dev->rect.height;
+	return dev->vsync.enabled && size >= area && area * 4 >= (rt_size_t)dev->width * dev->height;
+}
+#endif
+
+/*
+ * Transformed blits. A MADCTL value maps controller addresses (u, v) to the
+ * GRAM by exchanging them for MV, then mirroring the column for MX and the
+ * row for MY, within the GRAM size of the panel. The blit picks the MADCTL
+ * whose address order walks the GRAM the way the transformed image does,
+ * and streams the source rows as they are.
+ */
+
+/* GRAM position of address (u, v), and back when `inverse` is set */
+static void st7735r_gram_map(rt_st7735r_t dev, rt_uint8_t madctl, rt_int32_t a, rt_int32_t b, rt_int32_t *c, rt_int32_t *d, rt_bool_t inverse)
+{
+	const rt_int32_t cols = st7735r_panels[dev->panel].gram_width;
+	const rt_int32_t rows = st7735r_panels[dev->panel].gram_height;
+	if (!inverse && (madctl & ST7735R_MADCTL_MV))
+	{
+		const rt_int32_t t = a;
+		a = b;
+		b = t;
+	}
+	if (madctl & ST7735R_MADCTL_MX)
+	{
+		a = cols - 1 - a;
+	}
+	if (madctl & ST7735R_MADCTL_MY)
+	{
+		b = rows - 1 - b;
+	}
+	if (inverse && (madctl & ST7735R_MADCTL_MV))
+	{
+		const rt_int32_t t = a;
+		a = b;
+		b = t;
+	}
+	*c = a;
+	*d = b;
+}
+
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+/* Store `count` source pixels into the framebuffer, `step` pixels apart from `pos` */
+static void st7735r_fb_scatter(rt_st7735r_t dev, const struct st7735r_format *fmt, const rt_uint8_t *src, rt_uint32_t count, rt_int32_t pos, rt_int32_t step)
+{
+	rt_uint8_t buf[64];
+	while (count)
+	{
+		const rt_uint32_t n = st7735r_format_chunk(fmt, sizeof(buf) / 2, count);
+		fmt->cvt(buf, src, n, &dev->cvt_ctx);
+		for (rt_uint32_t i = 0; i < n; ++i, pos += step)
+		{
+			dev->framebuffer[pos] = (buf[i * 2] << 8) | buf[i * 2 + 1];
+		}
+		src += n * fmt->bits / 8;
+		count -= n;
+	}
+}
+#endif
+
+/* Send a `width` x `height` source transformed to the panel rect at x, y, which it must fit */
+static void st7735r_ramwr_blit_transform(rt_st7735r_t dev, const struct st7735r_format *fmt, const rt_uint8_t *src, rt_size_t stride, rt_int32_t x, rt_int32_t y, rt_int32_t width, rt_int32_t height, rt_uint8_t transform)
+{
+	const rt_int32_t dst_width = transform & RT_ST7735R_BLIT_TRANSPOSE ? height : width;
+	const rt_int32_t dst_height = transform & RT_ST7735R_BLIT_TRANSPOSE ? width : height;
+	// panel position of source pixels (0, 0), (1, 0) and (0, 1), then their GRAM position
+	rt_int32_t gx[3], gy[3];
+	for (int k = 0; k < 3; ++k)
+	{
+		rt_int32_t dx = transform & RT_ST7735R_BLIT_TRANSPOSE ? k == 2 : k == 1;
+		rt_int32_t dy = transform & RT_ST7735R_BLIT_TRANSPOSE ? k == 1 : k == 2;
+		if (transform & RT_ST7735R_BLIT_MIRROR_X)
+		{
+			dx = dst_width - 1 - dx;
+		}
+		if (transform & RT_ST7735R_BLIT_MIRROR_Y)
+		{
+			dy = dst_height - 1 - dy;
+		}
+		st7735r_gram_map(dev, st7735r_ori_madctl[dev->ori & 3], x + dx + st7735r_x_offset(dev), y + dy + st7735r_y_offset(dev), &gx[k], &gy[k], RT_FALSE);
+	}
+	// source columns advance along GRAM rows with MV, the sign of each step gives the mirror
+	rt_uint8_t madctl = 0;
+	if (gy[1] != gy[0])
+	{
+		madctl = ST7735R_MADCTL_MV | (gy[1] < gy[0] ? ST7735R_MADCTL_MY : 0) | (gx[2] < gx[0] ? ST7735R_MADCTL_MX : 0);
+	}
+	else
+	{
+		madctl = (gx[1] < gx[0] ? ST7735R_MADCTL_MX : 0) | (gy[2] < gy[0] ? ST7735R_MADCTL_MY : 0);
+	}
+	rt_int32_t u, v;
+	st7735r_gram_map(dev, madctl, gx[0], gy[0], &u, &v, RT_TRUE);
+
+	const struct rt_st7735r_rect rect = dev->rect;
+	// keep the refresh order of the orientation
+	const rt_uint8_t param = madctl | ST7735R_MADCTL_SCAN(st7735r_ori_madctl[dev->ori & 3]) | st7735r_panels[dev->panel].madctl;
+	ST7735R_STAT_BEGIN();
+	st7735r_burst_begin(dev);
+	st7735r_write_cmd(dev, ST7735R_MADCTL, &param, 1);
+	st7735r_set_window(dev, u, v, u + width - 1, v + height - 1);
+	st7735r_ramwr_begin(dev);
+	for (rt_int32_t row = 0; row < height; ++row)
+	{
+		st7735r_ramwr_convert(dev, fmt, src + row * stride, width, RT_FALSE);
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+		if (dev->framebuffer)
+		{
+			// the row runs along a panel row or column, in either direction
+			rt_int32_t dx = transform & RT_ST7735R_BLIT_TRANSPOSE ? row : 0, dy = transform & RT_ST7735R_BLIT_TRANSPOSE ? 0 : row;
+			rt_int32_t step = transform & RT_ST7735R_BLIT_TRANSPOSE ? dev->width : 1;
+			if (transform & RT_ST7735R_BLIT_MIRROR_X)
+			{
+				dx = dst_width - 1 - dx;
+				step = transform & RT_ST7735R_BLIT_TRANSPOSE ? step : -step;
+			}
+			if (transform & RT_ST7735R_BLIT_MIRROR_Y)
+			{
+				dy = dst_height - 1 - dy;
+				step = transform & RT_ST7735R_BLIT_TRANSPOSE ? -step : step;
+			}
+			st7735r_fb_scatter(dev, fmt, src + row * stride, width, (y + dy) * dev->width + x + dx, step);
+		}
+#endif
+	}
+	st7735r_ramwr_flush(dev);
+	st7735r_init_ori(dev, dev->ori);
+	st7735r_set_active_rect(dev, rect.x, rect.y, rect.width, rect.height);
+	st7735r_burst_end(dev);
+	ST7735R_STAT_END(dev);
+}
+
+/*
+ * Blit a rect out of a larger image with one window and one RAMWR, the
+ * active rect is left unchanged. Rotated or mirrored blits only change
+ * MADCTL for the duration of the blit.
+ */
+rt_err_t st7735r_blit_rect(rt_st7735r_t dev, const struct rt_st7735r_blit *blit)
+{
+	const struct st7735r_format *fmt = st7735r_get_format(dev, blit->format);
+	if (fmt == RT_NULL || fmt->bits < 8)
+	{
+		return -RT_EINVAL;
+	}
+	const rt_uint8_t transform = blit->transform;
+	const rt_int32_t dst_width = transform & RT_ST7735R_BLIT_TRANSPOSE ? blit->height : blit->width;
+	const rt_int32_t dst_height = transform & RT_ST7735R_BLIT_TRANSPOSE ? blit->width : blit->height;
+	// clip on the panel
+	const rt_int32_t x0 = blit->x < 0 ? -blit->x : 0;
+	const rt_int32_t y0 = blit->y < 0 ? -blit->y : 0;
+	const rt_int32_t x1 = blit->x + dst_width > dev->width ? dev->width - blit->x : dst_width;
+	const rt_int32_t y1 = blit->y + dst_height > dev->height ? dev->height - blit->y : dst_height;
+	if (x0 >= x1 || y0 >= y1)
+	{
+		return RT_EOK;
+	}
+	// and map the clipped part back to the source, undoing the mirrors and then the transpose
+	rt_int32_t left = transform & RT_ST7735R_BLIT_MIRROR_X ? dst_width - x1 : x0;
+	rt_int32_t top = transform & RT_ST7735R_BLIT_MIRROR_Y ? dst_height - y1 : y0;
+	rt_int32_t width = x1 - x0, height = y1 - y0;
+	if (transform & RT_ST7735R_BLIT_TRANSPOSE)
+	{
+		const rt_int32_t t = left;
+		left = top;
+		top = t;
+		width = y1 - y0;
+		height = x1 - x0;
+	}
+	const rt_uint8_t *src = (const rt_uint8_t *)blit->buffer + (blit->src_y + top) * blit->stride + (blit->src_x + left) * fmt->bits / 8;
+	st7735r_lock(dev);
+	if (transform)
+	{
+		st7735r_ramwr_blit_transform(dev, fmt, src, blit->stride, blit->x + x0, blit->y + y0, width, height, transform);
+	}
+	else
+	{
+		st7735r_ramwr_blit(dev, fmt, src, blit->stride, blit->x + x0, blit->y + y0, width, height, RT_TRUE);
+	}
+	st7735r_unlock(dev);
+	return RT_EOK;
+}
+
+/* Write `length` pixels of one of the RT_ST7735R_WRITE_* formats into the active rect */
+rt_err_t st7735r_show_pixel(rt_st7735r_t dev, rt_uint8_t format, const void *pixel, rt_size_t length)
+{
+	const struct st7735r_format *fmt = st7735r_get_format(dev, format);
+	if (fmt == RT_NULL)
+	{
+		return -RT_EINVAL;
+	}
+	st7735r_lock(dev);
+	ST7735R_STAT_BEGIN();
+#ifdef PKG_ST7735R_USING_VSYNC
+	const rt_bool_t paced = st7735r_vsync_paced(dev, length);
+	if (paced)
+	{
+		st7735r_vsync_wait(dev);
+	}
+	const rt_tick_t start = rt_tick_get();
+#endif
+	st7735r_burst_begin(dev);
+	st7735r_ramwr_begin(dev);
+	st7735r_ramwr_write(dev, fmt, pixel, length);
+	st7735r_ramwr_flush(dev);
+	st7735r_burst_end(dev);
+#ifdef PKG_ST7735R_USING_VSYNC
+	if (paced)
+	{
+		st7735r_vsync_measure(dev, start, length * dev->pack.bits / 8);
+	}
+#endif
+	ST7735R_STAT_END(dev);
+	st7735r_unlock(dev);
+	return RT_EOK;
+}
+
+void st7735r_show_grayscale_pixel(rt_st7735r_t dev, const rt_uint8_t *pixel, rt_size_t length)
+{
+	st7735r_show_pixel(dev, RT_ST7735R_WRITE_GRAYSCALE_PIXEL, pixel, length);
+}
+
+void st7735r_show_color_pixel(rt_st7735r_t dev, const rt_uint16_t *pixel, rt_size_t length)
+{
+	st7735r_show_pixel(dev, RT_ST7735R_WRITE_COLOR_PIXEL, pixel, length);
+}
+
+#ifdef PKG_ST7735R_USING_CAMERA
+/*
+ * Camera frames are cropped, scaled onto the active rect, thresholded and
+ * converted to rgb565 in one pass straight into the staging buffer. Both
+ * filters sample at the pixel centres. Nearest steps through the source
+ * with an exact remainder, bilinear uses 16.16 positions and 8-bit weights.
+ */
+static rt_uint16_t st7735r_camera_color(const struct rt_st7735r_camera *cam, rt_uint8_t gray)
+{
+	if (cam->mode != RT_ST7735R_CAMERA_GRAY && gray >= cam->threshold)
+	{
+		return cam->fg_color;
+	}
+	if (cam->mode == RT_ST7735R_CAMERA_BINARY)
+	{
+		return cam->bg_color;
+	}
+	return ((gray >> 3) << 11) | ((gray >> 2) << 5) | (gray >> 3);
+}
+
+/* Bilinear source position of output `i`, clamped to the last source pixel */
+static rt_uint32_t st7735r_camera_pos(rt_uint32_t i, rt_uint32_t step, rt_uint32_t span)
+{
+	rt_uint32_t pos = i * step + step / 2;
+	pos = pos > 0x8000 ? pos - 0x8000 : 0;
+	return pos < (span - 1) << 16 ? pos : (span - 1) << 16;
+}
+
+/* Draw a crop of a grayscale camera frame scaled to the active rect */
+rt_err_t st7735r_show_camera(rt_st7735r_t dev, const struct rt_st7735r_camera *cam)
+{
+	const rt_uint32_t crop_width = cam->crop_width ? cam->crop_width : cam->width;
+	const rt_uint32_t crop_height = cam->crop_width ? cam->crop_height : cam->height;
+	const rt_bool_t bilinear = cam->scale == RT_ST7735R_SCALE_BILINEAR;
+	if (cam->frame == RT_NULL || crop_width == 0 || crop_height == 0 || cam->stride < cam->width
+		|| cam->crop_x + crop_width > cam->width || cam->crop_y + crop_height > cam->height)
+	{
+		LOG_E(LOG_TAG" camera crop is outside the frame");
+		return -RT_EINVAL;
+	}
+	st7735r_lock(dev);
+	const rt_uint32_t width = dev->rect.width;
+	const rt_uint32_t height = dev->rect.height;
+	if (width == 0 || height == 0)
+	{
+		st7735r_unlock(dev);
+		return RT_EOK;
+	}
+	const rt_uint32_t step_x = (crop_width << 16) / width;
+	const rt_uint32_t step_y = (crop_height << 16) / height;
+	const rt_uint8_t *origin = cam->frame + cam->crop_y * cam->stride + cam->crop_x;
+	ST7735R_STAT_BEGIN();
+#ifdef PKG_ST7735R_USING_VSYNC
+	const rt_bool_t paced = st7735r_vsync_paced(dev, width * height);
+	if (paced)
+	{
+		st7735r_vsync_wait(dev);
+	}
+	const rt_tick_t start = rt_tick_get();
+#endif
+	st7735r_burst_begin(dev);
+	st7735r_ramwr_begin(dev);
+	for (rt_uint32_t dy = 0; dy < height; ++dy)
+	{
+		const rt_uint8_t *row0;
+		rt_uint32_t wy = 0;
+		if (bilinear)
+		{
+			const rt_uint32_t pos = st7735r_camera_pos(dy, step_y, crop_height);
+			row0 = origin + (pos >> 16) * cam->stride;
+			wy = (pos >> 8) & 0xFF;
+		}
+		else
+		{
+			row0 = origin + (2 * dy + 1) * crop_height / (2 * height) * cam->stride;
+		}
+		const rt_uint8_t *row1 = wy ? row0 + cam->stride : row0;
+		// nearest column of the output pixel centre, the remainder is in 1 / (2 * width) source pixels
+		rt_uint32_t x = crop_width / (2 * width);
+		rt_uint32_t rem = crop_width % (2 * width);
+		rt_uint32_t dx = 0;
+		while (dx < width)
+		{
+			rt_uint32_t n = st7735r_pack_room(&dev->pack, PKG_ST7735R_TX_BUF_SIZE - dev->tx_len);
+			if (n == 0)
+			{
+				st7735r_ramwr_drain(dev);
+				continue;
+			}
+			if (n > width - dx)
+			{
+				n = width - dx;
+			}
+			rt_uint8_t *buf = st7735r_pack_src(&dev->pack, dev->tx_buf + dev->tx_len, n);
+			for (rt_uint32_t i = 0; i < n; ++i)
+			{
+				rt_uint8_t gray;
+				if (bilinear)
+				{
+					const rt_uint32_t pos = st7735r_camera_pos(dx + i, step_x, crop_width);
+					const rt_uint32_t wx = (pos >> 8) & 0xFF;
+					x = pos >> 16;
+					const rt_uint32_t next = x + (wx != 0);
+					const rt_uint32_t top = row0[x] * (256 - wx) + row0[next] * wx;
+					const rt_uint32_t bottom = row1[x] * (256 - wx) + row1[next] * wx;
+					gray = (top * (256 - wy) + bottom * wy + 0x8000) >> 16;
+				}
+				else
+				{
+					gray = row0[x];
+					x += crop_width / width;
+					rem += 2 * (crop_width % width);
+					if (rem >= 2 * width)
+					{
+						rem -= 2 * width;
+						++x;
+					}
+				}
+				const rt_uint16_t color = st7735r_camera_color(cam, gray);
+				buf[i * 2] = color >> 8;
+				buf[i * 2 + 1] = color;
+			}
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+			if (dev->framebuffer)
+			{
+				st7735r_fb_access(dev, &dev->rect, ST7735R_FB_WRITE, buf, RT_NULL, dev->ramwr_pos, n);
+			}
+#endif
+			dev->tx_len += st7735r_pack(&dev->pack, dev->tx_buf + dev->tx_len, n);
+			dev->ramwr_pos += n;
+			ST7735R_STAT_ADD(dev, pixels, n);
+			dx += n;
+		}
+	}
+	st7735r_ramwr_flush(dev);
+	st7735r_burst_end(dev);
+#ifdef PKG_ST7735R_USING_VSYNC
+	if (paced)
+	{
+		st7735r_vsync_measure(dev, start, width * height * dev->pack.bits / 8);
+	}
+#endif
+	ST7735R_STAT_END(dev);
+	st7735r_unlock(dev);
+	return RT_EOK;
+}
+#endif
+
+#ifdef PKG_ST7735R_USING_TEXT
+/*
+ * Text. Glyphs are rendered once for a font, character and fg/bg pair into
+ * big-endian rgb565 and kept in a small LRU cache. The visible glyphs of a
+ * line are then sent row by row from the cache in one window and one RAMWR,
+ * at most PKG_ST7735R_GLYPH_CACHE_SIZE of them so none is evicted while
+ * its run is sent.
+ */
+struct st7735r_glyph
+{
+	const struct rt_st7735r_font *font;
+	rt_uint16_t fg_color, bg_color;
+	rt_uint8_t code;
+	rt_uint8_t width;
+	/* lookup count at the last use, 0 while the entry is empty */
+	rt_uint32_t used;
+	rt_uint8_t pixels[PKG_ST7735R_GLYPH_MAX_PIXELS * 2];
+};
+
+/* The columns [col0, col1) of a glyph that are on the panel */
+struct st7735r_glyph_span
+{
+	const struct st7735r_glyph *glyph;
+	rt_uint8_t col0, col1;
+};
+
+struct st7735r_glyphs
+{
+	rt_uint32_t clock;
+	struct rt_st7735r_text_stats stats;
+	struct st7735r_glyph cache[PKG_ST7735R_GLYPH_CACHE_SIZE];
+	struct st7735r_glyph_span run[PKG_ST7735R_GLYPH_CACHE_SIZE];
+};
+
+static struct st7735r_glyphs *st7735r_glyphs_get(rt_st7735r_t dev)
+{
+	if (dev->glyphs == RT_NULL)
+	{
+		dev->glyphs = rt_malloc(sizeof(struct st7735r_glyphs));
+		if (dev->glyphs == RT_NULL)
+		{
+			LOG_E(LOG_TAG" no memory for the glyph cache");
+			return RT_NULL;
+		}
+		rt_memset(dev->glyphs, 0x0, sizeof(struct st7735r_glyphs));
+	}
+	return dev->glyphs;
+}
+
+static rt_uint8_t st7735r_glyph_width(const struct rt_st7735r_font *font, rt_uint8_t code)
+{
+	if (font->widths && code >= font->first && code - font->first < font->count && font->widths[code - font->first] < font->width)
+	{
+		return font->widths[code - font->first];
+	}
+	return font->width;
+}
+
+/* Blend two rgb565 colors, `alpha` from 0 (bg) to 15 (fg) */
+static rt_uint16_t st7735r_glyph_blend(rt_uint16_t fg, rt_uint16_t bg, rt_uint8_t alpha)
+{
+	const rt_uint32_t r = ((fg >> 11) * alpha + (bg >> 11) * (15 - alpha) + 7) / 15;
+	const rt_uint32_t g = (((fg >> 5) & 0x3F) * alpha + ((bg >> 5) & 0x3F) * (15 - alpha) + 7) / 15;
+	const rt_uint32_t b = ((fg & 0x1F) * alpha + (bg & 0x1F) * (15 - alpha) + 7) / 15;
+	return (r << 11) | (g << 5) | b;
+}
+
+/* Characters the font does not have are drawn as an empty cell */
+static void st7735r_glyph_render(struct st7735r_glyph *glyph)
+{
+	const struct rt_st7735r_font *font = glyph->font;
+	const rt_size_t stride = (font->width * font->bpp + 7) / 8;
+	const rt_uint8_t mask = (1 << font->bpp) - 1;
+	const rt_uint8_t *src = RT_NULL;
+	rt_uint8_t *dst = glyph->pixels;
+	if (glyph->code >= font->first && glyph->code - font->first < font->count)
+	{
+		src = font->bitmap + (glyph->code - font->first) * stride * font->height;
+	}
+	for (rt_uint8_t y = 0; y < font->height; ++y)
+	{
+		for (rt_uint32_t x = 0; x < glyph->width; ++x)
+		{
+			const rt_uint32_t bit = x * font->bpp;
+			const rt_uint8_t value = src ? (src[bit / 8] >> (8 - font->bpp - bit % 8)) & mask : 0;
+			rt_uint16_t color;
+			if (font->bpp == RT_ST7735R_FONT_1BIT)
+			{
+				color = value ? glyph->fg_color : glyph->bg_color;
+			}
+			else
+			{
+				color = st7735r_glyph_blend(glyph->fg_color, glyph->bg_color, value);
+			}
+			*dst++ = color >> 8;
+			*dst++ = color;
+		}
+		if (src)
+		{
+			src += stride;
+		}
+	}
+}
+
+static const struct st7735r_glyph *st7735r_glyph_get(struct st7735r_glyphs *glyphs, const struct rt_st7735r_font *font, rt_uint8_t code, rt_uint16_t fg_color, rt_uint16_t bg_color)
+{
+	struct st7735r_glyph *victim = &glyphs->cache[0];
+	++glyphs->clock;
+	++glyphs->stats.glyphs;
+	for (rt_size_t i = 0; i < PKG_ST7735R_GLYPH_CACHE_SIZE; ++i)
+	{
+		struct st7735r_glyph *glyph = &glyphs->cache[i];
+		if (glyph->used && glyph->font == font && glyph->code == code && glyph->fg_color == fg_color && glyph->bg_color == bg_color)
+		{
+			glyph->used = glyphs->clock;
+			++glyphs->stats.hits;
+			return glyph;
+		}
+		if (glyph->used < victim->used)
+		{
+			victim = glyph;
+		}
+	}
+	// the least recently used entry, glyphs of the run being collected were all used later
+	victim->font = font;
+	victim->code = code;
+	victim->fg_color = fg_color;
+	victim->bg_color = bg_color;
+	victim->width = st7735r_glyph_width(font, code);
+	victim->used = glyphs->clock;
+	st7735r_glyph_render(victim);
+	++glyphs->stats.misses;
+	return victim;
+}
+
+/* Send rows [row0, row1) of the `count` glyphs collected from (x, y) on */
+static void st7735r_glyph_run(rt_st7735r_t dev, struct st7735r_glyphs *glyphs, rt_uint16_t count, rt_uint8_t x, rt_uint8_t y, rt_uint8_t row0, rt_uint8_t row1)
+{
+	const struct st7735r_format *fmt = &st7735r_formats[RT_ST7735R_WRITE_COLOR_SWAP_PIXEL];
+	rt_uint16_t width = 0;
+	for (rt_uint16_t i = 0; i < count; ++i)
+	{
+		width += glyphs->run[i].col1 - glyphs->run[i].col0;
+	}
+	st7735r_set_active_rect(dev, x, y, width, row1 - row0);
+	st7735r_ramwr_begin(dev);
+	for (rt_uint8_t row = row0; row < row1; ++row)
+	{
+		for (rt_uint16_t i = 0; i < count; ++i)
+		{
+			const struct st7735r_glyph_span *span = &glyphs->run[i];
+			st7735r_ramwr_convert(dev, fmt, span->glyph->pixels + (row * span->glyph->width + span->col0) * 2, span->col1 - span->col0, RT_TRUE);
+		}
+	}
+	st7735r_ramwr_flush(dev);
+	++glyphs->stats.runs;
+}
+
+/* Draw a string with a bitmap font, one window and one RAMWR per line of glyphs */
+rt_err_t st7735r_draw_text(rt_st7735r_t dev, const struct rt_st7735r_text *text)
+{
+	const struct rt_st7735r_font *font = text->font ? text->font : &st7735r_font_5x7;
+	if (text->str == RT_NULL || (font->bpp != RT_ST7735R_FONT_1BIT && font->bpp != RT_ST7735R_FONT_4BIT))
+	{
+		return -RT_EINVAL;
+	}
+	if (font->width * font->height > PKG_ST7735R_GLYPH_MAX_PIXELS)
+	{
+		LOG_E(LOG_TAG" %dx%d glyphs are larger than the glyph cache entries", font->width, font->height);
+		return -RT_EINVAL;
+	}
+	st7735r_lock(dev);
+	struct st7735r_glyphs *glyphs = st7735r_glyphs_get(dev);
+	if (glyphs == RT_NULL)
+	{
+		st7735r_unlock(dev);
+		return -RT_ENOMEM;
+	}
+	const struct rt_st7735r_rect rect = dev->rect;
+	const rt_uint8_t *str = (const rt_uint8_t *)text->str;
+	rt_int32_t y = text->y;
+	ST7735R_STAT_BEGIN();
+	st7735r_burst_begin(dev);
+	while (y < dev->height)
+	{
+		const rt_int32_t row0 = y < 0 ? -y : 0;
+		const rt_int32_t row1 = y + font->height > dev->height ? dev->height - y : font->height;
+		rt_int32_t x = text->x, run_x = 0;
+		rt_uint16_t count = 0;
+		for (; *str && *str != '\n'; ++str)
+		{
+			const rt_int32_t width = st7735r_glyph_width(font, *str);
+			const rt_int32_t col0 = x < 0 ? -x : 0;
+			const rt_int32_t col1 = x + width > dev->width ? dev->width - x : width;
+			if (row0 < row1 && col0 < col1)
+			{
+				if (count == 0)
+				{
+					run_x = x + col0;
+				}
+				glyphs->run[count].glyph = st7735r_glyph_get(glyphs, font, *str, text->fg_color, text->bg_color);
+				glyphs->run[count].col0 = col0;
+				glyphs->run[count].col1 = col1;
+				if (++count == PKG_ST7735R_GLYPH_CACHE_SIZE)
+				{
+					st7735r_glyph_run(dev, glyphs, count, run_x, y + row0, row0, row1);
+					count = 0;
+				}
+			}
+			x += width;
+		}
+		if (count)
+		{
+			st7735r_glyph_run(dev, glyphs, count, run_x, y + row0, row0, row1);
+		}
+		if (*str == '\0')
+		{
+			break;
+		}
+		++str;
+		y += font->height;
+	}
+	st7735r_set_active_rect(dev, rect.x, rect.y, rect.width, rect.height);
+	st7735r_burst_end(dev);
+	ST7735R_STAT_END(dev);
+	st7735r_unlock(dev);
+	return RT_EOK;
+}
+#endif
+
+#if defined(PKG_ST7735R_USING_RENDER) || defined(PKG_ST7735R_USING_DLIST)
+static rt_bool_t st7735r_rect_contains(const struct rt_st7735r_rect *outer, const struct rt_st7735r_rect *inner)
+{
+	return inner->x >= outer->x && inner->y >= outer->y
+		&& inner->x + inner->width <= outer->x + outer->width
+		&& inner->y + inner->height <= outer->y + outer->height;
+}
+#endif
+
+#ifdef PKG_ST7735R_USING_DLIST
+/*
+ * Display list. Primitives are only recorded, st7735r_dlist_render draws
+ * them in order into a band of whole rows and sends each band as one RAMWR
+ * burst. Recording a fill or blit drops the primitives it fully covers.
+ */
+#define ST7735R_DLIST_CHUNK     32
+
+void st7735r_dlist_init(struct rt_st7735r_dlist *dl, rt_uint16_t bg_color)
+{
+	dl->bg_color = bg_color;
+	dl->count = 0;
+}
+
+static rt_err_t st7735r_dlist_add(struct rt_st7735r_dlist *dl, rt_uint8_t op, const struct rt_st7735r_rect *rect, rt_uint16_t color, rt_uint8_t format, const void *pixels)
+{
+	if (rect->width == 0 || rect->height == 0)
+	{
+		return RT_EOK;
+	}
+	if (op != RT_ST7735R_DLIST_GLYPH)
+	{
+		rt_uint16_t count = 0;
+		for (rt_uint16_t i = 0; i < dl->count; ++i)
+		{
+			if (!st7735r_rect_contains(rect, &dl->prim[i].rect))
+			{
+				dl->prim[count++] = dl->prim[i];
+			}
+		}
+		dl->count = count;
+	}
+	if (dl->count == PKG_ST7735R_DLIST_SIZE)
+	{
+		LOG_E(LOG_TAG" display list is full");
+		return -RT_EFULL;
+	}
+	struct rt_st7735r_dlist_prim *prim = &dl->prim[dl->count++];
+	prim->op = op;
+	prim->format = format;
+	prim->color = color;
+	prim->rect = *rect;
+	prim->pixels = pixels;
+	return RT_EOK;
+}
+
+rt_err_t st7735r_dlist_fill(struct rt_st7735r_dlist *dl, rt_uint8_t x, rt_uint8_t y, rt_uint8_t width, rt_uint8_t height, rt_uint16_t color)
+{
+	const struct rt_st7735r_rect rect = {x, y, width, height};
+	return st7735r_dlist_add(dl, RT_ST7735R_DLIST_FILL, &rect, color, 0, RT_NULL);
+}
+
+rt_err_t st7735r_dlist_hline(struct rt_st7735r_dlist *dl, rt_uint8_t x, rt_uint8_t y, rt_uint8_t length, rt_uint16_t color)
+{
+	return st7735r_dlist_fill(dl, x, y, length, 1, color);
+}
+
+rt_err_t st7735r_dlist_vline(struct rt_st7735r_dlist *dl, rt_uint8_t x, rt_uint8_t y, rt_uint8_t length, rt_uint16_t color)
+{
+	return st7735r_dlist_fill(dl, x, y, 1, length, color);
+}
+
+/* Any RT_ST7735R_WRITE_* format, the buffer is borrowed until the list is reinitialised */
+rt_err_t st7735r_dlist_blit(struct rt_st7735r_dlist *dl, rt_uint8_t x, rt_uint8_t y, rt_uint8_t width, rt_uint8_t height, rt_uint8_t format, const void *pixels)
+{
+	const struct rt_st7735r_rect rect = {x, y, width, height};
+	if (format >= sizeof(st7735r_formats) / sizeof(st7735r_formats[0]) || st7735r_formats[format].cvt == RT_NULL)
+	{
+		return -RT_EINVAL;
+	}
+	return st7735r_dlist_add(dl, RT_ST7735R_DLIST_BLIT, &rect, 0, format, pixels);
+}
+
+/* Set bits of the MSB first mask are drawn in color, the others are transparent */
+rt_err_t st7735r_dlist_glyph(struct rt_st7735r_dlist *dl, rt_uint8_t x, rt_uint8_t y, rt_uint8_t width, rt_uint8_t height, const rt_uint8_t *bitmap, rt_uint16_t color)
+{
+	const struct rt_st7735r_rect rect = {x, y, width, height};
+	return st7735r_dlist_add(dl, RT_ST7735R_DLIST_GLYPH, &rect, color, 0, bitmap);
+}
+
+/* Convert `count` pixels of a blit starting at pixel `start` into native rgb565 */
+static void st7735r_dlist_blit_row(rt_st7735r_t dev, struct rt_st7735r_dlist_prim *prim, rt_uint16_t *out, rt_uint32_t start, rt_uint32_t count)
+{
+	const struct st7735r_format *fmt = &st7735r_formats[prim->format];
+	struct st7735r_cvt_ctx ctx = dev->cvt_ctx;
+	rt_uint8_t buf[(ST7735R_DLIST_CHUNK + 8) * 2];
+	if (fmt->bits == 0)
+	{
+		// rows are only visited downwards, the stream is skipped forward to them
+		st7735r_rle_skip(&prim->rle, start - prim->pos);
+		prim->pos = start + count;
+		ctx.rle = &prim->rle;
+	}
+	while (count)
+	{
+		const rt_uint32_t n = count < ST7735R_DLIST_CHUNK ? count : ST7735R_DLIST_CHUNK;
+		const rt_uint8_t *src = RT_NULL;
+		rt_uint32_t skip = 0;
+		if (fmt->bits)
+		{
+			// sub-byte formats are converted from the start of the byte holding the first pixel
+			const rt_uint32_t bit = start * fmt->bits;
+			src = (const rt_uint8_t *)prim->pixels + bit / 8;
+			skip = bit % 8 / fmt->bits;
+		}
+		fmt->cvt(buf, src, skip + n, &ctx);
+		for (rt_uint32_t i = 0; i < n; ++i)
+		{
+			out[i] = (buf[(skip + i) * 2] << 8) | buf[(skip + i) * 2 + 1];
+		}
+		out += n;
+		start += n;
+		count -= n;
+	}
+}
+
+/* Draw the part of a primitive in the band of `lines` rows from `top`, `width` columns from `left` */
+static void st7735r_dlist_draw(rt_st7735r_t dev, struct rt_st7735r_dlist_prim *prim, rt_uint16_t *band, rt_int32_t left, rt_int32_t width, rt_int32_t top, rt_int32_t lines)
+{
+	const struct rt_st7735r_rect *r = &prim->rect;
+	const rt_int32_t x0 = r->x > left ? r->x : left;
+	const rt_int32_t x1 = r->x + r->width < left + width ? r->x + r->width : left + width;
+	const rt_int32_t y0 = r->y > top ? r->y : top;
+	const rt_int32_t y1 = r->y + r->height < top + lines ? r->y + r->height : top + lines;
+	for (rt_int32_t y = y0; x0 < x1 && y < y1; ++y)
+	{
+		rt_uint16_t *out = band + (y - top) * width + (x0 - left);
+		switch (prim->op)
+		{
+		case RT_ST7735R_DLIST_FILL:
+			for (rt_int32_t i = 0; i < x1 - x0; ++i)
+			{
+				out[i] = prim->color;
+			}
+			break;
+		case RT_ST7735R_DLIST_GLYPH:
+		{
+			const rt_uint8_t *row = (const rt_uint8_t *)prim->pixels + (y - r->y) * ((r->width + 7) / 8);
+			for (rt_int32_t x = x0; x < x1; ++x)
+			{
+				if (row[(x - r->x) / 8] & (0x80 >> ((x - r->x) % 8)))
+				{
+					out[x - x0] = prim->color;
+				}
+			}
+			break;
+		}
+		default:
+			st7735r_dlist_blit_row(dev, prim, out, (y - r->y) * r->width + (x0 - r->x), x1 - x0);
+			break;
+		}
+	}
+}
+
+/* Draw the list into `area`, or the whole panel for RT_NULL. The list is kept for the next frame */
+rt_err_t st7735r_dlist_render(rt_st7735r_t dev, struct rt_st7735r_dlist *dl, const struct rt_st7735r_rect *area)
+{
+	const struct rt_st7735r_rect full = {0, 0, dev->width, dev->height};
+	if (area == RT_NULL)
+	{
+		area = &full;
+	}
+	if (area->width == 0 || area->height == 0)
+	{
+		return RT_EOK;
+	}
+	const rt_int32_t band_lines = PKG_ST7735R_DLIST_BAND_PIXELS / area->width;
+	if (band_lines == 0)
+	{
+		LOG_E(LOG_TAG" band of %d pixels is narrower than %d", PKG_ST7735R_DLIST_BAND_PIXELS, area->width);
+		return -RT_EINVAL;
+	}
+	for (rt_uint16_t i = 0; i < dl->count; ++i)
+	{
+		struct rt_st7735r_dlist_prim *prim = &dl->prim[i];
+		if (prim->op != RT_ST7735R_DLIST_BLIT)
+		{
+			continue;
+		}
+		if (st7735r_get_format(dev, prim->format) == RT_NULL)
+		{
+			return -RT_EINVAL;
+		}
+		st7735r_rle_init(&prim->rle, prim->pixels);
+		prim->pos = 0;
+	}
+	st7735r_lock(dev);
+	const struct rt_st7735r_rect rect = dev->rect;
+	for (rt_int32_t top = area->y; top < area->y + area->height; top += band_lines)
+	{
+		const rt_int32_t lines = area->y + area->height - top < band_lines ? area->y + area->height - top : band_lines;
+		for (rt_int32_t i = 0; i < area->width * lines; ++i)
+		{
+			dl->band[i] = dl->bg_color;
+		}
+		for (rt_uint16_t i = 0; i < dl->count; ++i)
+		{
+			st7735r_dlist_draw(dev, &dl->prim[i], dl->band, area->x, area->width, top, lines);
+		}
+		st7735r_burst_begin(dev);
+		st7735r_set_active_rect(dev, area->x, top, area->width, lines);
+		st7735r_show_pixel(dev, RT_ST7735R_WRITE_COLOR_PIXEL, dl->band, area->width * lines);
+		st7735r_burst_end(dev);
+	}
+	st7735r_burst_begin(dev);
+	st7735r_set_active_rect(dev, rect.x, rect.y, rect.width, rect.height);
+	st7735r_burst_end(dev);
+	st7735r_unlock(dev);
+	return RT_EOK;
+}
+#endif
+
+#ifdef PKG_ST7735R_USING_TILE_DIFF
+/*
+ * Full frame submit. The frame is cut into PKG_ST7735R_TILE_SIZE square
+ * tiles and only a 32-bit hash of each tile is kept, tiles whose hash
+ * changed are sent. Changed tiles of a tile row are joined into runs,
+ * bridging unchanged ones when resending them costs less than a window.
+ * Runs covering the same columns in consecutive tile rows share a window.
+ */
+#define ST7735R_TILE_SEED       0x811C9DC5
+#define ST7735R_TILE_PRIME      0x01000193
+/* CASET, RASET and RAMWR with their 8 parameter bytes in 4 transfers, as bytes of pixel data */
+#define ST7735R_WINDOW_COST     64
+
+/* Tile units, rows [y0, current row) */
+struct st7735r_tile_run
+{
+	rt_uint16_t x0, x1, y0;
+};
+
+struct st7735r_tiles
+{
+	rt_uint16_t cols, rows;
+	rt_bool_t valid;
+	struct rt_st7735r_tile_stats stats;
+	rt_uint32_t *hash;
+	rt_uint8_t *changed;
+	/* runs of the rows above waiting to be extended, and those of this row */
+	struct st7735r_tile_run *open, *next;
+};
+
+static struct st7735r_tiles *st7735r_tiles_get(rt_st7735r_t dev)
+{
+	const rt_uint16_t cols = (dev->width + PKG_ST7735R_TILE_SIZE - 1) / PKG_ST7735R_TILE_SIZE;
+	const rt_uint16_t rows = (dev->height + PKG_ST7735R_TILE_SIZE - 1) / PKG_ST7735R_TILE_SIZE;
+	struct st7735r_tiles *tiles = dev->tiles;
+	if (tiles && tiles->cols == cols && tiles->rows == rows)
+	{
+		return tiles;
+	}
+	rt_free(tiles);
+	dev->tiles = RT_NULL;
+	// one block: state, hashes, changed flags and two run lists of at most cols runs
+	tiles = rt_malloc(sizeof(struct st7735r_tiles) + cols * rows * sizeof(rt_uint32_t) + cols * 2 * sizeof(struct st7735r_tile_run) + cols);
+	if (tiles == RT_NULL)
+	{
+		LOG_E(LOG_TAG" no memory for %dx%d tile hashes", cols, rows);
+		return RT_NULL;
+	}
+	rt_memset(tiles, 0x0, sizeof(struct st7735r_tiles));
+	tiles->cols = cols;
+	tiles->rows = rows;
+	tiles->hash = (rt_uint32_t *)(tiles + 1);
+	tiles->open = (struct st7735r_tile_run *)(tiles->hash + cols * rows);
+	tiles->next = tiles->open + cols;
+	tiles->changed = (rt_uint8_t *)(tiles->next + cols);
+	dev->tiles = tiles;
+	return tiles;
+}
+
+static rt_uint32_t st7735r_tile_hash(rt_uint32_t hash, const rt_uint8_t *src, rt_size_t len, rt_size_t stride, rt_uint32_t lines)
+{
+	while (lines--)
+	{
+		rt_size_t i = 0;
+		for (; i + 4 <= len; i += 4)
+		{
+			rt_uint32_t word;
+			rt_memcpy(&word, src + i, 4);
+			hash = (hash ^ word) * ST7735R_TILE_PRIME;
+		}
+		for (; i < len; ++i)
+		{
+			hash = (hash ^ src[i]) * ST7735R_TILE_PRIME;
+		}
+		src += stride;
+	}
+	return hash;
+}
+
+/* Send the tile rect of a run ending above tile row `y1` as one window */
+static void st7735r_tile_send(rt_st7735r_t dev, const struct st7735r_format *fmt, const rt_uint8_t *frame, const struct st7735r_tile_run *run, rt_uint16_t y1)
+{
+	const rt_uint32_t x = run->x0 * PKG_ST7735R_TILE_SIZE;
+	const rt_uint32_t y = run->y0 * PKG_ST7735R_TILE_SIZE;
+	const rt_uint32_t x_end = run->x1 * PKG_ST7735R_TILE_SIZE < dev->width ? run->x1 * PKG_ST7735R_TILE_SIZE : dev->width;
+	const rt_uint32_t y_end = y1 * PKG_ST7735R_TILE_SIZE < dev->height ? y1 * PKG_ST7735R_TILE_SIZE : dev->height;
+	const rt_size_t stride = dev->width * fmt->bits / 8;
+	ST7735R_STAT_BEGIN();
+	st7735r_burst_begin(dev);
+	st7735r_set_active_rect(dev, x, y, x_end - x, y_end - y);
+	st7735r_ramwr_begin(dev);
+	for (rt_uint32_t row = y; row < y_end; ++row)
+	{
+		st7735r_ramwr_convert(dev, fmt, frame + row * stride + x * fmt->bits / 8, x_end - x, RT_TRUE);
+	}
+	st7735r_ramwr_flush(dev);
+	st7735r_burst_end(dev);
+	ST7735R_STAT_END(dev);
+	++dev->tiles->stats.windows;
+}
+
+/*
+ * Send the parts of a full frame that changed since the last one. The
+ * hashes only know about submitted frames, RT_ST7735R_INVALIDATE_TILES
+ * makes the next frame go out whole after drawing through another path.
+ */
+rt_err_t st7735r_submit_frame(rt_st7735r_t dev, rt_uint8_t format, const void *frame)
+{
+	const struct st7735r_format *fmt = st7735r_get_format(dev, format);
+	if (fmt == RT_NULL || fmt->bits < 8)
+	{
+		return -RT_EINVAL;
+	}
+	st7735r_lock(dev);
+	struct st7735r_tiles *tiles = st7735r_tiles_get(dev);
+	if (tiles == RT_NULL)
+	{
+		st7735r_unlock(dev);
+		return -RT_ENOMEM;
+	}
+	const rt_uint8_t *src = (const rt_uint8_t *)frame;
+	const struct rt_st7735r_rect rect = dev->rect;
+	const rt_size_t stride = dev->width * fmt->bits / 8;
+	rt_uint16_t open = 0, skipped = 0;
+	for (rt_uint16_t ty = 0; ty <= tiles->rows; ++ty)
+	{
+		rt_uint16_t next = 0;
+		if (ty < tiles->rows)
+		{
+			const rt_uint32_t y = ty * PKG_ST7735R_TILE_SIZE;
+			const rt_uint32_t lines = dev->height - y < PKG_ST7735R_TILE_SIZE ? dev->height - y : PKG_ST7735R_TILE_SIZE;
+			for (rt_uint16_t tx = 0; tx < tiles->cols; ++tx)
+			{
+				const rt_uint32_t x = tx * PKG_ST7735R_TILE_SIZE;
+				const rt_uint32_t width = dev->width - x < PKG_ST7735R_TILE_SIZE ? dev->width - x : PKG_ST7735R_TILE_SIZE;
+				rt_uint32_t *hash = &tiles->hash[ty * tiles->cols + tx];
+				const rt_uint32_t h = st7735r_tile_hash(ST7735R_TILE_SEED ^ format, src + y * stride + x * fmt->bits / 8, width * fmt->bits / 8, stride, lines);
+				tiles->changed[tx] = !tiles->valid || h != *hash;
+				skipped += !tiles->changed[tx];
+				*hash = h;
+			}
+			// a gap of unchanged tiles is resent when that is cheaper than opening another window
+			const rt_uint32_t gap_max = ST7735R_WINDOW_COST * 8 / (PKG_ST7735R_TILE_SIZE * lines * dev->pack.bits);
+			for (rt_uint16_t tx = 0; tx < tiles->cols; ++tx)
+			{
+				if (!tiles->changed[tx])
+				{
+					continue;
+				}
+				if (next && (rt_uint32_t)(tx - tiles->next[next - 1].x1) <= gap_max)
+				{
+					tiles->next[next - 1].x1 = tx + 1;
+					continue;
+				}
+				tiles->next[next].x0 = tx;
+				tiles->next[next].x1 = tx + 1;
+				tiles->next[next].y0 = ty;
+				++next;
+			}
+		}
+		// open runs continue down when this row has a run over the same columns
+		for (rt_uint16_t i = 0; i < open; ++i)
+		{
+			rt_bool_t extended = RT_FALSE;
+			for (rt_uint16_t j = 0; j < next; ++j)
+			{
+				if (tiles->next[j].x0 == tiles->open[i].x0 && tiles->next[j].x1 == tiles->open[i].x1)
+				{
+					tiles->next[j].y0 = tiles->open[i].y0;
+					extended = RT_TRUE;
+					break;
+				}
+			}
+			if (!extended)
+			{
+				st7735r_tile_send(dev, fmt, src, &tiles->open[i], ty);
+			}
+		}
+		struct st7735r_tile_run *swap = tiles->open;
+		tiles->open = tiles->next;
+		tiles->next = swap;
+		open = next;
+	}
+	tiles->valid = RT_TRUE;
+	tiles->stats.frames += 1;
+	tiles->stats.tiles += tiles->cols * tiles->rows;
+	tiles->stats.skipped += skipped;
+	tiles->stats.last_tiles = tiles->cols * tiles->rows;
+	tiles->stats.last_skipped = skipped;
+	st7735r_burst_begin(dev);
+	st7735r_set_active_rect(dev, rect.x, rect.y, rect.width, rect.height);
+	st7735r_burst_end(dev);
+	st7735r_unlock(dev);
+	return RT_EOK;
+}
+#endif
+
+#ifdef PKG_ST7735R_USING_ASYNC
+/*
+ * Non-blocking write pipeline, enabled by opening the device with
+ * RT_DEVICE_FLAG_DMA_TX. rt_device_write only queues the request, the
+ * stage thread converts it into one of two transfer buffers while the tx
+ * thread sends the other. The caller's buffer is borrowed until the
+ * device's tx_complete callback is called with it.
+ */
+#define ST7735R_CHUNK_RAMWR     0x01
+#define ST7735R_CHUNK_LAST      0x02
+
+#define ST7735R_ASYNC_IDLE      0x01
+
+struct st7735r_async_req
+{
+	const struct st7735r_format *fmt;
+	const void *buffer;
+	rt_size_t size;
+	/* taken at submit time, the stage thread runs behind the caller */
+	struct rt_st7735r_rect rect;
+	struct st7735r_cvt_ctx ctx;
+	rt_uint8_t bits;
+#ifdef PKG_ST7735R_USING_VSYNC
+	/* start after the blanking plus this many us, or -1 at once */
+	rt_int32_t vsync_us;
+#endif
+};
+
+struct st7735r_chunk
+{
+	rt_uint8_t *buf;
+	/* buf, or the caller's buffer for a wire format */
+	const rt_uint8_t *data;
+	rt_size_t len;
+	rt_uint8_t flags;
+	const void *src;
+#ifdef PKG_ST7735R_USING_VSYNC
+	rt_int32_t vsync_us;
+#endif
+};
+
+struct st7735r_async
+{
+	struct rt_messagequeue req_mq;
+	rt_uint8_t req_pool[PKG_ST7735R_ASYNC_QUEUE_DEPTH * (RT_ALIGN(sizeof(struct st7735r_async_req), RT_ALIGN_SIZE) + sizeof(void *))];
+	struct rt_mailbox tx_mb;
+	rt_ubase_t tx_pool[2];
+	struct rt_semaphore tx_free;
+	struct st7735r_chunk chunk[2];
+	rt_uint8_t stage_idx;
+	struct rt_mutex lock;
+	struct rt_event event;
+	rt_uint32_t pending;
+	rt_uint8_t buf[PKG_ST7735R_TX_BUF_SIZE];
+};
+
+static void st7735r_stage_entry(void *parameter)
+{
+	rt_st7735r_t dev = (rt_st7735r_t)parameter;
+	struct st7735r_async *async = dev->async;
+	struct st7735r_async_req req;
+	while (1)
+	{
+		if (rt_mq_recv(&async->req_mq, &req, sizeof(req), RT_WAITING_FOREVER) != RT_EOK)
+		{
+			continue;
+		}
+		const rt_uint8_t *pixel = (const rt_uint8_t *)req.buffer;
+		rt_size_t remain = req.size;
+		// streams are decoded chunk by chunk, the state lives as long as the request
+		struct st7735r_rle rle;
+		st7735r_rle_init(&rle, req.buffer);
+		req.ctx.rle = &rle;
+		rt_uint8_t flags = ST7735R_CHUNK_RAMWR;
+		struct st7735r_pack pack = {req.bits, RT_FALSE, {0}};
+		while (remain)
+		{
+			struct st7735r_chunk *chunk = &async->chunk[async->stage_idx];
+			rt_size_t len = 0;
+			rt_sem_take(&async->tx_free, RT_WAITING_FOREVER);
+			chunk->data = chunk->buf;
+			if ((req.fmt->flags & ST7735R_FORMAT_WIRE) && pack.bits == 16 && remain * 2 > PKG_ST7735R_TX_BUF_SIZE)
+			{
+				// the buffer is lent until tx_complete anyway, send it in place
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+				if (dev->framebuffer)
+				{
+					st7735r_fb_access(dev, &req.rect, ST7735R_FB_WRITE, pixel, RT_NULL, req.size - remain, remain);
+				}
+#endif
+				chunk->data = pixel;
+				len = remain * 2;
+				ST7735R_STAT_ADD(dev, pixels, remain);
+				remain = 0;
+			}
+			// packed formats take a few rounds to fill the chunk
+			while (remain)
+			{
+				rt_size_t n = st7735r_format_chunk(req.fmt, st7735r_pack_room(&pack, PKG_ST7735R_TX_BUF_SIZE - len), remain);
+				if (n == 0)
+				{
+					break;
+				}
+				rt_uint8_t *buf = st7735r_pack_src(&pack, chunk->buf + len, n);
+				req.fmt->cvt(buf, pixel, n, &req.ctx);
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+				if (dev->framebuffer)
+				{
+					st7735r_fb_access(dev, &req.rect, ST7735R_FB_WRITE, buf, RT_NULL, req.size - remain, n);
+				}
+#endif
+				len += st7735r_pack(&pack, chunk->buf + len, n);
+				pixel += n * req.fmt->bits / 8;
+				remain -= n;
+				ST7735R_STAT_ADD(dev, pixels, n);
+			}
+			if (remain == 0)
+			{
+				len += st7735r_pack_finish(&pack, chunk->buf + len);
+			}
+			chunk->len = len;
+			chunk->flags = flags | (remain ? 0 : ST7735R_CHUNK_LAST);
+			chunk->src = req.buffer;
+#ifdef PKG_ST7735R_USING_VSYNC
+			chunk->vsync_us = req.vsync_us;
+#endif
+			rt_mb_send(&async->tx_mb, (rt_ubase_t)chunk);
+			async->stage_idx ^= 1;
+			flags = 0;
+		}
+	}
+}
+
+static void st7735r_tx_entry(void *parameter)
+{
+	rt_st7735r_t dev = (rt_st7735r_t)parameter;
+	struct st7735r_async *async = dev->async;
+	struct st7735r_chunk *chunk;
+#ifdef PKG_ST7735R_USING_VSYNC
+	rt_bool_t paced = RT_FALSE;
+	rt_tick_t start = 0;
+	rt_size_t bytes = 0;
+#endif
+	while (1)
+	{
+		if (rt_mb_recv(&async->tx_mb, (rt_ubase_t *)&chunk, RT_WAITING_FOREVER) != RT_EOK)
+		{
+			continue;
+		}
+		if (chunk->flags & ST7735R_CHUNK_RAMWR)
+		{
+			const rt_uint8_t cmd = ST7735R_RAMWR;
+#ifdef PKG_ST7735R_USING_VSYNC
+			// paced here, the stage thread runs a chunk ahead
+			paced = chunk->vsync_us >= 0;
+			if (paced)
+			{
+				st7735r_vsync_slot(dev, chunk->vsync_us);
+			}
+			start = rt_tick_get();
+			bytes = 0;
+#endif
+			// a queued write holds the bus from its RAMWR to its last chunk, like a blocking one
+			rt_spi_take_bus(dev->spi);
+			ST7735R_STAT_ADD(dev, ramwr, 1);
+			st7735r_dc(dev, PIN_LOW);
+			st7735r_spi_send(dev, &cmd, 1);
+			st7735r_dc(dev, PIN_HIGH);
+		}
+		st7735r_spi_send(dev, chunk->data, chunk->len);
+		const rt_bool_t last = (chunk->flags & ST7735R_CHUNK_LAST) != 0;
+		if (last)
+		{
+			rt_spi_release_bus(dev->spi);
+		}
+#ifdef PKG_ST7735R_USING_VSYNC
+		bytes += chunk->len;
+		if (last && paced)
+		{
+			st7735r_vsync_measure(dev, start, bytes);
+		}
+#endif
+		const void *src = chunk->src;
+		rt_sem_release(&async->tx_free);
+		if (last)
+		{
+			if (dev->parent.tx_complete)
+			{
+				dev->parent.tx_complete(&dev->parent, (void *)src);
+			}
+			rt_mutex_take(&async->lock, RT_WAITING_FOREVER);
+			if (--async->pending == 0)
+			{
+				rt_event_send(&async->event, ST7735R_ASYNC_IDLE);
+			}
+			rt_mutex_release(&async->lock);
+		}
+	}
+}
+
+static rt_err_t st7735r_async_start(rt_st7735r_t dev)
+{
+	char name[RT_NAME_MAX];
+	struct st7735r_async *async = dev->async;
+	if (async)
+	{
+		return RT_EOK;
+	}
+	async = rt_malloc(sizeof(struct st7735r_async));
+	if (async == RT_NULL)
+	{
+		return -RT_ENOMEM;
+	}
+	rt_memset(async, 0x0, sizeof(struct st7735r_async));
+	rt_mq_init(&async->req_mq, dev->parent.parent.name, async->req_pool, sizeof(struct st7735r_async_req), sizeof(async->req_pool), RT_IPC_FLAG_FIFO);
+	rt_mb_init(&async->tx_mb, dev->parent.parent.name, async->tx_pool, 2, RT_IPC_FLAG_FIFO);
+	rt_sem_init(&async->tx_free, dev->parent.parent.name, 2, RT_IPC_FLAG_FIFO);
+	rt_mutex_init(&async->lock, dev->parent.parent.name, RT_IPC_FLAG_FIFO);
+	rt_event_init(&async->event, dev->parent.parent.name, RT_IPC_FLAG_FIFO);
+	rt_event_send(&async->event, ST7735R_ASYNC_IDLE);
+	async->chunk[0].buf = dev->tx_buf;
+	async->chunk[1].buf = async->buf;
+
+	rt_snprintf(name, RT_NAME_MAX, "%scv", dev->parent.parent.name);
+	rt_thread_t stage = rt_thread_create(name, st7735r_stage_entry, dev, PKG_ST7735R_ASYNC_THREAD_STACK, PKG_ST7735R_ASYNC_THREAD_PRIORITY, 10);
+	rt_snprintf(name, RT_NAME_MAX, "%stx", dev->parent.parent.name);
+	rt_thread_t tx = rt_thread_create(name, st7735r_tx_entry, dev, PKG_ST7735R_ASYNC_THREAD_STACK, PKG_ST7735R_ASYNC_THREAD_PRIORITY, 10);
+	if (stage == RT_NULL || tx == RT_NULL)
+	{
+		LOG_E(LOG_TAG" create async threads failed");
+		// neither was started, writes stay synchronous
+		if (stage)
+		{
+			rt_thread_delete(stage);
+		}
+		if (tx)
+		{
+			rt_thread_delete(tx);
+		}
+		rt_mq_detach(&async->req_mq);
+		rt_mb_detach(&async->tx_mb);
+		rt_sem_detach(&async->tx_free);
+		rt_mutex_detach(&async->lock);
+		rt_event_detach(&async->event);
+		rt_free(async);
+		return -RT_ERROR;
+	}
+	// the threads pick it up when they start
+	dev->async = async;
+	rt_thread_startup(stage);
+	rt_thread_startup(tx);
+	return RT_EOK;
+}
+
+static rt_err_t st7735r_async_submit(rt_st7735r_t dev, const struct st7735r_format *fmt, const void *buffer, rt_size_t size)
+{
+	struct st7735r_async *async = dev->async;
+	struct st7735r_async_req req =
+	{
+		fmt, buffer, size, dev->rect, dev->cvt_ctx, dev->pack.bits,
+#ifdef PKG_ST7735R_USING_VSYNC
+		st7735r_vsync_paced(dev, size) ? (rt_int32_t)st7735r_vsync_delay(dev) : -1,
+#endif
+	};
+	rt_mutex_take(&async->lock, RT_WAITING_FOREVER);
+	if (async->pending++ == 0)
+	{
+		rt_event_recv(&async->event, ST7735R_ASYNC_IDLE, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, RT_WAITING_NO, RT_NULL);
+	}
+	rt_mutex_release(&async->lock);
+	/* Blocks only while PKG_ST7735R_ASYNC_QUEUE_DEPTH requests are already queued */
+	return rt_mq_send_wait(&async->req_mq, &req, sizeof(req), RT_WAITING_FOREVER);
+}
+
+/* Wait until every queued write is on the wire, a timeout of 0 only polls */
+static rt_err_t st7735r_async_wait(rt_st7735r_t dev, rt_int32_t timeout)
+{
+	if (dev->async == RT_NULL)
+	{
+		return RT_EOK;
+	}
+	if (rt_event_recv(&dev->async->event, ST7735R_ASYNC_IDLE, RT_EVENT_FLAG_OR, timeout, RT_NULL) != RT_EOK)
+	{
+		return timeout == RT_WAITING_NO ? -RT_EBUSY : -RT_ETIMEOUT;
+	}
+	return RT_EOK;
+}
+#endif
+
+void st7735r_set_bl(rt_st7735r_t dev, rt_bool_t on)
+{
+#ifdef PKG_ST7735R_ADJ_BL
+	if (on)
+	{
+		rt_size_t period = 1000000000 / PKG_ST7735R_BL_PWM_FREQ;
+		rt_pwm_set(dev->bl_pwm, dev->bl_channel, period, period * dev->bl_value / 100);
+		rt_pwm_enable(dev->bl_pwm, dev->bl_channel);
+	}
+	else
+	{
+		rt_pwm_disable(dev->bl_pwm, dev->bl_channel);
+	}
+#else
+	rt_pin_write(dev->bl_pin, on);
+#endif
+}
+
+static void st7735r_init_colmod(rt_st7735r_t dev, rt_uint8_t colmod)
+{
+	st7735r_write_cmd(dev, ST7735R_COLMOD, &colmod, 1);
+	dev->colmod = colmod;
+	dev->pack.bits = colmod == RT_ST7735R_COLMOD_12BIT ? 12 : (colmod == RT_ST7735R_COLMOD_18BIT ? 18 : 16);
+	dev->pack.odd = RT_FALSE;
+}
+
+static void st7735r_init_panel(rt_st7735r_t dev)
+{
+	// the offsets follow the variant only together with its MADCTL and script
+	dev->panel = dev->panel_next;
+	const struct st7735r_panel *panel = &st7735r_panels[dev->panel];
+	st7735r_run_script(dev, panel->script, panel->script_len);
+	dev->scroll.height = 0;
+#ifdef PKG_ST7735R_USING_TILE_DIFF
+	if (dev->tiles)
+	{
+		dev->tiles->valid = RT_FALSE;
+	}
+#endif
+	st7735r_init_colmod(dev, dev->colmod);
+	dev->win.x0 = dev->win.y0 = 0xFFFF;
+	st7735r_init_ori(dev, dev->ori);
+	st7735r_init_frmctr(dev, dev->fps);
+#ifdef PKG_ST7735R_USING_VSYNC
+	st7735r_init_te(dev);
+#endif
+	st7735r_set_active_rect(dev, 0, 0, dev->width, dev->height);
+	st7735r_write_cmd(dev, ST7735R_DISPON, RT_NULL, 0);
+}
+
+/*
+ * Switch orientation at runtime, width and height swap between portrait and
+ * landscape. The GRAM is not rotated along, so the panel is cleared and
+ * hardware scrolling is turned off.
+ */
+rt_err_t st7735r_set_ori(rt_st7735r_t dev, rt_uint8_t ori)
+{
+	if (ori > 3)
+	{
+		LOG_E(LOG_TAG" %d is wrong orientation", ori);
+		return -RT_ERROR;
+	}
+	if ((ori ^ dev->ori) & 1)
+	{
+		const rt_uint8_t width = dev->width;
+		dev->width = dev->height;
+		dev->height = width;
+		dev->lcd_info.width = dev->width;
+		dev->lcd_info.height = dev->height;
+	}
+	if (dev->scroll.height)
+	{
+		st7735r_set_scroll_area(dev, 0, 0);
+	}
+	dev->ori = ori;
+	st7735r_init_ori(dev, ori);
+#ifdef PKG_ST7735R_USING_TILE_DIFF
+	if (dev->tiles)
+	{
+		dev->tiles->valid = RT_FALSE;
+	}
+#endif
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+	dev->dirty.x0 = 1;
+	dev->dirty.x1 = 0;
+#endif
+	st7735r_clear(dev, 0x0);
+	return RT_EOK;
+}
+
+#if defined(PKG_ST7735R_USING_READBACK) && defined(PKG_ST7735R_USING_SPI_TUNE)
+#define ST7735R_TUNE_PIXELS     32
+#define ST7735R_TUNE_ROUNDS     4
+
+/* Write a pattern to the first pixels of the panel at the current clock, read it and RDDID back */
+static rt_bool_t st7735r_tune_check(rt_st7735r_t dev, const rt_uint8_t *id, rt_uint32_t seed)
+{
+	rt_uint16_t pattern[ST7735R_TUNE_PIXELS], back[ST7735R_TUNE_PIXELS];
+	rt_uint8_t now[4];
+	pattern[0] = 0x0000;
+	pattern[1] = 0xFFFF;
+	pattern[2] = 0x5555;
+	pattern[3] = 0xAAAA;
+	for (rt_size_t i = 4; i < ST7735R_TUNE_PIXELS; ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		pattern[i] = seed >> 16;
+	}
+	// a window cached from a failed step may never have arrived
+	dev->win.x0 = dev->win.y0 = 0xFFFF;
+	st7735r_set_active_rect(dev, 0, 0, ST7735R_TUNE_PIXELS, 1);
+	st7735r_ramwr_begin(dev);
+	st7735r_ramwr_convert(dev, &st7735r_formats[RT_ST7735R_WRITE_COLOR_PIXEL], pattern, ST7735R_TUNE_PIXELS, RT_FALSE);
+	st7735r_ramwr_flush(dev);
+	if (st7735r_read_pixel(dev, back, ST7735R_TUNE_PIXELS) != RT_EOK)
+	{
+		return RT_FALSE;
+	}
+	st7735r_read_id(dev, now);
+	return rt_memcmp(pattern, back, sizeof(pattern)) == 0 && rt_memcmp(id, now, sizeof(now)) == 0;
+}
+
+/*
+ * Step the write clock up from the current one until the link fails and
+ * settle PKG_ST7735R_SPI_TUNE_MARGIN percent below the last clock that
+ * passed, never below the clock it started from. A failed step may have
+ * garbled any command, so the panel is reset and its registers rewritten
+ * at the chosen clock, the first pixels of the panel are restored.
+ */
+rt_err_t st7735r_calibrate_spi(rt_st7735r_t dev, rt_uint32_t *hz)
+{
+	rt_uint16_t saved[ST7735R_TUNE_PIXELS];
+	rt_uint8_t id[4];
+	const struct rt_st7735r_rect rect = dev->rect;
+	const rt_uint8_t colmod = dev->colmod;
+	const rt_uint32_t base = dev->spi_hz;
+	rt_uint32_t best = 0;
+	if (!dev->ramrd)
+	{
+		return -RT_ENOSYS;
+	}
+	st7735r_set_active_rect(dev, 0, 0, ST7735R_TUNE_PIXELS, 1);
+	st7735r_read_pixel(dev, saved, ST7735R_TUNE_PIXELS);
+	st7735r_read_id(dev, id);
+	// the pattern reads back exactly in 16-bit
+	st7735r_init_colmod(dev, RT_ST7735R_COLMOD_16BIT);
+	for (rt_uint32_t clock = base; clock <= PKG_ST7735R_SPI_TUNE_MAX_HZ; clock += PKG_ST7735R_SPI_TUNE_STEP_HZ)
+	{
+		rt_bool_t ok = RT_TRUE;
+		st7735r_spi_clock(dev, clock);
+		for (rt_uint32_t round = 0; round < ST7735R_TUNE_ROUNDS && ok; ++round)
+		{
+			ok = st7735r_tune_check(dev, id, clock + round);
+		}
+		if (!ok)
+		{
+			break;
+		}
+		best = clock;
+	}
+	const rt_uint32_t chosen = best - best / 100 * PKG_ST7735R_SPI_TUNE_MARGIN;
+	st7735r_spi_clock(dev, chosen > base ? chosen : base);
+	st7735r_run_script(dev, st7735r_script_reset, sizeof(st7735r_script_reset));
+	dev->colmod = colmod;
+	st7735r_init_panel(dev);
+	st7735r_set_active_rect(dev, 0, 0, ST7735R_TUNE_PIXELS, 1);
+	st7735r_ramwr_begin(dev);
+	st7735r_ramwr_convert(dev, &st7735r_formats[RT_ST7735R_WRITE_COLOR_PIXEL], saved, ST7735R_TUNE_PIXELS, RT_FALSE);
+	st7735r_ramwr_flush(dev);
+	st7735r_set_active_rect(dev, rect.x, rect.y, rect.width, rect.height);
+	if (hz)
+	{
+		*hz = dev->spi_hz;
+	}
+	if (best == 0)
+	{
+		LOG_E(LOG_TAG" link check failed at %d Hz", base);
+		return -RT_ERROR;
+	}
+	return RT_EOK;
+}
+#endif
+
+#ifdef PKG_ST7735R_USING_RENDER
+/*
+ * Render service: producers post draw commands into a bounded lock-free
+ * ring and return at once, the render thread drains it in batches, drops
+ * or merges what a batch makes redundant and draws the rest under the
+ * device lock. Cells carry a sequence number so any number of producers
+ * can claim slots with a CAS on the tail while the single consumer owns
+ * the head (Vyukov's bounded MPMC queue, reduced to one consumer).
+ */
+#define ST7735R_RENDER_SYNC     0x80
+#define ST7735R_RENDER_BATCH    16
+
+#define ST7735R_RING_MASK       (PKG_ST7735R_RENDER_RING_SIZE - 1)
+
+#if PKG_ST7735R_RENDER_RING_SIZE & ST7735R_RING_MASK
+#error "PKG_ST7735R_RENDER_RING_SIZE must be a power of two"
+#endif
+
+struct st7735r_render_cell
+{
+	rt_uint32_t seq;
+	rt_tick_t posted;
+	struct rt_st7735r_render_cmd cmd;
+};
+
+struct st7735r_render
+{
+	struct st7735r_render_cell ring[PKG_ST7735R_RENDER_RING_SIZE];
+	rt_uint32_t tail;
+	rt_uint32_t head;
+	/* the consumer is about to sleep on `wake`, or producers on `space` */
+	rt_uint32_t sleeping;
+	rt_uint32_t waiters;
+	struct rt_semaphore wake;
+	struct rt_semaphore space;
+	struct rt_st7735r_render_stats stats;
+};
+
+static rt_bool_t st7735r_ring_push(struct st7735r_render *render, const struct rt_st7735r_render_cmd *cmd)
+{
+	rt_uint32_t pos = __atomic_load_n(&render->tail, __ATOMIC_RELAXED);
+	struct st7735r_render_cell *cell;
+	while (1)
+	{
+		cell = &render->ring[pos & ST7735R_RING_MASK];
+		const rt_int32_t dif = (rt_int32_t)(__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) - pos);
+		if (dif == 0)
+		{
+			if (__atomic_compare_exchange_n(&render->tail, &pos, pos + 1, RT_TRUE, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+			{
+				break;
+			}
+		}
+		else if (dif < 0)
+		{
+			return RT_FALSE;
+		}
+		else
+		{
+			pos = __atomic_load_n(&render->tail, __ATOMIC_RELAXED);
+		}
+	}
+	cell->cmd = *cmd;
+	cell->posted = rt_tick_get();
+	__atomic_store_n(&cell->seq, pos + 1, __ATOMIC_RELEASE);
+
+	// high watermark, the head may move meanwhile so this is an upper bound
+	const rt_uint32_t depth = pos + 1 - __atomic_load_n(&render->head, __ATOMIC_RELAXED);
+	rt_uint32_t max = __atomic_load_n(&render->stats.depth_max, __ATOMIC_RELAXED);
+	while (depth > max && !__atomic_compare_exchange_n(&render->stats.depth_max, &max, depth, RT_TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+	return RT_TRUE;
+}
+
+static rt_bool_t st7735r_ring_pop(struct st7735r_render *render, struct st7735r_render_cell *out)
+{
+	struct st7735r_render_cell *cell = &render->ring[render->head & ST7735R_RING_MASK];
+	if (__atomic_load_n(&cell->seq, __ATOMIC_ACQUIRE) != render->head + 1)
+	{
+		return RT_FALSE;
+	}
+	*out = *cell;
+	__atomic_store_n(&cell->seq, render->head + PKG_ST7735R_RENDER_RING_SIZE, __ATOMIC_RELEASE);
+	__atomic_store_n(&render->head, render->head + 1, __ATOMIC_RELAXED);
+	return RT_TRUE;
+}
+
+/* Union of two rects when it is a rect itself, i.e. they share a full edge and touch or overlap */
+static rt_bool_t st7735r_rect_join(struct rt_st7735r_rect *a, const struct rt_st7735r_rect *b)
+{
+	if (a->x == b->x && a->width == b->width && b->y <= a->y + a->height && a->y <= b->y + b->height)
+	{
+		const rt_uint16_t bottom = a->y + a->height > b->y + b->height ? a->y + a->height : b->y + b->height;
+		a->y = a->y < b->y ? a->y : b->y;
+		a->height = bottom - a->y;
+		return RT_TRUE;
+	}
+	if (a->y == b->y && a->height == b->height && b->x <= a->x + a->width && a->x <= b->x + b->width)
+	{
+		const rt_uint16_t right = a->x + a->width > b->x + b->width ? a->x + a->width : b->x + b->width;
+		a->x = a->x < b->x ? a->x : b->x;
+		a->width = right - a->x;
+		return RT_TRUE;
+	}
+	return RT_FALSE;
+}
+
+static rt_bool_t st7735r_render_draws(const struct rt_st7735r_render_cmd *cmd)
+{
+	return cmd->op == RT_ST7735R_RENDER_FILL || cmd->op == RT_ST7735R_RENDER_RECT || cmd->op == RT_ST7735R_RENDER_BLIT;
+}
+
+/*
+ * Mark the commands of a batch made redundant by later ones: draws fully
+ * covered by a later fill or blit, backlight and scroll changes overridden
+ * before they were seen. Scrolling is a barrier for covering, it moves what
+ * was drawn before it. Neighbouring fills of one color and blits whose
+ * buffers follow each other are joined into the first one.
+ */
+static void st7735r_render_merge(struct st7735r_render *render, struct st7735r_render_cell *batch, rt_bool_t *dead, rt_size_t count)
+{
+	for (rt_size_t i = 0; i < count; ++i)
+	{
+		const struct rt_st7735r_render_cmd *cmd = &batch[i].cmd;
+		for (rt_size_t j = i + 1; j < count && !dead[i]; ++j)
+		{
+			const struct rt_st7735r_render_cmd *later = &batch[j].cmd;
+			if (later->op == RT_ST7735R_RENDER_SCROLL && cmd->op != RT_ST7735R_RENDER_SCROLL)
+			{
+				break;
+			}
+			if (later->op == ST7735R_RENDER_SYNC)
+			{
+				break;
+			}
+			if (st7735r_render_draws(cmd) && (later->op == RT_ST7735R_RENDER_FILL || later->op == RT_ST7735R_RENDER_BLIT))
+			{
+				dead[i] = st7735r_rect_contains(&later->rect, &cmd->rect);
+			}
+			else if ((cmd->op == RT_ST7735R_RENDER_BL || cmd->op == RT_ST7735R_RENDER_SCROLL) && later->op == cmd->op)
+			{
+				dead[i] = RT_TRUE;
+			}
+		}
+		render->stats.merged += dead[i];
+	}
+	for (rt_size_t i = 0; i < count; ++i)
+	{
+		struct rt_st7735r_render_cmd *cmd = &batch[i].cmd;
+		if (dead[i] || (cmd->op != RT_ST7735R_RENDER_FILL && cmd->op != RT_ST7735R_RENDER_BLIT))
+		{
+			continue;
+		}
+		// only the next live command, joining across others would reorder overlapping draws
+		for (rt_size_t j = i + 1; j < count; ++j)
+		{
+			if (dead[j])
+			{
+				continue;
+			}
+			const struct rt_st7735r_render_cmd *next = &batch[j].cmd;
+			rt_bool_t joined = RT_FALSE;
+			if (cmd->op == RT_ST7735R_RENDER_FILL && next->op == RT_ST7735R_RENDER_FILL && next->value == cmd->value)
+			{
+				joined = st7735r_rect_join(&cmd->rect, &next->rect);
+			}
+			else if (cmd->op == RT_ST7735R_RENDER_BLIT && next->op == RT_ST7735R_RENDER_BLIT && next->format == cmd->format
+				&& next->rect.x == cmd->rect.x && next->rect.width == cmd->rect.width && next->rect.y == cmd->rect.y + cmd->rect.height)
+			{
+				const rt_size_t bits = (rt_size_t)cmd->rect.width * cmd->rect.height * st7735r_formats[cmd->format].bits;
+				// streams restart at every blit and can not be joined
+				joined = bits && bits % 8 == 0 && (const rt_uint8_t *)next->buffer == (const rt_uint8_t *)cmd->buffer + bits / 8;
+				if (joined)
+				{
+					cmd->rect.height += next->rect.height;
+				}
+			}
+			if (!joined)
+			{
+				break;
+			}
+			dead[j] = RT_TRUE;
+			++render->stats.merged;
+		}
+	}
+}
+
+static void st7735r_render_draw(rt_st7735r_t dev, const struct rt_st7735r_render_cmd *cmd)
+{
+	const struct rt_st7735r_rect *r = &cmd->rect;
+	switch (cmd->op)
+	{
+	case RT_ST7735R_RENDER_FILL:
+		st7735r_fill_rect(dev, r->x, r->y, r->width, r->height, cmd->value);
+		break;
+	case RT_ST7735R_RENDER_RECT:
+		st7735r_fill_rect(dev, r->x, r->y, r->width, 1, cmd->value);
+		st7735r_fill_rect(dev, r->x, r->y + r->height - 1, r->width, 1, cmd->value);
+		st7735r_fill_rect(dev, r->x, r->y, 1, r->height, cmd->value);
+		st7735r_fill_rect(dev, r->x + r->width - 1, r->y, 1, r->height, cmd->value);
+		break;
+	case RT_ST7735R_RENDER_BLIT:
+	{
+		const struct rt_st7735r_rect rect = dev->rect;
+		st7735r_set_active_rect(dev, r->x, r->y, r->width, r->height);
+		st7735r_show_pixel(dev, cmd->format, cmd->buffer, r->width * r->height);
+		st7735r_set_active_rect(dev, rect.x, rect.y, rect.width, rect.height);
+		break;
+	}
+	case RT_ST7735R_RENDER_SCROLL:
+		st7735r_set_scroll(dev, cmd->value);
+		break;
+	case RT_ST7735R_RENDER_BL:
+#ifdef PKG_ST7735R_ADJ_BL
+		dev->bl_value = cmd->value;
+#endif
+		st7735r_set_bl(dev, cmd->value != 0);
+		break;
+	}
+}
+
+static void st7735r_render_entry(void *parameter)
+{
+	rt_st7735r_t dev = (rt_st7735r_t)parameter;
+	struct st7735r_render *render = dev->render;
+	struct st7735r_render_cell batch[ST7735R_RENDER_BATCH];
+	rt_bool_t dead[ST7735R_RENDER_BATCH];
+	while (1)
+	{
+		rt_size_t count = 0;
+		while (count < ST7735R_RENDER_BATCH && st7735r_ring_pop(render, &batch[count]))
+		{
+			dead[count++] = RT_FALSE;
+		}
+		__atomic_thread_fence(__ATOMIC_SEQ_CST);
+		if (__atomic_load_n(&render->waiters, __ATOMIC_RELAXED))
+		{
+			rt_sem_release(&render->space);
+		}
+		if (count == 0)
+		{
+			// announce the sleep, then look again so a racing post is not missed
+			__atomic_store_n(&render->sleeping, 1, __ATOMIC_SEQ_CST);
+			if (__atomic_load_n(&render->tail, __ATOMIC_SEQ_CST) == render->head)
+			{
+				rt_sem_take(&render->wake, RT_WAITING_FOREVER);
+			}
+			__atomic_store_n(&render->sleeping, 0, __ATOMIC_RELAXED);
+			continue;
+		}
+		st7735r_render_merge(render, batch, dead, count);
+		const rt_tick_t now = rt_tick_get();
+		st7735r_lock(dev);
+		for (rt_size_t i = 0; i < count; ++i)
+		{
+			const rt_tick_t latency = now - batch[i].posted;
+			render->stats.latency_sum += latency;
+			if (latency > render->stats.latency_max)
+			{
+				render->stats.latency_max = latency;
+			}
+			if (!dead[i] && batch[i].cmd.op != ST7735R_RENDER_SYNC)
+			{
+				st7735r_render_draw(dev, &batch[i].cmd);
+			}
+		}
+		st7735r_unlock(dev);
+		// borrowed buffers go back once the whole batch is drawn, merged blits share them
+		for (rt_size_t i = 0; i < count; ++i)
+		{
+			const struct rt_st7735r_render_cmd *cmd = &batch[i].cmd;
+			if (cmd->op == ST7735R_RENDER_SYNC)
+			{
+				rt_sem_release((rt_sem_t)cmd->arg);
+			}
+			else if (cmd->release)
+			{
+				cmd->release(cmd->buffer, cmd->arg);
+			}
+		}
+		render->stats.executed += count;
+		++render->stats.batches;
+	}
+}
+
+static rt_err_t st7735r_render_start(rt_st7735r_t dev)
+{
+	char name[RT_NAME_MAX];
+	struct st7735r_render *render = dev->render;
+	if (render)
+	{
+		return RT_EOK;
+	}
+	render = rt_malloc(sizeof(struct st7735r_render));
+	if (render == RT_NULL)
+	{
+		return -RT_ENOMEM;
+	}
+	rt_memset(render, 0x0, sizeof(struct st7735r_render));
+	for (rt_uint32_t i = 0; i < PKG_ST7735R_RENDER_RING_SIZE; ++i)
+	{
+		render->ring[i].seq = i;
+	}
+	rt_sem_init(&render->wake, dev->parent.parent.name, 0, RT_IPC_FLAG_FIFO);
+	rt_sem_init(&render->space, dev->parent.parent.name, 0, RT_IPC_FLAG_FIFO);
+
+	rt_snprintf(name, RT_NAME_MAX, "%srd", dev->parent.parent.name);
+	rt_thread_t thread = rt_thread_create(name, st7735r_render_entry, dev, PKG_ST7735R_RENDER_THREAD_STACK, PKG_ST7735R_RENDER_THREAD_PRIORITY, 10);
+	if (thread == RT_NULL)
+	{
+		LOG_E(LOG_TAG" create render thread failed");
+		rt_sem_detach(&render->wake);
+		rt_sem_detach(&render->space);
+		rt_free(render);
+		return -RT_ERROR;
+	}
+	// posts are refused until the ring has a thread behind it
+	dev->render = render;
+	rt_thread_startup(thread);
+	return RT_EOK;
+}
+
+/*
+ * Queue a draw command, lock-free unless the ring is full. Then the caller
+ * waits up to `timeout` for the render thread to make room, a timeout of 0
+ * fails at once with -RT_EFULL.
+ */
+rt_err_t st7735r_render_post(rt_st7735r_t dev, const struct rt_st7735r_render_cmd *cmd, rt_int32_t timeout)
+{
+	struct st7735r_render *render = dev->render;
+	if (render == RT_NULL)
+	{
+		return -RT_ERROR;
+	}
+	if (cmd->op == RT_ST7735R_RENDER_BLIT && st7735r_get_format(dev, cmd->format) == RT_NULL)
+	{
+		return -RT_EINVAL;
+	}
+	if (cmd->op == RT_ST7735R_RENDER_BL && cmd->value > 100)
+	{
+		LOG_E(LOG_TAG" %d is wrong backlight value", cmd->value);
+		return -RT_EINVAL;
+	}
+	while (!st7735r_ring_push(render, cmd))
+	{
+		__atomic_fetch_add(&render->stats.full, 1, __ATOMIC_RELAXED);
+		if (timeout == RT_WAITING_NO)
+		{
+			return -RT_EFULL;
+		}
+		__atomic_fetch_add(&render->waiters, 1, __ATOMIC_SEQ_CST);
+		// room may have been made before the render thread could see us waiting
+		const rt_bool_t pushed = st7735r_ring_push(render, cmd);
+		const rt_err_t result = pushed ? RT_EOK : rt_sem_take(&render->space, timeout);
+		__atomic_fetch_sub(&render->waiters, 1, __ATOMIC_RELAXED);
+		if (result != RT_EOK)
+		{
+			return -RT_EFULL;
+		}
+		if (pushed)
+		{
+			break;
+		}
+	}
+	__atomic_fetch_add(&render->stats.posted, 1, __ATOMIC_RELAXED);
+	if (__atomic_exchange_n(&render->sleeping, 0, __ATOMIC_SEQ_CST))
+	{
+		rt_sem_release(&render->wake);
+	}
+	return RT_EOK;
+}
+
+/* Wait until everything posted before is drawn */
+rt_err_t st7735r_render_sync(rt_st7735r_t dev)
+{
+	struct rt_semaphore done;
+	struct rt_st7735r_render_cmd cmd;
+	rt_memset(&cmd, 0x0, sizeof(cmd));
+	cmd.op = ST7735R_RENDER_SYNC;
+	cmd.arg = &done;
+	rt_sem_init(&done, dev->parent.parent.name, 0, RT_IPC_FLAG_FIFO);
+	rt_err_t result = st7735r_render_post(dev, &cmd, RT_WAITING_FOREVER);
+	if (result == RT_EOK)
+	{
+		rt_sem_take(&done, RT_WAITING_FOREVER);
+	}
+	rt_sem_detach(&done);
+	return result;
+}
+#endif
+
+static rt_err_t st7735r_init(rt_device_t dev)
+{
+	rt_st7735r_t st7735r_dev = (rt_st7735r_t)dev;
+	st7735r_lock(st7735r_dev);
+	st7735r_spi_clock(st7735r_dev, st7735r_dev->spi_hz);
+	
+	rt_pin_write(st7735r_dev->res_pin, PIN_LOW);
+	rt_thread_mdelay(100);
+	rt_pin_write(st7735r_dev->res_pin, PIN_HIGH);
+#if !defined(PKG_ST7735R_ADJ_BL)
+		rt_pin_write(st7735r_dev->bl_pin, PIN_LOW);
+#endif
+	st7735r_dc(st7735r_dev, PIN_HIGH);
+
+	st7735r_run_script(st7735r_dev, st7735r_script_reset, sizeof(st7735r_script_reset));
+#ifdef PKG_ST7735R_USING_READBACK
+	st7735r_dev->ramrd = st7735r_probe_read(st7735r_dev);
+	if (!st7735r_dev->ramrd)
+	{
+		LOG_W(LOG_TAG" no response to RDDID, pixel readback is off");
+	}
+#endif
+	st7735r_init_panel(st7735r_dev);
+	rt_thread_mdelay(10);
+	st7735r_unlock(st7735r_dev);
+	return RT_EOK;
+}
+
+static rt_err_t st7735r_open(rt_device_t dev, rt_uint16_t oflag)
+{
+	rt_st7735r_t lcd = (rt_st7735r_t)dev;
+#ifndef PKG_ST7735R_USING_ASYNC
+	(void)oflag;
+#endif
+	st7735r_lock(lcd);
+#ifdef PKG_ST7735R_USING_ASYNC
+	if ((oflag & RT_DEVICE_FLAG_DMA_TX) && st7735r_async_start(lcd) != RT_EOK)
+	{
+		st7735r_unlock(lcd);
+		return -RT_ERROR;
+	}
+#endif
+#ifdef PKG_ST7735R_USING_RENDER
+	if (st7735r_render_start(lcd) != RT_EOK)
+	{
+		st7735r_unlock(lcd);
+		return -RT_ERROR;
+	}
+#endif
+    st7735r_clear(lcd, 0x0);
+	st7735r_set_bl(lcd, RT_TRUE);
+	st7735r_unlock(lcd);
+	return RT_EOK;
+}
+
+static rt_err_t st7735r_close(rt_device_t dev)
+{
+	if (dev->ref_count == 0)
+	{
+		rt_st7735r_t lcd = (rt_st7735r_t)dev;
+		st7735r_lock(lcd);
+    	st7735r_clear(lcd, 0x0);
+#ifdef PKG_ST7735R_ADJ_BL
+		rt_pwm_disable(lcd->bl_pwm, lcd->bl_channel);
+#else
+		rt_pin_write(lcd->bl_pin, PIN_LOW);
+#endif
+		st7735r_unlock(lcd);
+	}
+	return RT_EOK;
+}
+
+static rt_size_t st7735r_do_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+#if !defined(PKG_ST7735R_USING_FRAMEBUFFER) && !defined(PKG_ST7735R_USING_READBACK)
+	(void)dev;
+	(void)pos;
+	(void)buffer;
+	(void)size;
+#endif
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+	rt_st7735r_t lcd = (rt_st7735r_t)dev;
+	if (pos == RT_ST7735R_READ_COLOR_PIXEL && lcd->framebuffer)
+	{
+		st7735r_fb_sync(lcd);
+		st7735r_fb_access(lcd, &lcd->rect, ST7735R_FB_READ, RT_NULL, buffer, 0, size);
+		return size;
+	}
+#endif
+#ifdef PKG_ST7735R_USING_READBACK
+	if (pos == RT_ST7735R_READ_COLOR_PIXEL && st7735r_read_pixel((rt_st7735r_t)dev, buffer, size) == RT_EOK)
+	{
+		return size;
+	}
+#endif
+	return 0;
+}
+
+static rt_size_t st7735r_do_write(rt_device_t _dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+	rt_st7735r_t dev = (rt_st7735r_t)_dev;
+	const struct st7735r_format *fmt = st7735r_get_format(dev, pos);
+	if (fmt == RT_NULL)
+	{
+		return 0;
+	}
+	ST7735R_STAT_BEGIN();
+#ifdef PKG_ST7735R_USING_ASYNC
+	if (dev->async && (dev->parent.open_flag & RT_DEVICE_FLAG_DMA_TX))
+	{
+		if (size == 0)
+		{
+			return 0;
+		}
+		dev->ramwr_open = RT_FALSE;
+		// only the time spent waiting for a free queue slot is accounted
+		rt_err_t result = st7735r_async_submit(dev, fmt, buffer, size);
+		ST7735R_STAT_END(dev);
+		return result == RT_EOK ? size : 0;
 	}
-	case RT_ST7735R_WRITE_GRAYSCALE_PIXEL:
+#endif
+#ifdef PKG_ST7735R_USING_VSYNC
+	const rt_bool_t paced = st7735r_vsync_paced(dev, size);
+	if (paced)
 	{
-		st7735r_show_grayscale_pixel(dev, (const rt_uint8_t *)buffer, size);
-		return size;
+		st7735r_vsync_wait(dev);
 	}
-	default:
-		return 0;
+	const rt_tick_t start = rt_tick_get();
+#endif
+	st7735r_burst_begin(dev);
+	st7735r_ramwr_begin(dev);
+	st7735r_ramwr_write(dev, fmt, buffer, size);
+	st7735r_ramwr_flush(dev);
+	st7735r_burst_end(dev);
+#ifdef PKG_ST7735R_USING_VSYNC
+	if (paced)
+	{
+		st7735r_vsync_measure(dev, start, size * dev->pack.bits / 8);
 	}
+#endif
+	ST7735R_STAT_END(dev);
+	return size;
 }
 
-static rt_err_t st7735r_control(rt_device_t dev, int cmd, void *args)
+static rt_err_t st7735r_do_control(rt_device_t dev, int cmd, void *args)
 {
 	rt_st7735r_t lcd = (rt_st7735r_t)dev;
 	switch (cmd)
@@ -384,6 +3517,142 @@ static rt_err_t st7735r_control(rt_device_t dev, int cmd, void *args)
 		st7735r_set_active_rect(lcd, rect->x, rect->y, rect->width, rect->height);
 		return RT_EOK;
 	}
+	case RT_ST7735R_FILL_RECT:
+	{
+		const struct rt_st7735r_fill *fill = (const struct rt_st7735r_fill *)args;
+		return st7735r_fill_rect(lcd, fill->rect.x, fill->rect.y, fill->rect.width, fill->rect.height, fill->color);
+	}
+#ifdef PKG_ST7735R_USING_DLIST
+	case RT_ST7735R_DLIST_RENDER:
+	{
+		return st7735r_dlist_render(lcd, (struct rt_st7735r_dlist *)args, RT_NULL);
+	}
+#endif
+	case RT_ST7735R_BLIT_RECT:
+	{
+		return st7735r_blit_rect(lcd, (const struct rt_st7735r_blit *)args);
+	}
+	case RT_ST7735R_SET_ORI:
+	{
+		return st7735r_set_ori(lcd, *((rt_uint8_t *)args));
+	}
+	case RT_ST7735R_GET_SPI_HZ:
+	{
+		*((rt_uint32_t *)args) = lcd->spi_hz;
+		return RT_EOK;
+	}
+	case RT_ST7735R_SET_SPI_HZ:
+	{
+		if (*((rt_uint32_t *)args) == 0)
+		{
+			return -RT_EINVAL;
+		}
+#ifdef PKG_ST7735R_USING_ASYNC
+		// queued writes go out at the clock they were queued at
+		st7735r_async_wait(lcd, RT_WAITING_FOREVER);
+#endif
+		st7735r_spi_clock(lcd, *((rt_uint32_t *)args));
+		return RT_EOK;
+	}
+#if defined(PKG_ST7735R_USING_READBACK) && defined(PKG_ST7735R_USING_SPI_TUNE)
+	case RT_ST7735R_CALIBRATE_SPI:
+	{
+		return st7735r_calibrate_spi(lcd, (rt_uint32_t *)args);
+	}
+#endif
+#ifdef PKG_ST7735R_USING_TEXT
+	case RT_ST7735R_DRAW_TEXT:
+	{
+		return st7735r_draw_text(lcd, (const struct rt_st7735r_text *)args);
+	}
+	case RT_ST7735R_GET_TEXT_STATS:
+	{
+		if (lcd->glyphs == RT_NULL)
+		{
+			rt_memset(args, 0x0, sizeof(struct rt_st7735r_text_stats));
+			return RT_EOK;
+		}
+		*((struct rt_st7735r_text_stats *)args) = lcd->glyphs->stats;
+		return RT_EOK;
+	}
+	case RT_ST7735R_RESET_TEXT_STATS:
+	{
+		if (lcd->glyphs)
+		{
+			rt_memset(&lcd->glyphs->stats, 0x0, sizeof(lcd->glyphs->stats));
+		}
+		return RT_EOK;
+	}
+#endif
+#ifdef PKG_ST7735R_USING_VSYNC
+	case RT_ST7735R_SET_VSYNC:
+	{
+		lcd->vsync.enabled = *((rt_uint8_t *)args) != 0;
+		return RT_EOK;
+	}
+	case RT_ST7735R_WAIT_VSYNC:
+	{
+		return st7735r_vsync_wait(lcd);
+	}
+	case RT_ST7735R_SET_TE_PIN:
+	{
+		return st7735r_set_te_pin(lcd, *((rt_base_t *)args));
+	}
+#endif
+#ifdef PKG_ST7735R_USING_CAMERA
+	case RT_ST7735R_SHOW_CAMERA:
+	{
+		return st7735r_show_camera(lcd, (const struct rt_st7735r_camera *)args);
+	}
+#endif
+#ifdef PKG_ST7735R_USING_TILE_DIFF
+	case RT_ST7735R_SUBMIT_FRAME:
+	{
+		const struct rt_st7735r_frame *frame = (const struct rt_st7735r_frame *)args;
+		return st7735r_submit_frame(lcd, frame->format, frame->buffer);
+	}
+	case RT_ST7735R_INVALIDATE_TILES:
+	{
+		if (lcd->tiles)
+		{
+			lcd->tiles->valid = RT_FALSE;
+		}
+		return RT_EOK;
+	}
+	case RT_ST7735R_GET_TILE_STATS:
+	{
+		if (lcd->tiles == RT_NULL)
+		{
+			rt_memset(args, 0x0, sizeof(struct rt_st7735r_tile_stats));
+			return RT_EOK;
+		}
+		*((struct rt_st7735r_tile_stats *)args) = lcd->tiles->stats;
+		return RT_EOK;
+	}
+	case RT_ST7735R_RESET_TILE_STATS:
+	{
+		if (lcd->tiles)
+		{
+			rt_memset(&lcd->tiles->stats, 0x0, sizeof(lcd->tiles->stats));
+		}
+		return RT_EOK;
+	}
+#endif
+	case RT_ST7735R_SET_SCROLL_AREA:
+	{
+		const struct rt_st7735r_scroll_area *area = (const struct rt_st7735r_scroll_area *)args;
+		return st7735r_set_scroll_area(lcd, area->top, area->height);
+	}
+	case RT_ST7735R_SET_SCROLL:
+	{
+		st7735r_set_scroll(lcd, *((rt_uint16_t *)args));
+		return RT_EOK;
+	}
+	case RT_ST7735R_SET_SCROLL_LINE:
+	{
+		st7735r_set_scroll_line(lcd, *((rt_uint16_t *)args));
+		return RT_EOK;
+	}
 	case RT_ST7735R_SET_BL:
 	{
 		rt_uint8_t bl = *((rt_uint8_t *)args);
@@ -393,11 +3662,110 @@ static rt_err_t st7735r_control(rt_device_t dev, int cmd, void *args)
 			return -RT_ERROR;
 		}
 #ifdef PKG_ST7735R_ADJ_BL
-		dev->bl_value = bl;
+		lcd->bl_value = bl;
 #endif
 		st7735r_set_bl(lcd, bl != 0);
 		return RT_EOK;
 	}
+	case RT_ST7735R_SET_PANEL:
+	{
+		rt_uint8_t panel = *((rt_uint8_t *)args);
+		if (panel >= sizeof(st7735r_panels) / sizeof(st7735r_panels[0]))
+		{
+			LOG_E(LOG_TAG" %d is wrong panel variant", panel);
+			return -RT_ERROR;
+		}
+		lcd->panel_next = panel;
+		return RT_EOK;
+	}
+	case RT_ST7735R_REINIT:
+	{
+		st7735r_init_panel(lcd);
+		return RT_EOK;
+	}
+	case RT_ST7735R_SET_FPS:
+	{
+		st7735r_init_frmctr(lcd, *((rt_uint8_t *)args));
+		return RT_EOK;
+	}
+	case RT_ST7735R_SET_PALETTE:
+	{
+		lcd->cvt_ctx.palette = (const rt_uint16_t *)args;
+		return RT_EOK;
+	}
+	case RT_ST7735R_SET_BG_COLOR:
+	{
+		lcd->cvt_ctx.bg_color = *((rt_uint16_t *)args);
+		return RT_EOK;
+	}
+	case RT_ST7735R_SET_COLMOD:
+	{
+		rt_uint8_t colmod = *((rt_uint8_t *)args);
+		if (colmod != RT_ST7735R_COLMOD_12BIT && colmod != RT_ST7735R_COLMOD_16BIT && colmod != RT_ST7735R_COLMOD_18BIT)
+		{
+			LOG_E(LOG_TAG" 0x%02x is wrong interface pixel format", colmod);
+			return -RT_ERROR;
+		}
+		st7735r_init_colmod(lcd, colmod);
+		return RT_EOK;
+	}
+	case RT_ST7735R_GET_COLMOD:
+	{
+		*((rt_uint8_t *)args) = lcd->colmod;
+		return RT_EOK;
+	}
+#ifdef PKG_ST7735R_USING_TRACE
+	case RT_ST7735R_SET_TRACE:
+	{
+		lcd->trace = (rt_st7735r_trace_t)args;
+		return RT_EOK;
+	}
+#endif
+#ifdef PKG_ST7735R_USING_ASYNC
+	case RT_ST7735R_WAIT_FLUSH:
+	{
+		return st7735r_async_wait(lcd, args ? *((rt_int32_t *)args) : RT_WAITING_FOREVER);
+	}
+#endif
+#ifdef PKG_ST7735R_USING_STATS
+	case RT_ST7735R_GET_STATS:
+	{
+		struct rt_st7735r_stats *stats = (struct rt_st7735r_stats *)args;
+		*stats = lcd->stats;
+		stats->transfers = lcd->spi_transfers;
+		return RT_EOK;
+	}
+	case RT_ST7735R_RESET_STATS:
+	{
+		rt_memset(&lcd->stats, 0x0, sizeof(lcd->stats));
+		lcd->stats.since = rt_tick_get();
+		lcd->spi_transfers = 0;
+		return RT_EOK;
+	}
+#endif
+	case RT_ST7735R_GET_CAPS:
+	{
+		rt_uint32_t caps = 0;
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+		if (lcd->framebuffer)
+		{
+			caps |= RT_ST7735R_CAP_FRAMEBUFFER | RT_ST7735R_CAP_READ;
+		}
+#endif
+#ifdef PKG_ST7735R_USING_READBACK
+		if (lcd->ramrd)
+		{
+			caps |= RT_ST7735R_CAP_RAMRD | RT_ST7735R_CAP_READ;
+		}
+#endif
+		*((rt_uint32_t *)args) = caps;
+		return RT_EOK;
+	}
+	case RT_ST7735R_GET_TRANSFERS:
+	{
+		*((rt_uint32_t *)args) = lcd->spi_transfers;
+		return RT_EOK;
+	}
 	case RTGRAPHIC_CTRL_POWERON:
 	{
 		st7735r_clear(lcd, 0x0);
@@ -409,9 +3777,18 @@ static rt_err_t st7735r_control(rt_device_t dev, int cmd, void *args)
 		st7735r_set_bl(lcd, RT_FALSE);
 		return RT_EOK;
 	}
+	case RTGRAPHIC_CTRL_RECT_UPDATE:
+	{
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+		if (lcd->framebuffer)
+		{
+			st7735r_fb_update(lcd, (const struct rt_device_rect_info *)args);
+		}
+#endif
+		return RT_EOK;
+	}
 	case RTGRAPHIC_CTRL_SET_MODE:
     case RTGRAPHIC_CTRL_GET_EXT:
-	case RTGRAPHIC_CTRL_RECT_UPDATE:
 		return RT_EOK;
     case RTGRAPHIC_CTRL_GET_INFO:
     {
@@ -425,87 +3802,313 @@ static rt_err_t st7735r_control(rt_device_t dev, int cmd, void *args)
 	}
 }
 
-static void st7735r_set_pixel(const char *pixel, int x, int y)
+/* The device interface is serialised per panel, the bus lock is taken per transfer or burst below */
+static rt_size_t st7735r_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+	st7735r_lock((rt_st7735r_t)dev);
+	size = st7735r_do_read(dev, pos, buffer, size);
+	st7735r_unlock((rt_st7735r_t)dev);
+	return size;
+}
+
+static rt_size_t st7735r_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+	st7735r_lock((rt_st7735r_t)dev);
+	size = st7735r_do_write(dev, pos, buffer, size);
+	st7735r_unlock((rt_st7735r_t)dev);
+	return size;
+}
+
+static rt_err_t st7735r_control(rt_device_t dev, int cmd, void *args)
+{
+#ifdef PKG_ST7735R_USING_RENDER
+	// the render thread holds the lock while drawing, these must not wait for it
+	rt_st7735r_t lcd = (rt_st7735r_t)dev;
+	switch (cmd)
+	{
+	case RT_ST7735R_RENDER_POST:
+		return st7735r_render_post(lcd, (const struct rt_st7735r_render_cmd *)args, RT_WAITING_FOREVER);
+	case RT_ST7735R_RENDER_SYNC:
+		return st7735r_render_sync(lcd);
+	case RT_ST7735R_GET_RENDER_STATS:
+		if (lcd->render == RT_NULL)
+		{
+			return -RT_ERROR;
+		}
+		*((struct rt_st7735r_render_stats *)args) = lcd->render->stats;
+		return RT_EOK;
+	case RT_ST7735R_RESET_RENDER_STATS:
+		if (lcd->render == RT_NULL)
+		{
+			return -RT_ERROR;
+		}
+		rt_memset(&lcd->render->stats, 0x0, sizeof(lcd->render->stats));
+		return RT_EOK;
+	}
+#endif
+	st7735r_lock((rt_st7735r_t)dev);
+	rt_err_t result = st7735r_do_control(dev, cmd, args);
+	st7735r_unlock((rt_st7735r_t)dev);
+	return result;
+}
+
+static void st7735r_gfx_set_pixel(rt_st7735r_t dev, const char *pixel, int x, int y)
 {
-    st7735r_set_active_rect(graphics_lcd, x, y, 1, 1);
-	st7735r_send(graphics_lcd, RT_FALSE, ST7735R_RAMWR);
-	const rt_uint16_t *color = (const rt_uint16_t *)pixel;
-	st7735r_send(graphics_lcd, RT_TRUE, *(color) >> 8);
-	st7735r_send(graphics_lcd, RT_TRUE, *(color));
+	if (x < 0 || y < 0 || x >= dev->width || y >= dev->height)
+	{
+		return;
+	}
+	st7735r_lock(dev);
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+	if (dev->framebuffer)
+	{
+		st7735r_fb_fill(dev, x, y, 1, 1, *(const rt_uint16_t *)pixel);
+	}
+	else
+#endif
+	{
+		ST7735R_STAT_BEGIN();
+		st7735r_burst_begin(dev);
+		if (!st7735r_ramwr_continues(dev, x, y, 1))
+		{
+			// open the window to the bottom right corner so following pixels on the row append
+			st7735r_set_active_rect(dev, x, y, dev->width - x, dev->height - y);
+			st7735r_ramwr_begin(dev);
+		}
+		st7735r_ramwr_fill(dev, *(const rt_uint16_t *)pixel, 1);
+		st7735r_ramwr_flush(dev);
+		st7735r_burst_end(dev);
+		ST7735R_STAT_END(dev);
+	}
+	st7735r_unlock(dev);
 }
 
-static void st7735r_get_pixel(char *pixel, int x, int y)
+static void st7735r_gfx_get_pixel(rt_st7735r_t dev, char *pixel, int x, int y)
 {
-//TODO: finding a way to complete this function without adding a frame buffer
+#if !defined(PKG_ST7735R_USING_FRAMEBUFFER) && !defined(PKG_ST7735R_USING_READBACK)
+	(void)pixel;
+#endif
+	if (x < 0 || y < 0 || x >= dev->width || y >= dev->height)
+	{
+		return;
+	}
+	st7735r_lock(dev);
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+	if (dev->framebuffer)
+	{
+		st7735r_fb_sync(dev);
+		*(rt_uint16_t *)pixel = dev->framebuffer[y * dev->width + x];
+	}
+	else
+#endif
+	{
+#ifdef PKG_ST7735R_USING_READBACK
+		if (dev->ramrd)
+		{
+			st7735r_set_active_rect(dev, x, y, 1, 1);
+			st7735r_read_pixel(dev, (rt_uint16_t *)pixel, 1);
+		}
+#endif
+	}
+	st7735r_unlock(dev);
 }
 
-static void st7735r_draw_hline(const char *pixel, int x1, int x2, int y)
+static void st7735r_gfx_draw_hline(rt_st7735r_t dev, const char *pixel, int x1, int x2, int y)
 {
-	int width;
+	int x, width;
 	if (x2 > x1)
 	{
+		x = x1;
 		width = x2 - x1;
-		st7735r_set_active_rect(graphics_lcd, x1, y, width, 1);
 	}
 	else
 	{
+		x = x2;
 		width = x1 - x2;
-		st7735r_set_active_rect(graphics_lcd, x2, y, width, 1);
 	}
-	st7735r_send(graphics_lcd, RT_FALSE, ST7735R_RAMWR);
-	const rt_uint16_t *color = (const rt_uint16_t *)pixel;
-	for (rt_uint32_t i = 0; i < width; ++i)
+	if (y < 0 || y >= dev->height || !st7735r_gfx_clip(&x, &width, dev->width))
+	{
+		return;
+	}
+	st7735r_lock(dev);
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+	if (dev->framebuffer)
+	{
+		st7735r_fb_fill(dev, x, y, width, 1, *(const rt_uint16_t *)pixel);
+	}
+	else
+#endif
 	{
-		st7735r_send(graphics_lcd, RT_TRUE, *(color) >> 8);
-		st7735r_send(graphics_lcd, RT_TRUE, *(color));
+		ST7735R_STAT_BEGIN();
+		st7735r_burst_begin(dev);
+		if (!st7735r_ramwr_continues(dev, x, y, width))
+		{
+			// extend the window down so a stack of equal lines (filled rects) is one run
+			st7735r_set_active_rect(dev, x, y, width, dev->height - y);
+			st7735r_ramwr_begin(dev);
+		}
+		st7735r_ramwr_fill(dev, *(const rt_uint16_t *)pixel, width);
+		st7735r_ramwr_flush(dev);
+		st7735r_burst_end(dev);
+		ST7735R_STAT_END(dev);
 	}
+	st7735r_unlock(dev);
 }
 
-static void st7735r_draw_vline(const char *pixel, int x, int y1, int y2)
+static void st7735r_gfx_draw_vline(rt_st7735r_t dev, const char *pixel, int x, int y1, int y2)
 {
-	int height;
+	int y, height;
 	if (y2 > y1)
 	{
+		y = y1;
 		height = y2 - y1;
-		st7735r_set_active_rect(graphics_lcd, x, y1, 1, height);
 	}
 	else
 	{
+		y = y2;
 		height = y1 - y2;
-		st7735r_set_active_rect(graphics_lcd, x, y2, 1, height);
 	}
-	st7735r_send(graphics_lcd, RT_FALSE, ST7735R_RAMWR);
-	const rt_uint16_t *color = (const rt_uint16_t *)pixel;
-	for (rt_uint32_t i = 0; i < height; ++i)
+	if (x < 0 || x >= dev->width || !st7735r_gfx_clip(&y, &height, dev->height))
+	{
+		return;
+	}
+	st7735r_lock(dev);
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+	if (dev->framebuffer)
+	{
+		st7735r_fb_fill(dev, x, y, 1, height, *(const rt_uint16_t *)pixel);
+	}
+	else
+#endif
 	{
-		st7735r_send(graphics_lcd, RT_TRUE, *(color) >> 8);
-		st7735r_send(graphics_lcd, RT_TRUE, *(color));
+		ST7735R_STAT_BEGIN();
+		st7735r_burst_begin(dev);
+		st7735r_set_active_rect(dev, x, y, 1, height);
+		st7735r_ramwr_begin(dev);
+		st7735r_ramwr_fill(dev, *(const rt_uint16_t *)pixel, height);
+		st7735r_ramwr_flush(dev);
+		st7735r_burst_end(dev);
+		ST7735R_STAT_END(dev);
 	}
+	st7735r_unlock(dev);
 }
 
-static void st7735r_blit_line(const char *pixel, int x, int y, rt_size_t size)
+static void st7735r_gfx_blit_line(rt_st7735r_t dev, const char *pixel, int x, int y, rt_size_t size)
 {
-    const rt_uint16_t *ptr = (const rt_uint16_t *)pixel;
-	st7735r_set_active_rect(graphics_lcd, x, y, size, 1);
-	st7735r_send(graphics_lcd, RT_FALSE, ST7735R_RAMWR);
-	for (rt_uint32_t i = 0; i < size; ++i)
+	// pixels left of the panel are skipped in the source
+	const int skip = x < 0 ? -x : 0;
+	int width = size > (rt_size_t)dev->width + skip ? dev->width + skip : (int)size;
+	if (y < 0 || y >= dev->height || !st7735r_gfx_clip(&x, &width, dev->width))
 	{
-		st7735r_send(graphics_lcd, RT_TRUE, *(ptr) >> 8);
-		st7735r_send(graphics_lcd, RT_TRUE, *(ptr));
-		++ptr;
+		return;
+	}
+	pixel += skip * 2;
+	size = width;
+	st7735r_lock(dev);
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+	if (dev->framebuffer)
+	{
+		st7735r_fb_sync(dev);
+		rt_memcpy(dev->framebuffer + y * dev->width + x, pixel, size * 2);
+		st7735r_fb_mark(dev, x, y, size, 1);
+	}
+	else
+#endif
+	{
+		ST7735R_STAT_BEGIN();
+		st7735r_burst_begin(dev);
+		if (!st7735r_ramwr_continues(dev, x, y, size))
+		{
+			// extend the window down so consecutive rows of an image are one run
+			st7735r_set_active_rect(dev, x, y, size, dev->height - y);
+			st7735r_ramwr_begin(dev);
+		}
+		st7735r_ramwr_convert(dev, &st7735r_formats[RT_ST7735R_WRITE_COLOR_PIXEL], pixel, size, RT_FALSE);
+		st7735r_ramwr_flush(dev);
+		st7735r_burst_end(dev);
+		ST7735R_STAT_END(dev);
 	}
-    return;
+	st7735r_unlock(dev);
 }
 
-static struct rt_device_graphic_ops st7735r_graphic_ops =
+/*
+ * rt_device_graphic_ops callbacks carry no device, so each panel given
+ * graphic ops is bound to one of PKG_ST7735R_MAX_GRAPHIC_DEV slots with its
+ * own set of trampolines.
+ */
+static rt_st7735r_t st7735r_graphic_devs[PKG_ST7735R_MAX_GRAPHIC_DEV];
+
+#define ST7735R_GRAPHIC_OPS(n) \
+static void st7735r_set_pixel_##n(const char *pixel, int x, int y) \
+{ \
+	st7735r_gfx_set_pixel(st7735r_graphic_devs[n], pixel, x, y); \
+} \
+static void st7735r_get_pixel_##n(char *pixel, int x, int y) \
+{ \
+	st7735r_gfx_get_pixel(st7735r_graphic_devs[n], pixel, x, y); \
+} \
+static void st7735r_draw_hline_##n(const char *pixel, int x1, int x2, int y) \
+{ \
+	st7735r_gfx_draw_hline(st7735r_graphic_devs[n], pixel, x1, x2, y); \
+} \
+static void st7735r_draw_vline_##n(const char *pixel, int x, int y1, int y2) \
+{ \
+	st7735r_gfx_draw_vline(st7735r_graphic_devs[n], pixel, x, y1, y2); \
+} \
+static void st7735r_blit_line_##n(const char *pixel, int x, int y, rt_size_t size) \
+{ \
+	st7735r_gfx_blit_line(st7735r_graphic_devs[n], pixel, x, y, size); \
+}
+
+#define ST7735R_GRAPHIC_OPS_ENTRY(n) \
+{ \
+	st7735r_set_pixel_##n, \
+	st7735r_get_pixel_##n, \
+	st7735r_draw_hline_##n, \
+	st7735r_draw_vline_##n, \
+	st7735r_blit_line_##n \
+}
+
+ST7735R_GRAPHIC_OPS(0)
+#if PKG_ST7735R_MAX_GRAPHIC_DEV > 1
+ST7735R_GRAPHIC_OPS(1)
+#endif
+#if PKG_ST7735R_MAX_GRAPHIC_DEV > 2
+ST7735R_GRAPHIC_OPS(2)
+#endif
+#if PKG_ST7735R_MAX_GRAPHIC_DEV > 3
+ST7735R_GRAPHIC_OPS(3)
+#endif
+
+static struct rt_device_graphic_ops st7735r_graphic_ops[PKG_ST7735R_MAX_GRAPHIC_DEV] =
 {
-    st7735r_set_pixel,
-    st7735r_get_pixel,
-    st7735r_draw_hline,
-    st7735r_draw_vline,
-    st7735r_blit_line
+	ST7735R_GRAPHIC_OPS_ENTRY(0),
+#if PKG_ST7735R_MAX_GRAPHIC_DEV > 1
+	ST7735R_GRAPHIC_OPS_ENTRY(1),
+#endif
+#if PKG_ST7735R_MAX_GRAPHIC_DEV > 2
+	ST7735R_GRAPHIC_OPS_ENTRY(2),
+#endif
+#if PKG_ST7735R_MAX_GRAPHIC_DEV > 3
+	ST7735R_GRAPHIC_OPS_ENTRY(3),
+#endif
 };
 
+/* Give the panel the first free set of graphic ops */
+static void st7735r_bind_graphic_ops(rt_st7735r_t dev)
+{
+	for (rt_size_t i = 0; i < PKG_ST7735R_MAX_GRAPHIC_DEV; ++i)
+	{
+		if (st7735r_graphic_devs[i] == RT_NULL)
+		{
+			st7735r_graphic_devs[i] = dev;
+			dev->parent.user_data = &st7735r_graphic_ops[i];
+			return;
+		}
+	}
+	LOG_W(LOG_TAG" no graphic ops left for %s", dev->parent.parent.name);
+}
+
 #ifdef RT_USING_DEVICE_OPS
 static struct rt_device_ops st7735r_dev_ops =
 {
@@ -515,6 +4118,7 @@ static struct rt_device_ops st7735r_dev_ops =
     .read = st7735r_read,
     .write = st7735r_write,
     .control = st7735r_control,
+};
 #endif
 
 #ifdef PKG_ST7735R_ADJ_BL
@@ -550,17 +4154,35 @@ static struct rt_device_ops st7735r_dev_ops =
 		dev_obj->lcd_info.bits_per_pixel = 16;
 		dev_obj->lcd_info.pixel_format = RTGRAPHIC_PIXEL_FORMAT_RGB565;
 		dev_obj->lcd_info.framebuffer = RT_NULL;
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+#ifdef PKG_ST7735R_FRAMEBUFFER_STATIC
+		if (!st7735r_static_fb_used && width * height <= PKG_ST7735R_WIDTH * PKG_ST7735R_HEIGHT)
+		{
+			st7735r_static_fb_used = RT_TRUE;
+			dev_obj->framebuffer = st7735r_static_fb;
+		}
+#else
+		dev_obj->framebuffer = rt_malloc(width * height * sizeof(rt_uint16_t));
+#endif
+		if (dev_obj->framebuffer)
+		{
+			rt_memset(dev_obj->framebuffer, 0x0, width * height * sizeof(rt_uint16_t));
+			dev_obj->lcd_info.framebuffer = (rt_uint8_t *)dev_obj->framebuffer;
+		}
+		else
+		{
+			LOG_W(LOG_TAG" no framebuffer for %dx%d panel", width, height);
+		}
+		dev_obj->dirty.x0 = 1;
+		dev_obj->dirty.x1 = 0;
+#endif
 		dev_obj->spi = (struct rt_spi_device *)rt_device_find(dev_name);
-		struct rt_spi_configuration spi_config;
-        spi_config.data_width = 8;
-        spi_config.mode = RT_SPI_MASTER | RT_SPI_MODE_0 | RT_SPI_MSB;
-        /* Max freq of ST7735R is 24MHz */
-        spi_config.max_hz = 24000000;
-        rt_spi_configure(dev_obj->spi, &spi_config);
+		rt_mutex_init(&dev_obj->lock, dev_name, RT_IPC_FLAG_FIFO);
+		st7735r_spi_clock(dev_obj, PKG_ST7735R_SPI_MAX_HZ);
 #ifdef PKG_ST7735R_ADJ_BL
 		dev_obj->bl_pwm = (struct rt_device_pwm *)rt_device_find(bl_pwm_name);
 		dev_obj->bl_channel = bl_pwm_channel;
-		dev_obj->bl_value = PKG_ST7735R_BL_DEFAULT_INTENSITY
+		dev_obj->bl_value = PKG_ST7735R_BL_DEFAULT_INTENSITY;
 #else
 		dev_obj->bl_pin = bl_pin;
 #endif
@@ -569,6 +4191,17 @@ static struct rt_device_ops st7735r_dev_ops =
 		dev_obj->width = width;
 		dev_obj->height = height;
 		dev_obj->ori = ori;
+		dev_obj->panel = ST7735R_DEFAULT_PANEL;
+		dev_obj->panel_next = ST7735R_DEFAULT_PANEL;
+		dev_obj->fps = ST7735R_DEFAULT_FPS;
+		dev_obj->colmod = ST7735R_DEFAULT_COLMOD;
+#ifdef PKG_ST7735R_USING_STATS
+		dev_obj->stats.since = rt_tick_get();
+#endif
+#ifdef PKG_ST7735R_USING_VSYNC
+		dev_obj->vsync.te_pin = -1;
+		rt_event_init(&dev_obj->vsync.event, dev_name, RT_IPC_FLAG_FIFO);
+#endif
 #ifdef RT_USING_DEVICE_OPS
 		dev_obj->parent.ops = &st7735r_dev_ops;
 #else
@@ -586,11 +4219,13 @@ static struct rt_device_ops st7735r_dev_ops =
 			rt_sprintf(dev_name, "lcd%d", dev_num++);
 			if (dev_num == 255)
 			{
+				rt_mutex_detach(&dev_obj->lock);
 				rt_device_destroy(&(dev_obj->parent));
 				return RT_NULL;
 			}
 		} while (rt_device_find(dev_name));
 		rt_device_register(&(dev_obj->parent), dev_name, RT_DEVICE_FLAG_DEACTIVATE);
+		st7735r_bind_graphic_ops(dev_obj);
 		return (rt_st7735r_t)rt_device_find(dev_name);
 	}
 	else
@@ -602,19 +4237,65 @@ static struct rt_device_ops st7735r_dev_ops =
 #ifdef PKG_ST7735R_USING_KCONFIG
 static int st7735r_hw_init(void)
 {
+	rt_st7735r_t lcd;
 #ifdef PKG_ST7735R_ADJ_BL
-	graphics_lcd = st7735r_user_init(PKG_ST7735R_SPI_BUS, PKG_ST7735R_CS, PKG_ST7735R_RES, PKG_ST7735R_DC, PKG_ST7735R_BL_PWM, PKG_ST7735R_BL_PWM_CHANNEL, PKG_ST7735R_WIDTH, PKG_ST7735R_HEIGHT, PKG_ST7735R_ORI);
+	lcd = st7735r_user_init(PKG_ST7735R_SPI_BUS, PKG_ST7735R_CS, PKG_ST7735R_RES, PKG_ST7735R_DC, PKG_ST7735R_BL_PWM, PKG_ST7735R_BL_PWM_CHANNEL, PKG_ST7735R_WIDTH, PKG_ST7735R_HEIGHT, PKG_ST7735R_ORI);
 #else
-	graphics_lcd = st7735r_user_init(PKG_ST7735R_SPI_BUS, PKG_ST7735R_CS, PKG_ST7735R_RES, PKG_ST7735R_DC, PKG_ST7735R_BL, PKG_ST7735R_WIDTH, PKG_ST7735R_HEIGHT, PKG_ST7735R_ORI);
+	lcd = st7735r_user_init(PKG_ST7735R_SPI_BUS, PKG_ST7735R_CS, PKG_ST7735R_RES, PKG_ST7735R_DC, PKG_ST7735R_BL, PKG_ST7735R_WIDTH, PKG_ST7735R_HEIGHT, PKG_ST7735R_ORI);
 #endif
-	if (graphics_lcd == RT_NULL)
+	if (lcd == RT_NULL)
 	{
 		return -RT_ERROR;
 	}
-	graphics_lcd->parent.user_data = &st7735r_graphic_ops;
+#ifdef PKG_ST7735R_USING_TE
+	st7735r_set_te_pin(lcd, PKG_ST7735R_TE);
+#endif
     return RT_EOK;
 }
 INIT_DEVICE_EXPORT(st7735r_hw_init);
 #endif
 
+#if defined(PKG_ST7735R_USING_STATS) && defined(RT_USING_FINSH)
+/* Only devices registered by st7735r_user_init can be cast to rt_st7735r_t */
+static rt_bool_t st7735r_is_lcd(rt_device_t dev)
+{
+#ifdef RT_USING_DEVICE_OPS
+	return dev->ops == &st7735r_dev_ops;
+#else
+	return dev->control == st7735r_control;
+#endif
+}
+
+static void lcdstat(int argc, char **argv)
+{
+	const char *name = argc > 1 ? argv[1] : "lcd0";
+	rt_device_t dev = rt_device_find(name);
+	struct rt_st7735r_stats stats;
+	if (dev == RT_NULL || !st7735r_is_lcd(dev) || rt_device_control(dev, RT_ST7735R_GET_STATS, &stats) != RT_EOK)
+	{
+		rt_kprintf("%s is not a st7735r device\n", name);
+		return;
+	}
+	if (argc > 2 && rt_strcmp(argv[2], "reset") == 0)
+	{
+		rt_device_control(dev, RT_ST7735R_RESET_STATS, RT_NULL);
+		return;
+	}
+	const rt_st7735r_t lcd = (rt_st7735r_t)dev;
+	const rt_tick_t elapsed = rt_tick_get() - stats.since;
+	const rt_uint32_t frame = lcd->width * lcd->height;
+	// frames as full panels worth of pixels, in hundredths
+	const rt_uint32_t fps = elapsed && frame ? (rt_uint32_t)((rt_uint64_t)stats.pixels * 100 * RT_TICK_PER_SECOND / frame / elapsed) : 0;
+	rt_kprintf("ramwr bursts : %u\n", stats.ramwr);
+	rt_kprintf("pixels       : %u\n", stats.pixels);
+	rt_kprintf("bytes        : %u\n", stats.bytes);
+	rt_kprintf("transfers    : %u\n", stats.transfers);
+	rt_kprintf("windows      : %u\n", stats.windows);
+	rt_kprintf("errors       : %u\n", stats.errors);
+	rt_kprintf("busy         : %u ms, max %u ms\n", stats.busy_ticks * 1000 / RT_TICK_PER_SECOND, stats.busy_max * 1000 / RT_TICK_PER_SECOND);
+	rt_kprintf("fps          : %u.%02u over %u ms\n", fps / 100, fps % 100, elapsed * 1000 / RT_TICK_PER_SECOND);
+}
+MSH_CMD_EXPORT(lcdstat, show st7735r counters: lcdstat [device] [reset]);
+#endif
+
 #endif
\ No newline at end of file
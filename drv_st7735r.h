@@ -28,17 +28,308 @@
 #ifdef PKG_USING_ST7735R_TFT
 #include "drv_spi.h"
 #include "drv_gpio.h"
+#include "st7735r_convert.h"
 
 #define RT_ST7735R_SET_RECT     0x30
 #define RT_ST7735R_SET_BL       0x31
+#define RT_ST7735R_GET_TRANSFERS    0x32
+#define RT_ST7735R_SET_PANEL    0x33
+#define RT_ST7735R_REINIT       0x34
+#define RT_ST7735R_SET_FPS      0x35
+#define RT_ST7735R_WAIT_FLUSH   0x36
+#define RT_ST7735R_SET_PALETTE  0x37
+#define RT_ST7735R_SET_BG_COLOR 0x38
+#define RT_ST7735R_SET_COLMOD   0x39
+#define RT_ST7735R_GET_COLMOD   0x3A
+#define RT_ST7735R_SET_TRACE    0x3B
+#define RT_ST7735R_GET_STATS    0x3C
+#define RT_ST7735R_RESET_STATS  0x3D
+#define RT_ST7735R_FILL_RECT    0x3E
+#define RT_ST7735R_SET_SCROLL_AREA  0x3F
+#define RT_ST7735R_SET_SCROLL   0x40
+#define RT_ST7735R_SET_SCROLL_LINE  0x41
+#define RT_ST7735R_GET_CAPS     0x42
+#define RT_ST7735R_RENDER_POST  0x43
+#define RT_ST7735R_RENDER_SYNC  0x44
+#define RT_ST7735R_GET_RENDER_STATS     0x45
+#define RT_ST7735R_RESET_RENDER_STATS   0x46
+#define RT_ST7735R_DLIST_RENDER 0x47
+#define RT_ST7735R_SUBMIT_FRAME 0x48
+#define RT_ST7735R_INVALIDATE_TILES     0x49
+#define RT_ST7735R_GET_TILE_STATS       0x4A
+#define RT_ST7735R_RESET_TILE_STATS     0x4B
+#define RT_ST7735R_SHOW_CAMERA  0x4C
+#define RT_ST7735R_BLIT_RECT    0x4D
+#define RT_ST7735R_SET_ORI      0x4E
+#define RT_ST7735R_GET_SPI_HZ   0x4F
+#define RT_ST7735R_SET_SPI_HZ   0x50
+#define RT_ST7735R_CALIBRATE_SPI    0x51
+#define RT_ST7735R_DRAW_TEXT    0x52
+#define RT_ST7735R_GET_TEXT_STATS       0x53
+#define RT_ST7735R_RESET_TEXT_STATS     0x54
+#define RT_ST7735R_SET_VSYNC   0x55
+#define RT_ST7735R_WAIT_VSYNC  0x56
+#define RT_ST7735R_SET_TE_PIN  0x57
+
+#ifndef PKG_ST7735R_TX_BUF_SIZE
+#define PKG_ST7735R_TX_BUF_SIZE     1024
+#endif
+
+#ifdef PKG_ST7735R_USING_DLIST
+#ifndef PKG_ST7735R_DLIST_SIZE
+#define PKG_ST7735R_DLIST_SIZE      32
+#endif
+#ifndef PKG_ST7735R_DLIST_BAND_PIXELS
+#define PKG_ST7735R_DLIST_BAND_PIXELS   2048
+#endif
+#endif
+
+struct rt_st7735r_rect
+{
+    rt_uint8_t x;
+    rt_uint8_t y;
+    rt_uint8_t width;
+    rt_uint8_t height;
+};
+typedef struct rt_st7735r_rect *rt_st7735r_rect_t;
+
+struct rt_st7735r_fill
+{
+    struct rt_st7735r_rect rect;
+    rt_uint16_t color;
+};
+
+/* In lines, rows in portrait and columns in landscape */
+struct rt_st7735r_scroll_area
+{
+    rt_uint16_t top;
+    rt_uint16_t height;
+};
+
+#ifdef PKG_ST7735R_USING_STATS
+struct rt_st7735r_stats
+{
+    /* RAMWR bursts, one per write or coalesced graphic-op run */
+    rt_uint32_t ramwr;
+    rt_uint32_t pixels;
+    rt_uint32_t bytes;
+    rt_uint32_t transfers;
+    /* CASET/RASET actually sent */
+    rt_uint32_t windows;
+    /* failed SPI sends */
+    rt_uint32_t errors;
+    /* time callers were blocked in the write paths */
+    rt_tick_t busy_ticks;
+    rt_tick_t busy_max;
+    /* tick of the last reset */
+    rt_tick_t since;
+};
+#endif
+
+/* Blit transforms, the source is transposed first and then mirrored on the panel */
+#define RT_ST7735R_BLIT_MIRROR_X    0x01
+#define RT_ST7735R_BLIT_MIRROR_Y    0x02
+#define RT_ST7735R_BLIT_TRANSPOSE   0x04
+/* Clockwise */
+#define RT_ST7735R_BLIT_ROTATE_90   (RT_ST7735R_BLIT_TRANSPOSE | RT_ST7735R_BLIT_MIRROR_X)
+#define RT_ST7735R_BLIT_ROTATE_180  (RT_ST7735R_BLIT_MIRROR_X | RT_ST7735R_BLIT_MIRROR_Y)
+#define RT_ST7735R_BLIT_ROTATE_270  (RT_ST7735R_BLIT_TRANSPOSE | RT_ST7735R_BLIT_MIRROR_Y)
+
+/* Part of a larger image, e.g. one icon of a sprite sheet */
+struct rt_st7735r_blit
+{
+    /* one of the RT_ST7735R_WRITE_* formats of 8 bits or more */
+    rt_uint8_t format;
+    const void *buffer;
+    /* bytes from one source row to the next */
+    rt_size_t stride;
+    rt_uint16_t src_x, src_y, width, height;
+    /* destination, clipped to the panel */
+    rt_int16_t x, y;
+    /* RT_ST7735R_BLIT_* transform, 0 for none */
+    rt_uint8_t transform;
+};
+
+#ifdef PKG_ST7735R_USING_RENDER
+#define RT_ST7735R_RENDER_FILL      0x01
+#define RT_ST7735R_RENDER_RECT      0x02    /* one pixel wide outline */
+#define RT_ST7735R_RENDER_BLIT      0x03
+#define RT_ST7735R_RENDER_SCROLL    0x04
+#define RT_ST7735R_RENDER_BL        0x05
+
+struct rt_st7735r_render_cmd
+{
+    rt_uint8_t op;
+    /* blit: one of the RT_ST7735R_WRITE_* formats */
+    rt_uint8_t format;
+    /* color for fill and rect, offset for scroll, 0 - 100 for backlight */
+    rt_uint16_t value;
+    struct rt_st7735r_rect rect;
+    /* blit: borrowed until release is called with it and arg */
+    const void *buffer;
+    void (*release)(const void *buffer, void *arg);
+    void *arg;
+};
+
+struct rt_st7735r_render_stats
+{
+    rt_uint32_t posted;
+    /* commands taken off the ring, merged and dropped ones included */
+    rt_uint32_t executed;
+    rt_uint32_t merged;
+    rt_uint32_t batches;
+    /* posts that found the ring full */
+    rt_uint32_t full;
+    rt_uint32_t depth_max;
+    /* ticks from post to the start of the batch drawing it */
+    rt_tick_t latency_max;
+    rt_tick_t latency_sum;
+};
+#endif
+
+#ifdef PKG_ST7735R_USING_DLIST
+#define RT_ST7735R_DLIST_FILL       0x01
+#define RT_ST7735R_DLIST_BLIT       0x02
+#define RT_ST7735R_DLIST_GLYPH      0x03    /* 1 bit mask, rows padded to whole bytes */
+
+struct rt_st7735r_dlist_prim
+{
+    rt_uint8_t op;
+    /* blit: one of the RT_ST7735R_WRITE_* formats */
+    rt_uint8_t format;
+    /* fill and glyph color */
+    rt_uint16_t color;
+    struct rt_st7735r_rect rect;
+    const void *pixels;
+    /* RLE blits are decoded once per frame, bands are drawn top to bottom */
+    struct st7735r_rle rle;
+    rt_uint32_t pos;
+};
+
+/*
+ * A frame recorded as a list of primitives, drawn in order. Rendering
+ * rasterises it one band of rows at a time into `band`, so every pixel
+ * is sent once without a framebuffer.
+ */
+struct rt_st7735r_dlist
+{
+    rt_uint16_t bg_color;
+    rt_uint16_t count;
+    struct rt_st7735r_dlist_prim prim[PKG_ST7735R_DLIST_SIZE];
+    rt_uint16_t band[PKG_ST7735R_DLIST_BAND_PIXELS];
+};
+#endif
+
+#ifdef PKG_ST7735R_USING_TILE_DIFF
+/* A whole frame, width * height pixels in a write format of 8 bits or more */
+struct rt_st7735r_frame
+{
+    rt_uint8_t format;
+    const void *buffer;
+};
+
+struct rt_st7735r_tile_stats
+{
+    rt_uint32_t frames;
+    rt_uint32_t tiles;
+    /* unchanged tiles that were not sent */
+    rt_uint32_t skipped;
+    rt_uint32_t windows;
+    /* the same for the last frame */
+    rt_uint16_t last_tiles;
+    rt_uint16_t last_skipped;
+};
+#endif
+
+#ifdef PKG_ST7735R_USING_CAMERA
+#define RT_ST7735R_SCALE_NEAREST    0x00
+#define RT_ST7735R_SCALE_BILINEAR   0x01
+
+#define RT_ST7735R_CAMERA_GRAY      0x00
+#define RT_ST7735R_CAMERA_BINARY    0x01    /* fg_color at or above the threshold, bg_color below */
+#define RT_ST7735R_CAMERA_OVERLAY   0x02    /* fg_color at or above the threshold, grayscale below */
+
+struct rt_st7735r_camera
+{
+    /* 8-bit grayscale frame, `stride` bytes per row */
+    const rt_uint8_t *frame;
+    rt_uint16_t width, height, stride;
+    /* part of the frame scaled onto the active rect, a crop_width of 0 takes the whole frame */
+    rt_uint16_t crop_x, crop_y, crop_width, crop_height;
+    rt_uint8_t scale;
+    rt_uint8_t mode;
+    rt_uint8_t threshold;
+    rt_uint16_t fg_color, bg_color;
+};
+#endif
+
+#ifdef PKG_ST7735R_USING_TEXT
+#define RT_ST7735R_FONT_1BIT        1
+#define RT_ST7735R_FONT_4BIT        4       /* coverage from 0 (bg_color) to 15 (fg_color) */
+
+/*
+ * A bitmap font, usually in flash. Every character from `first` to
+ * first + count - 1 has a width x height cell of `bpp` bits per pixel,
+ * MSB first, with rows padded to whole bytes.
+ */
+struct rt_st7735r_font
+{
+    rt_uint8_t bpp;
+    rt_uint8_t width, height;
+    rt_uint8_t first;
+    rt_uint16_t count;
+    /* advance of every character for a proportional font, its left part of the cell is drawn. RT_NULL when monospace */
+    const rt_uint8_t *widths;
+    const rt_uint8_t *bitmap;
+};
+
+/* A string drawn opaque with its top left corner at (x, y), clipped to the panel. '\n' starts a line below x */
+struct rt_st7735r_text
+{
+    /* RT_NULL for the built-in st7735r_font_5x7 */
+    const struct rt_st7735r_font *font;
+    const char *str;
+    rt_int16_t x, y;
+    rt_uint16_t fg_color, bg_color;
+};
+
+struct rt_st7735r_text_stats
+{
+    rt_uint32_t glyphs;
+    /* glyphs found already rendered in the cache */
+    rt_uint32_t hits;
+    rt_uint32_t misses;
+    /* windows opened, one per run of glyphs on a line */
+    rt_uint32_t runs;
+};
+
+extern const struct rt_st7735r_font st7735r_font_5x7;
+#endif
+
+struct st7735r_async;
+struct st7735r_render;
+struct st7735r_tiles;
+struct st7735r_glyphs;
+struct rt_st7735r;
+
+#ifdef PKG_ST7735R_USING_TRACE
+/* Called before every SPI transfer, `data` is the level of the dc pin */
+typedef void (*rt_st7735r_trace_t)(struct rt_st7735r *dev, rt_bool_t data, const void *buf, rt_size_t len);
+#endif
 
 struct rt_st7735r
 {
     struct rt_device parent;
     struct rt_device_graphic_info lcd_info;
     struct rt_spi_device *spi;
+    /* write clock, from menuconfig or calibration */
+    rt_uint32_t spi_hz;
     rt_base_t res_pin;
     rt_base_t dc_pin;
+    /* level the next transfer drives dc to */
+    rt_uint8_t dc_level;
+    /* serialises the device interface and graphic ops */
+    struct rt_mutex lock;
 #ifdef PKG_ST7735R_ADJ_BL
     struct rt_device_pwm *bl_pwm;
     rt_uint8_t bl_channel;
@@ -49,24 +340,154 @@ struct rt_st7735r
     rt_uint8_t width;
     rt_uint8_t height;
     rt_uint8_t ori;
+    rt_uint8_t panel;
+    /* variant chosen by RT_ST7735R_SET_PANEL, taken over by the next init */
+    rt_uint8_t panel_next;
+    rt_uint8_t fps;
+    rt_uint8_t colmod;
+    struct rt_st7735r_rect rect;
+    /* hardware scroll area, off while height is 0 */
+    struct
+    {
+        rt_uint16_t top, height, offset;
+    } scroll;
+    /* window last sent to the controller, in GRAM coordinates */
+    struct
+    {
+        rt_uint16_t x0, x1, y0, y1;
+    } win;
+    /* a RAMWR run is open and ramwr_pos pixels of the rect were written */
+    rt_bool_t ramwr_open;
+    rt_uint32_t ramwr_pos;
+    /* palette and background used by the write formats that need them */
+    struct st7735r_cvt_ctx cvt_ctx;
+    struct st7735r_pack pack;
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+    rt_uint16_t *framebuffer;
+    /* inclusive bounding box, empty while x0 > x1 */
+    struct
+    {
+        rt_uint16_t x0, y0, x1, y1;
+    } dirty;
+#endif
+#ifdef PKG_ST7735R_USING_READBACK
+    /* RDDID answered at init, RAMRD can be used */
+    rt_bool_t ramrd;
+#endif
+    rt_uint32_t spi_transfers;
+#ifdef PKG_ST7735R_USING_STATS
+    struct rt_st7735r_stats stats;
+#endif
+#ifdef PKG_ST7735R_USING_TRACE
+    rt_st7735r_trace_t trace;
+#endif
+#ifdef PKG_ST7735R_USING_ASYNC
+    struct st7735r_async *async;
+#endif
+#ifdef PKG_ST7735R_USING_RENDER
+    struct st7735r_render *render;
+#endif
+#ifdef PKG_ST7735R_USING_TILE_DIFF
+    struct st7735r_tiles *tiles;
+#endif
+#ifdef PKG_ST7735R_USING_TEXT
+    struct st7735r_glyphs *glyphs;
+#endif
+#ifdef PKG_ST7735R_USING_VSYNC
+    /* frame pacing, see st7735r_vsync_wait */
+    struct
+    {
+        rt_bool_t enabled;
+        /* TE input, or -1 to model the scan from the frame timing */
+        rt_base_t te_pin;
+        struct rt_event event;
+        /* tick of a blanking start, the last TE edge or the FRMCTR1 write */
+        rt_tick_t tick;
+        /* scan line time and lines per frame and in the blanking, from FRMCTR1 */
+        rt_uint32_t line_ns;
+        rt_uint16_t lines, porch;
+        /* time per byte of the last paced write, 0 before one */
+        rt_uint32_t byte_ns;
+    } vsync;
+#endif
+    rt_size_t tx_len;
+    rt_uint8_t tx_buf[PKG_ST7735R_TX_BUF_SIZE];
 };
 typedef struct rt_st7735r *rt_st7735r_t;
 
-struct rt_st7735r_rect
-{
-    rt_uint8_t x;
-    rt_uint8_t y;
-    rt_uint8_t width;
-    rt_uint8_t height;
-};
-typedef struct rt_st7735r_rect *rt_st7735r_rect_t;
+#define RT_ST7735R_PANEL_BLACKTAB   0x00
+#define RT_ST7735R_PANEL_REDTAB     0x01
+#define RT_ST7735R_PANEL_GREENTAB   0x02
+
+/* Interface pixel formats, pixels are still passed in as rgb565 */
+#define RT_ST7735R_COLMOD_12BIT     0x03
+#define RT_ST7735R_COLMOD_16BIT     0x05
+#define RT_ST7735R_COLMOD_18BIT     0x06
 
 #define RT_ST7735R_WRITE_COLOR_PIXEL        0x01
 #define RT_ST7735R_WRITE_GRAYSCALE_PIXEL    0x02
+#define RT_ST7735R_WRITE_RGB888_PIXEL       0x03
+#define RT_ST7735R_WRITE_ARGB8888_PIXEL     0x04
+#define RT_ST7735R_WRITE_RGB332_PIXEL       0x05
+#define RT_ST7735R_WRITE_INDEX1_PIXEL       0x06
+#define RT_ST7735R_WRITE_INDEX2_PIXEL       0x07
+#define RT_ST7735R_WRITE_INDEX4_PIXEL       0x08
+#define RT_ST7735R_WRITE_INDEX8_PIXEL       0x09
+/* RLE rgb565 stream in the st7735r_convert.h packet format, size is in pixels */
+#define RT_ST7735R_WRITE_RLE565_PIXEL       0x0A
+/* Big-endian rgb565 (LVGL's LV_COLOR_16_SWAP), sent without conversion by a 16-bit interface */
+#define RT_ST7735R_WRITE_COLOR_SWAP_PIXEL   0x0B
+
+#define RT_ST7735R_READ_COLOR_PIXEL         0x01
+
+/* RT_ST7735R_GET_CAPS flags */
+#define RT_ST7735R_CAP_READ                 (1 << 0)    /* rt_device_read and get_pixel work */
+#define RT_ST7735R_CAP_FRAMEBUFFER          (1 << 1)
+#define RT_ST7735R_CAP_RAMRD                (1 << 2)
 
 void st7735r_set_active_rect(rt_st7735r_t dev, rt_uint8_t x, rt_uint8_t y, rt_uint8_t width, rt_uint8_t height);
 void st7735r_clear(rt_st7735r_t dev, rt_uint16_t color);
 void st7735r_fill_color(rt_st7735r_t dev, rt_uint16_t color);
+rt_err_t st7735r_set_scroll_area(rt_st7735r_t dev, rt_uint16_t top, rt_uint16_t height);
+void st7735r_set_scroll(rt_st7735r_t dev, rt_uint16_t offset);
+rt_uint16_t st7735r_scroll_map(rt_st7735r_t dev, rt_uint16_t line);
+void st7735r_set_scroll_line(rt_st7735r_t dev, rt_uint16_t line);
+rt_err_t st7735r_fill_rect(rt_st7735r_t dev, rt_uint8_t x, rt_uint8_t y, rt_uint8_t width, rt_uint8_t height, rt_uint16_t color);
+rt_err_t st7735r_blit_rect(rt_st7735r_t dev, const struct rt_st7735r_blit *blit);
+rt_err_t st7735r_set_ori(rt_st7735r_t dev, rt_uint8_t ori);
+#ifdef PKG_ST7735R_USING_READBACK
+rt_err_t st7735r_read_pixel(rt_st7735r_t dev, rt_uint16_t *pixel, rt_size_t count);
+#ifdef PKG_ST7735R_USING_SPI_TUNE
+rt_err_t st7735r_calibrate_spi(rt_st7735r_t dev, rt_uint32_t *hz);
+#endif
+#endif
+#ifdef PKG_ST7735R_USING_RENDER
+rt_err_t st7735r_render_post(rt_st7735r_t dev, const struct rt_st7735r_render_cmd *cmd, rt_int32_t timeout);
+rt_err_t st7735r_render_sync(rt_st7735r_t dev);
+#endif
+#ifdef PKG_ST7735R_USING_DLIST
+void st7735r_dlist_init(struct rt_st7735r_dlist *dl, rt_uint16_t bg_color);
+rt_err_t st7735r_dlist_fill(struct rt_st7735r_dlist *dl, rt_uint8_t x, rt_uint8_t y, rt_uint8_t width, rt_uint8_t height, rt_uint16_t color);
+rt_err_t st7735r_dlist_hline(struct rt_st7735r_dlist *dl, rt_uint8_t x, rt_uint8_t y, rt_uint8_t length, rt_uint16_t color);
+rt_err_t st7735r_dlist_vline(struct rt_st7735r_dlist *dl, rt_uint8_t x, rt_uint8_t y, rt_uint8_t length, rt_uint16_t color);
+rt_err_t st7735r_dlist_blit(struct rt_st7735r_dlist *dl, rt_uint8_t x, rt_uint8_t y, rt_uint8_t width, rt_uint8_t height, rt_uint8_t format, const void *pixels);
+rt_err_t st7735r_dlist_glyph(struct rt_st7735r_dlist *dl, rt_uint8_t x, rt_uint8_t y, rt_uint8_t width, rt_uint8_t height, const rt_uint8_t *bitmap, rt_uint16_t color);
+rt_err_t st7735r_dlist_render(rt_st7735r_t dev, struct rt_st7735r_dlist *dl, const struct rt_st7735r_rect *area);
+#endif
+#ifdef PKG_ST7735R_USING_CAMERA
+rt_err_t st7735r_show_camera(rt_st7735r_t dev, const struct rt_st7735r_camera *cam);
+#endif
+#ifdef PKG_ST7735R_USING_TEXT
+rt_err_t st7735r_draw_text(rt_st7735r_t dev, const struct rt_st7735r_text *text);
+#endif
+#ifdef PKG_ST7735R_USING_VSYNC
+rt_err_t st7735r_set_te_pin(rt_st7735r_t dev, rt_base_t te_pin);
+rt_err_t st7735r_vsync_wait(rt_st7735r_t dev);
+#endif
+#ifdef PKG_ST7735R_USING_TILE_DIFF
+rt_err_t st7735r_submit_frame(rt_st7735r_t dev, rt_uint8_t format, const void *frame);
+#endif
+rt_err_t st7735r_show_pixel(rt_st7735r_t dev, rt_uint8_t format, const void *pixel, rt_size_t length);
 void st7735r_show_grayscale_pixel(rt_st7735r_t dev, const rt_uint8_t* pixel, rt_size_t length);
 void st7735r_show_color_pixel(rt_st7735r_t dev, const rt_uint16_t* pixel, rt_size_t length);
 #ifdef PKG_ST7735R_ADJ_BL
@@ -0,0 +1,552 @@
+/*
+ * Copyright (c) 2021 Lee Chun Hei, Leslie
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <rtthread.h>
+
+#ifdef PKG_USING_ST7735R_TFT
+#include "st7735r_convert.h"
+
+/*
+ * The word-at-a-time and SIMD paths assume a little-endian CPU, anything
+ * else falls back to the scalar reference code.
+ */
+#if defined(__BYTE_ORDER__) && defined(__ORDER_LITTLE_ENDIAN__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+	#define ST7735R_CVT_LE
+	#if defined(__SSE2__)
+		#include <emmintrin.h>
+		#define ST7735R_CVT_SSE2
+	#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+		#include <arm_neon.h>
+		#define ST7735R_CVT_NEON
+	#endif
+#endif
+
+#define ST7735R_CVT_ALIGNED(a, b) ((((rt_ubase_t)(a) | (rt_ubase_t)(b)) & 0x3) == 0)
+
+/* Pack 8-bit channels into big-endian rgb565 */
+#define ST7735R_CVT_PUT888(dst, r, g, b) \
+	do \
+	{ \
+		*(dst)++ = ((r) & 0xF8) | ((g) >> 5); \
+		*(dst)++ = (((g) << 3) & 0xE0) | ((b) >> 3); \
+	} while (0)
+
+/* x / 255 for x < 65536 with one rounding bias added by the caller */
+#define ST7735R_CVT_DIV255(x) (((x) + ((x) >> 8)) >> 8)
+
+static const rt_uint8_t st7735r_rgb332_lut[256 * 2] =
+{
+	0x00, 0x00, 0x00, 0x0A, 0x00, 0x15, 0x00, 0x1F, 0x01, 0x20, 0x01, 0x2A, 0x01, 0x35, 0x01, 0x3F,
+	0x02, 0x40, 0x02, 0x4A, 0x02, 0x55, 0x02, 0x5F, 0x03, 0x60, 0x03, 0x6A, 0x03, 0x75, 0x03, 0x7F,
+	0x04, 0x80, 0x04, 0x8A, 0x04, 0x95, 0x04, 0x9F, 0x05, 0xA0, 0x05, 0xAA, 0x05, 0xB5, 0x05, 0xBF,
+	0x06, 0xC0, 0x06, 0xCA, 0x06, 0xD5, 0x06, 0xDF, 0x07, 0xE0, 0x07, 0xEA, 0x07, 0xF5, 0x07, 0xFF,
+	0x20, 0x00, 0x20, 0x0A, 0x20, 0x15, 0x20, 0x1F, 0x21, 0x20, 0x21, 0x2A, 0x21, 0x35, 0x21, 0x3F,
+	0x22, 0x40, 0x22, 0x4A, 0x22, 0x55, 0x22, 0x5F, 0x23, 0x60, 0x23, 0x6A, 0x23, 0x75, 0x23, 0x7F,
+	0x24, 0x80, 0x24, 0x8A, 0x24, 0x95, 0x24, 0x9F, 0x25, 0xA0, 0x25, 0xAA, 0x25, 0xB5, 0x25, 0xBF,
+	0x26, 0xC0, 0x26, 0xCA, 0x26, 0xD5, 0x26, 0xDF, 0x27, 0xE0, 0x27, 0xEA, 0x27, 0xF5, 0x27, 0xFF,
+	0x48, 0x00, 0x48, 0x0A, 0x48, 0x15, 0x48, 0x1F, 0x49, 0x20, 0x49, 0x2A, 0x49, 0x35, 0x49, 0x3F,
+	0x4A, 0x40, 0x4A, 0x4A, 0x4A, 0x55, 0x4A, 0x5F, 0x4B, 0x60, 0x4B, 0x6A, 0x4B, 0x75, 0x4B, 0x7F,
+	0x4C, 0x80, 0x4C, 0x8A, 0x4C, 0x95, 0x4C, 0x9F, 0x4D, 0xA0, 0x4D, 0xAA, 0x4D, 0xB5, 0x4D, 0xBF,
+	0x4E, 0xC0, 0x4E, 0xCA, 0x4E, 0xD5, 0x4E, 0xDF, 0x4F, 0xE0, 0x4F, 0xEA, 0x4F, 0xF5, 0x4F, 0xFF,
+	0x68, 0x00, 0x68, 0x0A, 0x68, 0x15, 0x68, 0x1F, 0x69, 0x20, 0x69, 0x2A, 0x69, 0x35, 0x69, 0x3F,
+	0x6A, 0x40, 0x6A, 0x4A, 0x6A, 0x55, 0x6A, 0x5F, 0x6B, 0x60, 0x6B, 0x6A, 0x6B, 0x75, 0x6B, 0x7F,
+	0x6C, 0x80, 0x6C, 0x8A, 0x6C, 0x95, 0x6C, 0x9F, 0x6D, 0xA0, 0x6D, 0xAA, 0x6D, 0xB5, 0x6D, 0xBF,
+	0x6E, 0xC0, 0x6E, 0xCA, 0x6E, 0xD5, 0x6E, 0xDF, 0x6F, 0xE0, 0x6F, 0xEA, 0x6F, 0xF5, 0x6F, 0xFF,
+	0x90, 0x00, 0x90, 0x0A, 0x90, 0x15, 0x90, 0x1F, 0x91, 0x20, 0x91, 0x2A, 0x91, 0x35, 0x91, 0x3F,
+	0x92, 0x40, 0x92, 0x4A, 0x92, 0x55, 0x92, 0x5F, 0x93, 0x60, 0x93, 0x6A, 0x93, 0x75, 0x93, 0x7F,
+	0x94, 0x80, 0x94, 0x8A, 0x94, 0x95, 0x94, 0x9F, 0x95, 0xA0, 0x95, 0xAA, 0x95, 0xB5, 0x95, 0xBF,
+	0x96, 0xC0, 0x96, 0xCA, 0x96, 0xD5, 0x96, 0xDF, 0x97, 0xE0, 0x97, 0xEA, 0x97, 0xF5, 0x97, 0xFF,
+	0xB0, 0x00, 0xB0, 0x0A, 0xB0, 0x15, 0xB0, 0x1F, 0xB1, 0x20, 0xB1, 0x2A, 0xB1, 0x35, 0xB1, 0x3F,
+	0xB2, 0x40, 0xB2, 0x4A, 0xB2, 0x55, 0xB2, 0x5F, 0xB3, 0x60, 0xB3, 0x6A, 0xB3, 0x75, 0xB3, 0x7F,
+	0xB4, 0x80, 0xB4, 0x8A, 0xB4, 0x95, 0xB4, 0x9F, 0xB5, 0xA0, 0xB5, 0xAA, 0xB5, 0xB5, 0xB5, 0xBF,
+	0xB6, 0xC0, 0xB6, 0xCA, 0xB6, 0xD5, 0xB6, 0xDF, 0xB7, 0xE0, 0xB7, 0xEA, 0xB7, 0xF5, 0xB7, 0xFF,
+	0xD8, 0x00, 0xD8, 0x0A, 0xD8, 0x15, 0xD8, 0x1F, 0xD9, 0x20, 0xD9, 0x2A, 0xD9, 0x35, 0xD9, 0x3F,
+	0xDA, 0x40, 0xDA, 0x4A, 0xDA, 0x55, 0xDA, 0x5F, 0xDB, 0x60, 0xDB, 0x6A, 0xDB, 0x75, 0xDB, 0x7F,
+	0xDC, 0x80, 0xDC, 0x8A, 0xDC, 0x95, 0xDC, 0x9F, 0xDD, 0xA0, 0xDD, 0xAA, 0xDD, 0xB5, 0xDD, 0xBF,
+	0xDE, 0xC0, 0xDE, 0xCA, 0xDE, 0xD5, 0xDE, 0xDF, 0xDF, 0xE0, 0xDF, 0xEA, 0xDF, 0xF5, 0xDF, 0xFF,
+	0xF8, 0x00, 0xF8, 0x0A, 0xF8, 0x15, 0xF8, 0x1F, 0xF9, 0x20, 0xF9, 0x2A, 0xF9, 0x35, 0xF9, 0x3F,
+	0xFA, 0x40, 0xFA, 0x4A, 0xFA, 0x55, 0xFA, 0x5F, 0xFB, 0x60, 0xFB, 0x6A, 0xFB, 0x75, 0xFB, 0x7F,
+	0xFC, 0x80, 0xFC, 0x8A, 0xFC, 0x95, 0xFC, 0x9F, 0xFD, 0xA0, 0xFD, 0xAA, 0xFD, 0xB5, 0xFD, 0xBF,
+	0xFE, 0xC0, 0xFE, 0xCA, 0xFE, 0xD5, 0xFE, 0xDF, 0xFF, 0xE0, 0xFF, 0xEA, 0xFF, 0xF5, 0xFF, 0xFF,
+};
+
+void st7735r_cvt_rgb565_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	const rt_uint16_t *pixel = (const rt_uint16_t *)src;
+	(void)ctx;
+	for (rt_size_t i = 0; i < count; ++i)
+	{
+		*dst++ = pixel[i] >> 8;
+		*dst++ = pixel[i];
+	}
+}
+
+void st7735r_cvt_rgb565(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	rt_size_t i = 0;
+#ifdef ST7735R_CVT_LE
+	const rt_uint8_t *in = (const rt_uint8_t *)src;
+#if defined(ST7735R_CVT_SSE2)
+	for (; i + 8 <= count; i += 8)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i *)(in + i * 2));
+		_mm_storeu_si128((__m128i *)(dst + i * 2), _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8)));
+	}
+#elif defined(ST7735R_CVT_NEON)
+	for (; i + 8 <= count; i += 8)
+	{
+		vst1q_u8(dst + i * 2, vrev16q_u8(vld1q_u8(in + i * 2)));
+	}
+#endif
+	if (ST7735R_CVT_ALIGNED(in + i * 2, dst + i * 2))
+	{
+		// two pixels per word, swap the bytes of each half (a single REV16 on Cortex-M)
+		for (; i + 2 <= count; i += 2)
+		{
+			const rt_uint32_t w = *(const rt_uint32_t *)(in + i * 2);
+			*(rt_uint32_t *)(dst + i * 2) = ((w & 0x00FF00FF) << 8) | ((w >> 8) & 0x00FF00FF);
+		}
+	}
+#endif
+	st7735r_cvt_rgb565_ref(dst + i * 2, (const rt_uint16_t *)src + i, count - i, ctx);
+}
+
+void st7735r_cvt_rgb565be(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	(void)ctx;
+	rt_memcpy(dst, src, count * 2);
+}
+
+void st7735r_cvt_gray8_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	const rt_uint8_t *pixel = (const rt_uint8_t *)src;
+	(void)ctx;
+	for (rt_size_t i = 0; i < count; ++i)
+	{
+		const rt_uint8_t gs_color = pixel[i];
+		const rt_uint16_t color = ((gs_color >> 3) << 11) | ((gs_color >> 2) << 5) | (gs_color >> 3);
+		*dst++ = color >> 8;
+		*dst++ = color;
+	}
+}
+
+void st7735r_cvt_gray8(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	rt_size_t i = 0;
+#ifdef ST7735R_CVT_LE
+	const rt_uint8_t *in = (const rt_uint8_t *)src;
+#if defined(ST7735R_CVT_SSE2)
+	const __m128i mask_f8 = _mm_set1_epi8((char)0xF8);
+	const __m128i mask_07 = _mm_set1_epi8(0x07);
+	const __m128i mask_e0 = _mm_set1_epi8((char)0xE0);
+	const __m128i mask_1f = _mm_set1_epi8(0x1F);
+	for (; i + 16 <= count; i += 16)
+	{
+		const __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+		const __m128i hi = _mm_or_si128(_mm_and_si128(v, mask_f8), _mm_and_si128(_mm_srli_epi16(v, 5), mask_07));
+		const __m128i lo = _mm_or_si128(_mm_and_si128(_mm_slli_epi16(v, 3), mask_e0), _mm_and_si128(_mm_srli_epi16(v, 3), mask_1f));
+		_mm_storeu_si128((__m128i *)(dst + i * 2), _mm_unpacklo_epi8(hi, lo));
+		_mm_storeu_si128((__m128i *)(dst + i * 2 + 16), _mm_unpackhi_epi8(hi, lo));
+	}
+#elif defined(ST7735R_CVT_NEON)
+	for (; i + 16 <= count; i += 16)
+	{
+		const uint8x16_t v = vld1q_u8(in + i);
+		uint8x16x2_t out;
+		out.val[0] = vorrq_u8(vandq_u8(v, vdupq_n_u8(0xF8)), vshrq_n_u8(v, 5));
+		out.val[1] = vorrq_u8(vandq_u8(vshlq_n_u8(v, 3), vdupq_n_u8(0xE0)), vshrq_n_u8(v, 3));
+		vst2q_u8(dst + i * 2, out);
+	}
+#endif
+	if (ST7735R_CVT_ALIGNED(in + i, dst + i * 2))
+	{
+		// four pixels per word, both output bytes are computed for all lanes at once
+		for (; i + 4 <= count; i += 4)
+		{
+			const rt_uint32_t w = *(const rt_uint32_t *)(in + i);
+			const rt_uint32_t hi = (w & 0xF8F8F8F8) | ((w >> 5) & 0x07070707);
+			const rt_uint32_t lo = ((w << 3) & 0xE0E0E0E0) | ((w >> 3) & 0x1F1F1F1F);
+			rt_uint32_t *out = (rt_uint32_t *)(dst + i * 2);
+			out[0] = (hi & 0xFF) | ((lo & 0xFF) << 8) | ((hi & 0xFF00) << 8) | ((lo & 0xFF00) << 16);
+			out[1] = ((hi >> 16) & 0xFF) | ((lo >> 8) & 0xFF00) | ((hi >> 8) & 0xFF0000) | (lo & 0xFF000000);
+		}
+	}
+#endif
+	st7735r_cvt_gray8_ref(dst + i * 2, (const rt_uint8_t *)src + i, count - i, ctx);
+}
+
+void st7735r_cvt_rgb888_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	const rt_uint8_t *pixel = (const rt_uint8_t *)src;
+	(void)ctx;
+	for (rt_size_t i = 0; i < count; ++i)
+	{
+		const rt_uint16_t color = ((pixel[0] >> 3) << 11) | ((pixel[1] >> 2) << 5) | (pixel[2] >> 3);
+		*dst++ = color >> 8;
+		*dst++ = color;
+		pixel += 3;
+	}
+}
+
+void st7735r_cvt_rgb888(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	rt_size_t i = 0;
+	const rt_uint8_t *in = (const rt_uint8_t *)src;
+	(void)ctx;
+#ifdef ST7735R_CVT_NEON
+	for (; i + 16 <= count; i += 16)
+	{
+		const uint8x16x3_t v = vld3q_u8(in + i * 3);
+		uint8x16x2_t out;
+		out.val[0] = vorrq_u8(vandq_u8(v.val[0], vdupq_n_u8(0xF8)), vshrq_n_u8(v.val[1], 5));
+		out.val[1] = vorrq_u8(vandq_u8(vshlq_n_u8(v.val[1], 3), vdupq_n_u8(0xE0)), vshrq_n_u8(v.val[2], 3));
+		vst2q_u8(dst + i * 2, out);
+	}
+#endif
+	for (; i < count; ++i)
+	{
+		const rt_uint8_t *p = in + i * 3;
+		rt_uint8_t *out = dst + i * 2;
+		ST7735R_CVT_PUT888(out, p[0], p[1], p[2]);
+	}
+}
+
+void st7735r_cvt_argb8888_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	const rt_uint32_t *pixel = (const rt_uint32_t *)src;
+	const rt_uint16_t bg = ctx->bg_color;
+	const rt_uint32_t bg_rgb[3] =
+	{
+		((bg >> 11) << 3) | (bg >> 13),
+		(((bg >> 5) & 0x3F) << 2) | ((bg >> 9) & 0x03),
+		((bg & 0x1F) << 3) | ((bg >> 2) & 0x07),
+	};
+	for (rt_size_t i = 0; i < count; ++i)
+	{
+		const rt_uint32_t a = pixel[i] >> 24;
+		rt_uint32_t rgb[3];
+		for (rt_uint32_t c = 0; c < 3; ++c)
+		{
+			const rt_uint32_t x = ((pixel[i] >> (16 - c * 8)) & 0xFF) * a + bg_rgb[c] * (255 - a) + 128;
+			rgb[c] = ST7735R_CVT_DIV255(x);
+		}
+		const rt_uint16_t color = ((rgb[0] >> 3) << 11) | ((rgb[1] >> 2) << 5) | (rgb[2] >> 3);
+		*dst++ = color >> 8;
+		*dst++ = color;
+	}
+}
+
+void st7735r_cvt_argb8888(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	const rt_uint32_t *pixel = (const rt_uint32_t *)src;
+	const rt_uint16_t bg = ctx->bg_color;
+	const rt_uint32_t bg_rgb = ((((bg >> 11) << 3) | (bg >> 13)) << 16)
+		| (((((bg >> 5) & 0x3F) << 2) | ((bg >> 9) & 0x03)) << 8)
+		| (((bg & 0x1F) << 3) | ((bg >> 2) & 0x07));
+	for (rt_size_t i = 0; i < count; ++i)
+	{
+		const rt_uint32_t p = pixel[i];
+		const rt_uint32_t a = p >> 24;
+		rt_uint32_t rgb;
+		if (a == 0xFF)
+		{
+			rgb = p;
+		}
+		else if (a == 0)
+		{
+			rgb = bg_rgb;
+		}
+		else
+		{
+			// red and blue are blended together in the two 16-bit lanes of one word
+			rt_uint32_t rb = (p & 0x00FF00FF) * a + (bg_rgb & 0x00FF00FF) * (255 - a) + 0x00800080;
+			rb = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+			rt_uint32_t g = ((p >> 8) & 0xFF) * a + ((bg_rgb >> 8) & 0xFF) * (255 - a) + 128;
+			g = ST7735R_CVT_DIV255(g);
+			rgb = rb | (g << 8);
+		}
+		ST7735R_CVT_PUT888(dst, (rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF);
+	}
+}
+
+void st7735r_cvt_rgb332_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	const rt_uint8_t *pixel = (const rt_uint8_t *)src;
+	(void)ctx;
+	for (rt_size_t i = 0; i < count; ++i)
+	{
+		// widen each channel by repeating its top bits
+		const rt_uint32_t r = pixel[i] >> 5;
+		const rt_uint32_t g = (pixel[i] >> 2) & 0x07;
+		const rt_uint32_t b = pixel[i] & 0x03;
+		const rt_uint16_t color = ((r << 2 | r >> 1) << 11) | ((g << 3 | g) << 5) | (b << 3 | b << 1 | b >> 1);
+		*dst++ = color >> 8;
+		*dst++ = color;
+	}
+}
+
+void st7735r_cvt_rgb332(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	const rt_uint8_t *pixel = (const rt_uint8_t *)src;
+	(void)ctx;
+	for (rt_size_t i = 0; i < count; ++i)
+	{
+		const rt_uint8_t *color = &st7735r_rgb332_lut[pixel[i] * 2];
+		*dst++ = color[0];
+		*dst++ = color[1];
+	}
+}
+
+static void st7735r_cvt_index_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const rt_uint16_t *palette, rt_uint32_t bits)
+{
+	const rt_uint8_t *pixel = (const rt_uint8_t *)src;
+	for (rt_size_t i = 0; i < count; ++i)
+	{
+		const rt_uint32_t bit = i * bits;
+		const rt_uint16_t color = palette[(pixel[bit / 8] >> (8 - bits - bit % 8)) & ((1 << bits) - 1)];
+		*dst++ = color >> 8;
+		*dst++ = color;
+	}
+}
+
+void st7735r_cvt_index1_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	st7735r_cvt_index_ref(dst, src, count, ctx->palette, 1);
+}
+
+void st7735r_cvt_index2_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	st7735r_cvt_index_ref(dst, src, count, ctx->palette, 2);
+}
+
+void st7735r_cvt_index4_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	st7735r_cvt_index_ref(dst, src, count, ctx->palette, 4);
+}
+
+void st7735r_cvt_index8_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	st7735r_cvt_index_ref(dst, src, count, ctx->palette, 8);
+}
+
+/* Whole source bytes at a time, the leftover pixels go through the reference code */
+#define ST7735R_CVT_INDEX(bits) \
+	void st7735r_cvt_index##bits(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx) \
+	{ \
+		const rt_uint8_t *pixel = (const rt_uint8_t *)src; \
+		const rt_uint16_t *palette = ctx->palette; \
+		rt_size_t i = 0; \
+		for (; i + 8 / bits <= count; i += 8 / bits) \
+		{ \
+			const rt_uint32_t b = *pixel++; \
+			for (rt_int32_t shift = 8 - bits; shift >= 0; shift -= bits) \
+			{ \
+				const rt_uint16_t color = palette[(b >> shift) & ((1 << bits) - 1)]; \
+				*dst++ = color >> 8; \
+				*dst++ = color; \
+			} \
+		} \
+		st7735r_cvt_index_ref(dst, pixel, count - i, palette, bits); \
+	}
+
+ST7735R_CVT_INDEX(1)
+ST7735R_CVT_INDEX(2)
+ST7735R_CVT_INDEX(4)
+ST7735R_CVT_INDEX(8)
+
+void st7735r_rle_init(struct st7735r_rle *rle, const void *src)
+{
+	rle->src = (const rt_uint8_t *)src;
+	rle->left = 0;
+	rle->run = RT_FALSE;
+	rle->color = 0;
+}
+
+rt_uint32_t st7735r_rle_next(struct st7735r_rle *rle)
+{
+	if (rle->left)
+	{
+		return rle->left;
+	}
+	const rt_uint8_t header = *rle->src++;
+	rle->left = header & 0x3F;
+	if (header & ST7735R_RLE_LONG)
+	{
+		rle->left = (rle->left << 8) | *rle->src++;
+	}
+	rle->left += 1;
+	rle->run = (header & ST7735R_RLE_RUN) != 0;
+	if (rle->run)
+	{
+		rle->color = rle->src[0] | (rle->src[1] << 8);
+		rle->src += 2;
+	}
+	return rle->left;
+}
+
+void st7735r_rle_skip(struct st7735r_rle *rle, rt_uint32_t count)
+{
+	while (count)
+	{
+		rt_uint32_t n = st7735r_rle_next(rle);
+		if (n > count)
+		{
+			n = count;
+		}
+		if (!rle->run)
+		{
+			rle->src += n * 2;
+		}
+		rle->left -= n;
+		count -= n;
+	}
+}
+
+void st7735r_cvt_rle565(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx)
+{
+	struct st7735r_rle *rle = ctx->rle;
+	(void)src;
+	while (count)
+	{
+		rt_uint32_t n = st7735r_rle_next(rle);
+		if (n > count)
+		{
+			n = count;
+		}
+		if (rle->run)
+		{
+			for (rt_uint32_t i = 0; i < n; ++i)
+			{
+				*dst++ = rle->color >> 8;
+				*dst++ = rle->color;
+			}
+		}
+		else
+		{
+			for (rt_uint32_t i = 0; i < n; ++i)
+			{
+				*dst++ = rle->src[1];
+				*dst++ = rle->src[0];
+				rle->src += 2;
+			}
+		}
+		rle->left -= n;
+		count -= n;
+	}
+}
+
+rt_uint32_t st7735r_pack_room(const struct st7735r_pack *pack, rt_size_t room)
+{
+	switch (pack->bits)
+	{
+	case 12:
+		// the rgb565 pixels are staged 2 bytes ahead of the packed ones
+		return room > 2 ? (room - 2) / 2 : 0;
+	case 18:
+		return room / 3;
+	default:
+		return room / 2;
+	}
+}
+
+rt_uint8_t *st7735r_pack_src(const struct st7735r_pack *pack, rt_uint8_t *dst, rt_uint32_t count)
+{
+	switch (pack->bits)
+	{
+	case 12:
+		return dst + 2;
+	case 18:
+		return dst + count;
+	default:
+		return dst;
+	}
+}
+
+/* Pack two rgb565 pixels into 3 bytes of rgb444, both are read before any byte is written */
+static void st7735r_pack12(rt_uint8_t *dst, const rt_uint8_t *a, const rt_uint8_t *b)
+{
+	const rt_uint8_t h0 = a[0], l0 = a[1], h1 = b[0], l1 = b[1];
+	dst[0] = (h0 & 0xF0) | ((h0 & 0x07) << 1) | (l0 >> 7);
+	dst[1] = ((l0 << 3) & 0xF0) | (h1 >> 4);
+	dst[2] = ((h1 & 0x07) << 5) | ((l1 >> 3) & 0x10) | ((l1 >> 1) & 0x0F);
+}
+
+rt_size_t st7735r_pack(struct st7735r_pack *pack, rt_uint8_t *dst, rt_uint32_t count)
+{
+	rt_uint32_t i = 0;
+	if (pack->bits == 12)
+	{
+		const rt_uint8_t *in = dst + 2;
+		rt_uint8_t *out = dst;
+		if (pack->odd && count)
+		{
+			st7735r_pack12(out, pack->carry, in);
+			out += 3;
+			in += 2;
+			i = 1;
+			pack->odd = RT_FALSE;
+		}
+		for (; i + 2 <= count; i += 2)
+		{
+			st7735r_pack12(out, in, in + 2);
+			out += 3;
+			in += 4;
+		}
+		if (i < count)
+		{
+			pack->carry[0] = in[0];
+			pack->carry[1] = in[1];
+			pack->odd = RT_TRUE;
+		}
+		return out - dst;
+	}
+	if (pack->bits == 18)
+	{
+		// expand forward, the source sits `count` bytes ahead and is never overtaken
+		const rt_uint8_t *in = dst + count;
+		for (; i < count; ++i)
+		{
+			const rt_uint8_t h = in[i * 2], l = in[i * 2 + 1];
+			const rt_uint8_t g = ((h & 0x07) << 5) | ((l >> 3) & 0x1C);
+			dst[i * 3] = (h & 0xF8) | (h >> 5);
+			dst[i * 3 + 1] = g | (g >> 6);
+			dst[i * 3 + 2] = (l << 3) | ((l >> 2) & 0x07);
+		}
+		return count * 3;
+	}
+	return count * 2;
+}
+
+rt_size_t st7735r_pack_finish(struct st7735r_pack *pack, rt_uint8_t *dst)
+{
+	if (pack->bits != 12 || !pack->odd)
+	{
+		return 0;
+	}
+	const rt_uint8_t h = pack->carry[0], l = pack->carry[1];
+	dst[0] = (h & 0xF0) | ((h & 0x07) << 1) | (l >> 7);
+	dst[1] = (l << 3) & 0xF0;
+	pack->odd = RT_FALSE;
+	return 2;
+}
+
+#endif
@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2021 Lee Chun Hei, Leslie
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __ST7735R_CONVERT_H__
+#define __ST7735R_CONVERT_H__
+
+#include "rtthread.h"
+
+#ifdef PKG_USING_ST7735R_TFT
+
+/*
+ * RLE rgb565 stream, a sequence of packets each starting with a header
+ * byte. Bit 7 set is a run of one pixel, clear a literal of that many
+ * pixels. The length minus one is in bits 0-5, or in bits 0-5 and the next
+ * byte (high bits first) when bit 6 is set. Pixels are little endian.
+ */
+#define ST7735R_RLE_RUN         0x80
+#define ST7735R_RLE_LONG        0x40
+#define ST7735R_RLE_MAX_SHORT   64
+#define ST7735R_RLE_MAX_LONG    16384
+
+/* Decoder state, the stream is resumed where the last call left off */
+struct st7735r_rle
+{
+    const rt_uint8_t *src;
+    /* pixels left in the current packet */
+    rt_uint32_t left;
+    rt_bool_t run;
+    rt_uint16_t color;
+};
+
+struct st7735r_cvt_ctx
+{
+    /* rgb565 colors looked up by the indexed formats */
+    const rt_uint16_t *palette;
+    /* rgb565 color that argb8888 pixels are blended over */
+    rt_uint16_t bg_color;
+    /* stream decoded by st7735r_cvt_rle565, which ignores src */
+    struct st7735r_rle *rle;
+};
+
+/* Each converter writes `count` big-endian rgb565 pixels to dst */
+typedef void (*st7735r_cvt_t)(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+
+/* Native endian rgb565 */
+void st7735r_cvt_rgb565(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+/* One byte per pixel grayscale */
+void st7735r_cvt_gray8(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+/* R, G, B bytes */
+void st7735r_cvt_rgb888(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+/* Native endian 0xAARRGGBB words */
+void st7735r_cvt_argb8888(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+/* RRRGGGBB bytes */
+void st7735r_cvt_rgb332(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+/* Palette indexes packed MSB first, the palette needs 2, 4, 16 or 256 entries */
+void st7735r_cvt_index1(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+void st7735r_cvt_index2(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+void st7735r_cvt_index4(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+void st7735r_cvt_index8(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+/* Big-endian rgb565, copied as is */
+void st7735r_cvt_rgb565be(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+/* The next `count` pixels of ctx->rle */
+void st7735r_cvt_rle565(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+
+void st7735r_rle_init(struct st7735r_rle *rle, const void *src);
+/* Pixels left in the current packet, the next header is read when it is used up */
+rt_uint32_t st7735r_rle_next(struct st7735r_rle *rle);
+void st7735r_rle_skip(struct st7735r_rle *rle, rt_uint32_t count);
+
+/*
+ * Interface pixel packing. Pixels are converted to big-endian rgb565 at
+ * st7735r_pack_src() and then packed in place to dst for the 12-bit and
+ * 18-bit interface formats. 12-bit pixels go out in pairs, an unpaired
+ * pixel is carried over to the next call and padded by st7735r_pack_finish().
+ */
+struct st7735r_pack
+{
+    /* 12, 16 or 18 bits per pixel on the wire */
+    rt_uint8_t bits;
+    rt_bool_t odd;
+    rt_uint8_t carry[2];
+};
+
+/* Pixels that can be converted and packed into `room` bytes */
+rt_uint32_t st7735r_pack_room(const struct st7735r_pack *pack, rt_size_t room);
+rt_uint8_t *st7735r_pack_src(const struct st7735r_pack *pack, rt_uint8_t *dst, rt_uint32_t count);
+/* Both return the number of bytes written to dst */
+rt_size_t st7735r_pack(struct st7735r_pack *pack, rt_uint8_t *dst, rt_uint32_t count);
+rt_size_t st7735r_pack_finish(struct st7735r_pack *pack, rt_uint8_t *dst);
+
+/* Scalar reference versions, the converters above must match them byte for byte */
+void st7735r_cvt_rgb565_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+void st7735r_cvt_gray8_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+void st7735r_cvt_rgb888_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+void st7735r_cvt_argb8888_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+void st7735r_cvt_rgb332_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+void st7735r_cvt_index1_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+void st7735r_cvt_index2_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+void st7735r_cvt_index4_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+void st7735r_cvt_index8_ref(rt_uint8_t *dst, const void *src, rt_size_t count, const struct st7735r_cvt_ctx *ctx);
+
+#endif
+#endif
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2021 Lee Chun Hei, Leslie
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+
+#ifdef PKG_ST7735R_USING_LVGL
+#include "drv_st7735r.h"
+#include "st7735r_lvgl.h"
+
+#define LOG_TAG             "drv.st7735r"
+#include <drv_log.h>
+
+#ifndef PKG_ST7735R_LVGL_BUF_LINES
+	#define PKG_ST7735R_LVGL_BUF_LINES  16
+#endif
+
+/* lv_color_t is written as is, in the driver format matching its layout */
+#if LV_COLOR_DEPTH == 16 && LV_COLOR_16_SWAP
+	#define ST7735R_LVGL_FORMAT     RT_ST7735R_WRITE_COLOR_SWAP_PIXEL
+#elif LV_COLOR_DEPTH == 16
+	#define ST7735R_LVGL_FORMAT     RT_ST7735R_WRITE_COLOR_PIXEL
+#elif LV_COLOR_DEPTH == 32
+	#define ST7735R_LVGL_FORMAT     RT_ST7735R_WRITE_ARGB8888_PIXEL
+#elif LV_COLOR_DEPTH == 8
+	#define ST7735R_LVGL_FORMAT     RT_ST7735R_WRITE_RGB332_PIXEL
+#else
+	#error "st7735r lvgl port: LV_COLOR_DEPTH must be 8, 16 or 32"
+#endif
+
+/*
+ * One LVGL display. With the non-blocking write the flush callback only
+ * queues the area and flush_ready is signalled from tx_complete, so LVGL
+ * renders into one draw buffer while the other is on the wire.
+ */
+static struct
+{
+	rt_device_t dev;
+	rt_bool_t async;
+	/* set by every finished flush, cleared by the wait callback */
+	struct rt_event done;
+	lv_disp_draw_buf_t draw_buf;
+	lv_disp_drv_t disp_drv;
+	struct st7735r_lvgl_stats stats;
+} st7735r_lvgl;
+
+static rt_err_t st7735r_lvgl_tx_done(rt_device_t dev, void *buffer)
+{
+	(void)dev;
+	(void)buffer;
+	lv_disp_flush_ready(&st7735r_lvgl.disp_drv);
+	rt_event_send(&st7735r_lvgl.done, 0x01);
+	return RT_EOK;
+}
+
+static void st7735r_lvgl_flush(lv_disp_drv_t *disp_drv, const lv_area_t *area, lv_color_t *color_p)
+{
+	const rt_tick_t start = rt_tick_get();
+	struct rt_st7735r_rect rect = {area->x1, area->y1, lv_area_get_width(area), lv_area_get_height(area)};
+	const rt_size_t size = rect.width * rect.height;
+	// a queued write keeps the rect it was submitted with
+	rt_device_control(st7735r_lvgl.dev, RT_ST7735R_SET_RECT, &rect);
+	if (rt_device_write(st7735r_lvgl.dev, ST7735R_LVGL_FORMAT, color_p, size) != size || !st7735r_lvgl.async)
+	{
+		lv_disp_flush_ready(disp_drv);
+	}
+	++st7735r_lvgl.stats.flushes;
+	st7735r_lvgl.stats.pixels += size;
+	st7735r_lvgl.stats.flush_ticks += rt_tick_get() - start;
+}
+
+/* Called by LVGL in a loop while the previous flush is pending, sleep instead of spinning */
+static void st7735r_lvgl_wait(lv_disp_drv_t *disp_drv)
+{
+	(void)disp_drv;
+	const rt_tick_t start = rt_tick_get();
+	if (st7735r_lvgl.async)
+	{
+		rt_event_recv(&st7735r_lvgl.done, 0x01, RT_EVENT_FLAG_OR | RT_EVENT_FLAG_CLEAR, RT_WAITING_FOREVER, RT_NULL);
+	}
+	st7735r_lvgl.stats.wait_ticks += rt_tick_get() - start;
+}
+
+lv_disp_t *st7735r_lvgl_init(const char *name)
+{
+	rt_device_t dev = rt_device_find(name);
+	if (dev == RT_NULL)
+	{
+		LOG_E(LOG_TAG" can't find %s for lvgl", name);
+		return RT_NULL;
+	}
+	if (rt_device_open(dev, RT_DEVICE_OFLAG_RDWR | RT_DEVICE_FLAG_DMA_TX) != RT_EOK)
+	{
+		LOG_E(LOG_TAG" open %s for lvgl failed", name);
+		return RT_NULL;
+	}
+	rt_st7735r_t lcd = (rt_st7735r_t)dev;
+	const rt_uint32_t count = lcd->width * PKG_ST7735R_LVGL_BUF_LINES;
+	lv_color_t *buf1 = rt_malloc(count * sizeof(lv_color_t));
+	lv_color_t *buf2 = RT_NULL;
+#ifdef PKG_ST7735R_LVGL_DOUBLE_BUF
+	buf2 = rt_malloc(count * sizeof(lv_color_t));
+	if (buf2 == RT_NULL)
+	{
+		rt_free(buf1);
+		buf1 = RT_NULL;
+	}
+#endif
+	if (buf1 == RT_NULL)
+	{
+		LOG_E(LOG_TAG" no memory for the lvgl draw buffers");
+		rt_device_close(dev);
+		return RT_NULL;
+	}
+
+	st7735r_lvgl.dev = dev;
+	st7735r_lvgl.async = RT_FALSE;
+#ifdef PKG_ST7735R_USING_ASYNC
+	// the same test rt_device_write makes, the device may have been opened without DMA_TX before
+	st7735r_lvgl.async = lcd->async && (dev->open_flag & RT_DEVICE_FLAG_DMA_TX);
+#endif
+	rt_event_init(&st7735r_lvgl.done, name, RT_IPC_FLAG_FIFO);
+	if (st7735r_lvgl.async)
+	{
+		rt_device_set_tx_complete(dev, st7735r_lvgl_tx_done);
+	}
+
+	lv_disp_draw_buf_init(&st7735r_lvgl.draw_buf, buf1, buf2, count);
+	lv_disp_drv_init(&st7735r_lvgl.disp_drv);
+	st7735r_lvgl.disp_drv.hor_res = lcd->width;
+	st7735r_lvgl.disp_drv.ver_res = lcd->height;
+	st7735r_lvgl.disp_drv.flush_cb = st7735r_lvgl_flush;
+	st7735r_lvgl.disp_drv.wait_cb = st7735r_lvgl_wait;
+	st7735r_lvgl.disp_drv.draw_buf = &st7735r_lvgl.draw_buf;
+	return lv_disp_drv_register(&st7735r_lvgl.disp_drv);
+}
+
+void st7735r_lvgl_get_stats(struct st7735r_lvgl_stats *stats)
+{
+	*stats = st7735r_lvgl.stats;
+}
+
+void st7735r_lvgl_reset_stats(void)
+{
+	rt_memset(&st7735r_lvgl.stats, 0x0, sizeof(st7735r_lvgl.stats));
+}
+#endif
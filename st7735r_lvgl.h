@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2021 Lee Chun Hei, Leslie
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM,
+ * DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR
+ * OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __ST7735R_LVGL_H__
+#define __ST7735R_LVGL_H__
+
+#include "rtthread.h"
+
+#ifdef PKG_ST7735R_USING_LVGL
+#include <lvgl.h>
+
+struct st7735r_lvgl_stats
+{
+    rt_uint32_t flushes;
+    rt_uint32_t pixels;
+    /* ticks LVGL spent in the flush callback, the whole transfer without the non-blocking write */
+    rt_uint32_t flush_ticks;
+    /* ticks LVGL waited for the previous flush before it could flush again */
+    rt_uint32_t wait_ticks;
+};
+
+/* Open the st7735r device `name` and register it as an LVGL display, after lv_init */
+lv_disp_t *st7735r_lvgl_init(const char *name);
+void st7735r_lvgl_get_stats(struct st7735r_lvgl_stats *stats);
+void st7735r_lvgl_reset_stats(void);
+
+#endif
+#endif
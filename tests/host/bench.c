@@ -0,0 +1,179 @@
+/*
+ * What every basic drawing op costs: bytes, SPI transfers and dc toggles
+ * on the bus, the time they take on the wire at a given SCK, and the CPU
+ * time of the driver per op with the panel model's own time taken out.
+ *
+ *   bench [-s sck_hz] [-g gap_us] [-n reps] [-d prefix]
+ *
+ * -g adds a fixed gap per transfer to the wire time, for a bus driver
+ * that sets up every transfer by hand. -d writes the GRAM after the run
+ * to prefix.ppm and prefix.png. CPU times are of the calling thread, so
+ * with PKG_ST7735R_USING_ASYNC they only cover the staging.
+ */
+
+#include <getopt.h>
+
+#include "test.h"
+
+#define BENCH_W 128
+#define BENCH_H 160
+
+static rt_st7735r_t lcd;
+static struct rt_device_graphic_ops *ops;
+static rt_uint16_t frame[BENCH_W * BENCH_H];
+static rt_uint8_t gray[BENCH_W * BENCH_H];
+static int rep;
+
+static void op_clear(void)
+{
+	st7735r_clear(lcd, rep * 0x0841);
+}
+
+static void op_frame(void)
+{
+	struct rt_st7735r_rect all = {0, 0, BENCH_W, BENCH_H};
+
+	rt_device_control(&lcd->parent, RT_ST7735R_SET_RECT, &all);
+	rt_device_write(&lcd->parent, RT_ST7735R_WRITE_COLOR_PIXEL, frame, BENCH_W * BENCH_H);
+	rt_device_control(&lcd->parent, RT_ST7735R_WAIT_FLUSH, RT_NULL);
+}
+
+static void op_gray(void)
+{
+	struct rt_st7735r_rect all = {0, 0, BENCH_W, BENCH_H};
+
+	rt_device_control(&lcd->parent, RT_ST7735R_SET_RECT, &all);
+	rt_device_write(&lcd->parent, RT_ST7735R_WRITE_GRAYSCALE_PIXEL, gray, BENCH_W * BENCH_H);
+	rt_device_control(&lcd->parent, RT_ST7735R_WAIT_FLUSH, RT_NULL);
+}
+
+static void op_fill(void)
+{
+	struct rt_st7735r_fill fill = {{32, 48, 64, 64}, rep * 0x1111};
+
+	rt_device_control(&lcd->parent, RT_ST7735R_FILL_RECT, &fill);
+}
+
+/* a 64x64 sprite pixel by pixel, in row order */
+static void op_set_pixel(void)
+{
+	int x, y;
+
+	for (y = 0; y < 64; ++y)
+		for (x = 0; x < 64; ++x)
+			ops->set_pixel((const char *)&frame[y * BENCH_W + x], 32 + x, 48 + y);
+}
+
+static void op_hline(void)
+{
+	rt_uint16_t c = rep;
+	int y;
+
+	for (y = 0; y < BENCH_H; ++y)
+		ops->draw_hline((const char *)&c, 0, BENCH_W, y);
+}
+
+static void op_vline(void)
+{
+	rt_uint16_t c = rep;
+	int x;
+
+	for (x = 0; x < BENCH_W; ++x)
+		ops->draw_vline((const char *)&c, x, 0, BENCH_H);
+}
+
+static void op_blit_line(void)
+{
+	int y;
+
+	for (y = 0; y < BENCH_H; ++y)
+		ops->blit_line((const char *)&frame[y * BENCH_W], 0, y, BENCH_W);
+}
+
+static const struct
+{
+	const char *name;
+	void (*run)(void);
+} bench_ops[] =
+{
+	{"clear", op_clear},
+	{"frame rgb565", op_frame},
+	{"frame gray8", op_gray},
+	{"fill 64x64", op_fill},
+	{"set_pixel 64x64", op_set_pixel},
+	{"hline x160", op_hline},
+	{"vline x128", op_vline},
+	{"blit_line x160", op_blit_line},
+};
+
+int main(int argc, char **argv)
+{
+	double sck = 15e6, gap_us = 0;
+	const char *dump = RT_NULL;
+	int reps = 20, opt, i;
+	unsigned k;
+
+	while ((opt = getopt(argc, argv, "s:g:n:d:")) != -1)
+	{
+		switch (opt)
+		{
+		case 's':
+			sck = atof(optarg);
+			break;
+		case 'g':
+			gap_us = atof(optarg);
+			break;
+		case 'n':
+			reps = atoi(optarg);
+			break;
+		case 'd':
+			dump = optarg;
+			break;
+		default:
+			fprintf(stderr, "usage: %s [-s sck_hz] [-g gap_us] [-n reps] [-d prefix]\n", argv[0]);
+			return 2;
+		}
+	}
+
+#ifdef PKG_ST7735R_USING_ASYNC
+	lcd = test_open(RT_DEVICE_FLAG_DMA_TX);
+#else
+	lcd = test_open(0);
+#endif
+	ops = test_ops(lcd);
+	srand(1);
+	for (i = 0; i < BENCH_W * BENCH_H; ++i)
+	{
+		frame[i] = ((i % BENCH_W) * 31 / BENCH_W) << 11 | ((i / BENCH_W) * 63 / BENCH_H) << 5 | (rand() & 31);
+		gray[i] = i * 7 + (i / BENCH_W);
+	}
+
+	printf("%d reps per op, SCK %.2f MHz, %.1f us per transfer, colmod %d\n\n", reps, sck / 1e6, gap_us, sim.colmod);
+	printf("%-16s %9s %9s %9s %11s %9s %7s\n", "op", "bytes", "transfers", "dc", "wire us", "cpu us", "ops/s");
+	for (k = 0; k < sizeof(bench_ops) / sizeof(bench_ops[0]); ++k)
+	{
+		double cpu, wire;
+
+		sim_reset_counters(&sim);
+		cpu = sim_cpu_us();
+		for (rep = 0; rep < reps; ++rep)
+			bench_ops[k].run();
+		cpu = (sim_cpu_us() - cpu - sim.model_us) / reps;
+		wire = (sim.bytes * 8e6 / sck + sim.transfers * gap_us) / reps;
+		printf("%-16s %9lu %9lu %9lu %11.1f %9.1f %7.1f\n", bench_ops[k].name, sim.bytes / reps, sim.transfers / reps, sim.dc_toggles / reps,
+		       wire, cpu, 1e6 / (wire > cpu ? wire : cpu));
+	}
+
+	if (dump)
+	{
+		char path[256];
+
+		rt_device_control(&lcd->parent, RT_ST7735R_WAIT_FLUSH, RT_NULL);
+		snprintf(path, sizeof(path), "%s.ppm", dump);
+		CHECK(sim_dump_ppm(&sim, path) == 0);
+		snprintf(path, sizeof(path), "%s.png", dump);
+		CHECK(sim_dump_png(&sim, path) == 0);
+		printf("\nGRAM written to %s.ppm and %s.png\n", dump, dump);
+	}
+	return test_failed != 0;
+}
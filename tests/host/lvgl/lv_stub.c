@@ -0,0 +1,70 @@
+/*
+ * LVGL display API stand-in, see lvgl.h.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "lvgl.h"
+
+void lv_disp_draw_buf_init(lv_disp_draw_buf_t *draw_buf, void *buf1, void *buf2, uint32_t size)
+{
+	memset(draw_buf, 0, sizeof(*draw_buf));
+	draw_buf->buf1 = draw_buf->buf_act = buf1;
+	draw_buf->buf2 = buf2;
+	draw_buf->size = size;
+}
+
+void lv_disp_drv_init(lv_disp_drv_t *driver)
+{
+	memset(driver, 0, sizeof(*driver));
+}
+
+lv_disp_t *lv_disp_drv_register(lv_disp_drv_t *driver)
+{
+	lv_disp_t *disp = calloc(1, sizeof(*disp));
+
+	disp->driver = driver;
+	return disp;
+}
+
+void lv_disp_flush_ready(lv_disp_drv_t *driver)
+{
+	driver->draw_buf->flushing = 0;
+	driver->draw_buf->flushing_last = 0;
+}
+
+static void lv_stub_wait_flush(lv_disp_drv_t *driver)
+{
+	while (driver->draw_buf->flushing)
+		if (driver->wait_cb)
+			driver->wait_cb(driver);
+}
+
+/* like lv_refr: render the area in strips of the draw buffer and flush each one */
+void lv_stub_refr(lv_disp_t *disp, const lv_area_t *area, void (*render)(lv_color_t *buf, const lv_area_t *area))
+{
+	lv_disp_drv_t *driver = disp->driver;
+	lv_disp_draw_buf_t *draw_buf = driver->draw_buf;
+	int rows = draw_buf->size / lv_area_get_width(area), y;
+
+	for (y = area->y1; y <= area->y2; y += rows)
+	{
+		lv_area_t strip = {area->x1, y, area->x2, y + rows - 1 > area->y2 ? area->y2 : y + rows - 1};
+
+		/* with one buffer LVGL waits before drawing into it again */
+		if (!draw_buf->buf2)
+			lv_stub_wait_flush(driver);
+		render(draw_buf->buf_act, &strip);
+		lv_stub_wait_flush(driver);
+		draw_buf->flushing = 1;
+		driver->flush_cb(driver, &strip, draw_buf->buf_act);
+		if (draw_buf->buf2)
+			draw_buf->buf_act = draw_buf->buf_act == draw_buf->buf1 ? draw_buf->buf2 : draw_buf->buf1;
+	}
+}
+
+void lv_stub_wait(lv_disp_t *disp)
+{
+	lv_stub_wait_flush(disp->driver);
+}
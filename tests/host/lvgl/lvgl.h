@@ -0,0 +1,82 @@
+/*
+ * The part of the LVGL v8 display API that st7735r_lvgl.c uses, for the
+ * host build. lv_stub_refr stands in for the refresh of one area.
+ */
+
+#ifndef LVGL_H
+#define LVGL_H
+
+#include <stdint.h>
+
+#ifndef LV_COLOR_DEPTH
+#define LV_COLOR_DEPTH 16
+#endif
+#ifndef LV_COLOR_16_SWAP
+#define LV_COLOR_16_SWAP 0
+#endif
+
+typedef int16_t lv_coord_t;
+
+typedef struct
+{
+	lv_coord_t x1, y1, x2, y2;
+} lv_area_t;
+
+#if LV_COLOR_DEPTH == 16
+typedef union
+{
+	uint16_t full;
+} lv_color_t;
+#elif LV_COLOR_DEPTH == 32
+typedef union
+{
+	uint32_t full;
+} lv_color_t;
+#else
+typedef union
+{
+	uint8_t full;
+} lv_color_t;
+#endif
+
+typedef struct
+{
+	void *buf1, *buf2, *buf_act;
+	uint32_t size;
+	volatile int flushing;
+	volatile int flushing_last;
+} lv_disp_draw_buf_t;
+
+typedef struct _lv_disp_drv_t
+{
+	lv_coord_t hor_res, ver_res;
+	lv_disp_draw_buf_t *draw_buf;
+	void (*flush_cb)(struct _lv_disp_drv_t *drv, const lv_area_t *area, lv_color_t *color_p);
+	void (*wait_cb)(struct _lv_disp_drv_t *drv);
+	void *user_data;
+} lv_disp_drv_t;
+
+typedef struct
+{
+	lv_disp_drv_t *driver;
+} lv_disp_t;
+
+static inline lv_coord_t lv_area_get_width(const lv_area_t *a)
+{
+	return a->x2 - a->x1 + 1;
+}
+
+static inline lv_coord_t lv_area_get_height(const lv_area_t *a)
+{
+	return a->y2 - a->y1 + 1;
+}
+
+void lv_disp_draw_buf_init(lv_disp_draw_buf_t *draw_buf, void *buf1, void *buf2, uint32_t size);
+void lv_disp_drv_init(lv_disp_drv_t *driver);
+lv_disp_t *lv_disp_drv_register(lv_disp_drv_t *driver);
+void lv_disp_flush_ready(lv_disp_drv_t *driver);
+
+void lv_stub_refr(lv_disp_t *disp, const lv_area_t *area, void (*render)(lv_color_t *buf, const lv_area_t *area));
+void lv_stub_wait(lv_disp_t *disp);
+
+#endif
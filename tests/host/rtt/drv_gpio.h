@@ -0,0 +1,8 @@
+/* Host stand-in for the BSP drv_gpio.h: pins are numbered 16 per port */
+
+#ifndef __DRV_GPIO_H__
+#define __DRV_GPIO_H__
+
+#define GET_PIN(PORTx, PIN) (rt_base_t)((16 * (PORTx)) + (PIN))
+
+#endif /* __DRV_GPIO_H__ */
@@ -0,0 +1,11 @@
+/* Host stand-in for the BSP drv_log.h, debug messages are dropped */
+
+#ifndef __DRV_LOG_H__
+#define __DRV_LOG_H__
+
+#define LOG_E(fmt, ...) rt_kprintf(fmt "\n", ##__VA_ARGS__)
+#define LOG_W(fmt, ...) rt_kprintf(fmt "\n", ##__VA_ARGS__)
+#define LOG_I(fmt, ...) rt_kprintf(fmt "\n", ##__VA_ARGS__)
+#define LOG_D(fmt, ...) do { } while (0)
+
+#endif /* __DRV_LOG_H__ */
@@ -0,0 +1,10 @@
+/* Host stand-in for the BSP drv_spi.h */
+
+#ifndef __DRV_SPI_H__
+#define __DRV_SPI_H__
+
+#include <rtdevice.h>
+
+rt_err_t rt_hw_spi_device_attach(const char *bus_name, const char *device_name, rt_base_t cs_pin);
+
+#endif /* __DRV_SPI_H__ */
@@ -0,0 +1,38 @@
+/*
+ * Package configuration for the host build. The pins and panel size are
+ * what menuconfig would generate for lcd0; the Makefile turns the package
+ * options on per test with -D, and the sub-options get their Kconfig
+ * defaults here.
+ */
+
+#ifndef RT_CONFIG_H__
+#define RT_CONFIG_H__
+
+#define PKG_USING_ST7735R_TFT
+#define PKG_ST7735R_USING_KCONFIG
+#define PKG_ST7735R_SPI_BUS "spi0"
+#define PKG_ST7735R_CS_GPIO 0
+#define PKG_ST7735R_CS_PIN 1
+#define PKG_ST7735R_BL_GPIO 0
+#define PKG_ST7735R_BL_PIN 2
+#define PKG_ST7735R_DC_GPIO 0
+#define PKG_ST7735R_DC_PIN 3
+#define PKG_ST7735R_RES_GPIO 0
+#define PKG_ST7735R_RES_PIN 4
+#ifdef PKG_ST7735R_USING_TE
+#define PKG_ST7735R_TE_GPIO 0
+#define PKG_ST7735R_TE_PIN 5
+#endif
+#define PKG_ST7735R_WIDTH 128
+#define PKG_ST7735R_HEIGHT 160
+#ifndef PKG_ST7735R_ORI
+#define PKG_ST7735R_ORI 2
+#endif
+
+#ifdef PKG_ST7735R_USING_ASYNC
+#define PKG_ST7735R_ASYNC_QUEUE_DEPTH 4
+#define PKG_ST7735R_ASYNC_THREAD_STACK 1024
+#define PKG_ST7735R_ASYNC_THREAD_PRIORITY 10
+#endif
+
+#endif
@@ -0,0 +1,154 @@
+/*
+ * Host stand-in for the pin, SPI, PWM and graphic parts of rtdevice.h
+ * used by the st7735r package, implemented in sim_rtt.c.
+ */
+
+#ifndef __RT_DEVICE_H__
+#define __RT_DEVICE_H__
+
+#include <rtthread.h>
+
+#define PIN_LOW                 0x00
+#define PIN_HIGH                0x01
+
+#define PIN_MODE_OUTPUT         0x00
+#define PIN_MODE_INPUT          0x01
+#define PIN_MODE_INPUT_PULLUP   0x02
+
+#define PIN_IRQ_MODE_RISING     0x00
+#define PIN_IRQ_MODE_FALLING    0x01
+#define PIN_IRQ_DISABLE         0x00
+#define PIN_IRQ_ENABLE          0x01
+
+void rt_pin_mode(rt_base_t pin, rt_base_t mode);
+void rt_pin_write(rt_base_t pin, rt_base_t value);
+int rt_pin_read(rt_base_t pin);
+rt_err_t rt_pin_attach_irq(rt_int32_t pin, rt_uint32_t mode, void (*hdr)(void *args), void *args);
+rt_err_t rt_pin_detach_irq(rt_int32_t pin);
+rt_err_t rt_pin_irq_enable(rt_base_t pin, rt_uint32_t enabled);
+
+#define RT_SPI_CPHA     (1 << 0)
+#define RT_SPI_CPOL     (1 << 1)
+#define RT_SPI_LSB      (0 << 2)
+#define RT_SPI_MSB      (1 << 2)
+#define RT_SPI_MASTER   (0 << 3)
+#define RT_SPI_SLAVE    (1 << 3)
+#define RT_SPI_3WIRE    (1 << 4)
+#define RT_SPI_MODE_0   (0 | 0)
+
+struct rt_spi_message
+{
+    const void *send_buf;
+    void *recv_buf;
+    rt_size_t length;
+    struct rt_spi_message *next;
+
+    unsigned cs_take    : 1;
+    unsigned cs_release : 1;
+};
+
+struct rt_spi_configuration
+{
+    rt_uint8_t mode;
+    rt_uint8_t data_width;
+    rt_uint16_t reserved;
+    rt_uint32_t max_hz;
+};
+
+struct rt_spi_bus
+{
+    struct rt_device parent;
+    struct rt_spi_device *owner;
+};
+
+struct rt_spi_device
+{
+    struct rt_device parent;
+    struct rt_spi_bus *bus;
+    struct rt_spi_configuration config;
+    void *user_data;
+};
+
+rt_err_t rt_spi_configure(struct rt_spi_device *device, struct rt_spi_configuration *cfg);
+rt_size_t rt_spi_transfer(struct rt_spi_device *device, const void *send_buf, void *recv_buf, rt_size_t length);
+struct rt_spi_message *rt_spi_transfer_message(struct rt_spi_device *device, struct rt_spi_message *message);
+rt_err_t rt_spi_take_bus(struct rt_spi_device *device);
+rt_err_t rt_spi_release_bus(struct rt_spi_device *device);
+rt_err_t rt_spi_take(struct rt_spi_device *device);
+rt_err_t rt_spi_release(struct rt_spi_device *device);
+
+rt_inline rt_size_t rt_spi_recv(struct rt_spi_device *device, void *recv_buf, rt_size_t length)
+{
+    return rt_spi_transfer(device, RT_NULL, recv_buf, length);
+}
+
+rt_inline rt_size_t rt_spi_send(struct rt_spi_device *device, const void *send_buf, rt_size_t length)
+{
+    return rt_spi_transfer(device, send_buf, RT_NULL, length);
+}
+
+struct rt_device_pwm
+{
+    struct rt_device parent;
+};
+
+rt_err_t rt_pwm_enable(struct rt_device_pwm *device, int channel);
+rt_err_t rt_pwm_disable(struct rt_device_pwm *device, int channel);
+rt_err_t rt_pwm_set(struct rt_device_pwm *device, int channel, rt_uint32_t period, rt_uint32_t pulse);
+
+enum
+{
+    RTGRAPHIC_CTRL_RECT_UPDATE = 0,
+    RTGRAPHIC_CTRL_POWERON,
+    RTGRAPHIC_CTRL_POWEROFF,
+    RTGRAPHIC_CTRL_GET_INFO,
+    RTGRAPHIC_CTRL_SET_MODE,
+    RTGRAPHIC_CTRL_GET_EXT,
+};
+
+enum
+{
+    RTGRAPHIC_PIXEL_FORMAT_MONO = 0,
+    RTGRAPHIC_PIXEL_FORMAT_GRAY4,
+    RTGRAPHIC_PIXEL_FORMAT_GRAY16,
+    RTGRAPHIC_PIXEL_FORMAT_RGB332,
+    RTGRAPHIC_PIXEL_FORMAT_RGB444,
+    RTGRAPHIC_PIXEL_FORMAT_RGB565,
+    RTGRAPHIC_PIXEL_FORMAT_RGB565P,
+    RTGRAPHIC_PIXEL_FORMAT_BGR565 = RTGRAPHIC_PIXEL_FORMAT_RGB565P,
+    RTGRAPHIC_PIXEL_FORMAT_RGB666,
+    RTGRAPHIC_PIXEL_FORMAT_RGB888,
+    RTGRAPHIC_PIXEL_FORMAT_ARGB888,
+    RTGRAPHIC_PIXEL_FORMAT_ABGR888,
+};
+
+struct rt_device_graphic_info
+{
+    rt_uint8_t pixel_format;
+    rt_uint8_t bits_per_pixel;
+    rt_uint16_t reserved;
+    rt_uint16_t width;
+    rt_uint16_t height;
+    rt_uint8_t *framebuffer;
+};
+
+struct rt_device_rect_info
+{
+    rt_uint16_t x;
+    rt_uint16_t y;
+    rt_uint16_t width;
+    rt_uint16_t height;
+};
+
+struct rt_device_graphic_ops
+{
+    void (*set_pixel) (const char *pixel, int x, int y);
+    void (*get_pixel) (char *pixel, int x, int y);
+    void (*draw_hline)(const char *pixel, int x1, int x2, int y);
+    void (*draw_vline)(const char *pixel, int x, int y1, int y2);
+    void (*blit_line) (const char *pixel, int x, int y, rt_size_t size);
+};
+
+#define rt_graphix_ops(device) ((struct rt_device_graphic_ops *)(device->user_data))
+
+#endif /* __RT_DEVICE_H__ */
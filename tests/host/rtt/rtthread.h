@@ -0,0 +1,217 @@
+/*
+ * Host stand-in for the parts of rtthread.h used by the st7735r package.
+ * Only the declarations the driver needs, implemented in sim_rtt.c.
+ */
+
+#ifndef __RTTHREAD_H__
+#define __RTTHREAD_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <rtconfig.h>
+
+typedef int8_t      rt_int8_t;
+typedef int16_t     rt_int16_t;
+typedef int32_t     rt_int32_t;
+typedef int64_t     rt_int64_t;
+typedef uint8_t     rt_uint8_t;
+typedef uint16_t    rt_uint16_t;
+typedef uint32_t    rt_uint32_t;
+typedef uint64_t    rt_uint64_t;
+typedef int         rt_bool_t;
+typedef long        rt_base_t;
+typedef unsigned long rt_ubase_t;
+typedef rt_base_t   rt_err_t;
+typedef rt_uint32_t rt_tick_t;
+typedef rt_ubase_t  rt_size_t;
+typedef rt_base_t   rt_off_t;
+
+#define RT_TRUE     1
+#define RT_FALSE    0
+#define RT_NULL     ((void *)0)
+
+#define RT_EOK      0
+#define RT_ERROR    1
+#define RT_ETIMEOUT 2
+#define RT_EFULL    3
+#define RT_EEMPTY   4
+#define RT_ENOMEM   5
+#define RT_ENOSYS   6
+#define RT_EBUSY    7
+#define RT_EIO      8
+#define RT_EINTR    9
+#define RT_EINVAL   10
+
+#define RT_NAME_MAX         8
+#define RT_ALIGN_SIZE       4
+#define RT_TICK_PER_SECOND  1000
+#define RT_WAITING_FOREVER  -1
+#define RT_WAITING_NO       0
+
+#define RT_ALIGN(size, align)   (((size) + (align) - 1) & ~((align) - 1))
+#define RT_UNUSED(x)            ((void)x)
+#define RT_ASSERT(x)            do { if (!(x)) rt_assert_handler(#x, __func__, __LINE__); } while (0)
+#define rt_inline               static __inline
+
+#define RT_IPC_FLAG_FIFO        0x00
+#define RT_IPC_FLAG_PRIO        0x01
+
+#define RT_EVENT_FLAG_AND       0x01
+#define RT_EVENT_FLAG_OR        0x02
+#define RT_EVENT_FLAG_CLEAR     0x04
+
+#define RT_DEVICE_FLAG_DEACTIVATE   0x000
+#define RT_DEVICE_FLAG_RDONLY       0x001
+#define RT_DEVICE_FLAG_WRONLY       0x002
+#define RT_DEVICE_FLAG_RDWR         0x003
+#define RT_DEVICE_FLAG_ACTIVATED    0x010
+#define RT_DEVICE_FLAG_INT_TX       0x400
+#define RT_DEVICE_FLAG_DMA_TX       0x800
+#define RT_DEVICE_OFLAG_RDWR        0x003
+
+struct rt_object
+{
+    char name[RT_NAME_MAX];
+};
+
+enum rt_device_class_type
+{
+    RT_Device_Class_Char = 0,
+    RT_Device_Class_Graphic,
+    RT_Device_Class_SPIDevice,
+};
+
+typedef struct rt_device *rt_device_t;
+
+struct rt_device_ops
+{
+    rt_err_t  (*init)   (rt_device_t dev);
+    rt_err_t  (*open)   (rt_device_t dev, rt_uint16_t oflag);
+    rt_err_t  (*close)  (rt_device_t dev);
+    rt_size_t (*read)   (rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size);
+    rt_size_t (*write)  (rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size);
+    rt_err_t  (*control)(rt_device_t dev, int cmd, void *args);
+};
+
+struct rt_device
+{
+    struct rt_object parent;
+    enum rt_device_class_type type;
+    rt_uint16_t flag;
+    rt_uint16_t open_flag;
+    rt_uint8_t ref_count;
+    rt_uint8_t device_id;
+
+    rt_err_t (*rx_indicate)(rt_device_t dev, rt_size_t size);
+    rt_err_t (*tx_complete)(rt_device_t dev, void *buffer);
+
+#ifdef RT_USING_DEVICE_OPS
+    const struct rt_device_ops *ops;
+#else
+    rt_err_t  (*init)   (rt_device_t dev);
+    rt_err_t  (*open)   (rt_device_t dev, rt_uint16_t oflag);
+    rt_err_t  (*close)  (rt_device_t dev);
+    rt_size_t (*read)   (rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size);
+    rt_size_t (*write)  (rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size);
+    rt_err_t  (*control)(rt_device_t dev, int cmd, void *args);
+#endif
+
+    void *user_data;
+};
+
+/* every IPC object keeps its host implementation behind impl */
+struct rt_ipc_object
+{
+    struct rt_object parent;
+    void *impl;
+};
+
+struct rt_semaphore { struct rt_ipc_object parent; };
+struct rt_mutex { struct rt_ipc_object parent; };
+struct rt_event { struct rt_ipc_object parent; };
+struct rt_mailbox { struct rt_ipc_object parent; };
+struct rt_messagequeue { struct rt_ipc_object parent; };
+struct rt_thread { struct rt_object parent; void *impl; };
+
+typedef struct rt_semaphore *rt_sem_t;
+typedef struct rt_mutex *rt_mutex_t;
+typedef struct rt_event *rt_event_t;
+typedef struct rt_mailbox *rt_mailbox_t;
+typedef struct rt_messagequeue *rt_mq_t;
+typedef struct rt_thread *rt_thread_t;
+
+rt_err_t rt_sem_init(rt_sem_t sem, const char *name, rt_uint32_t value, rt_uint8_t flag);
+rt_err_t rt_sem_detach(rt_sem_t sem);
+rt_err_t rt_sem_take(rt_sem_t sem, rt_int32_t time);
+rt_err_t rt_sem_release(rt_sem_t sem);
+
+rt_err_t rt_mutex_init(rt_mutex_t mutex, const char *name, rt_uint8_t flag);
+rt_err_t rt_mutex_detach(rt_mutex_t mutex);
+rt_err_t rt_mutex_take(rt_mutex_t mutex, rt_int32_t time);
+rt_err_t rt_mutex_release(rt_mutex_t mutex);
+
+rt_err_t rt_event_init(rt_event_t event, const char *name, rt_uint8_t flag);
+rt_err_t rt_event_detach(rt_event_t event);
+rt_err_t rt_event_send(rt_event_t event, rt_uint32_t set);
+rt_err_t rt_event_recv(rt_event_t event, rt_uint32_t set, rt_uint8_t opt, rt_int32_t timeout, rt_uint32_t *recved);
+
+rt_err_t rt_mb_init(rt_mailbox_t mb, const char *name, void *msgpool, rt_size_t size, rt_uint8_t flag);
+rt_err_t rt_mb_detach(rt_mailbox_t mb);
+rt_err_t rt_mb_send(rt_mailbox_t mb, rt_ubase_t value);
+rt_err_t rt_mb_send_wait(rt_mailbox_t mb, rt_ubase_t value, rt_int32_t timeout);
+rt_err_t rt_mb_recv(rt_mailbox_t mb, rt_ubase_t *value, rt_int32_t timeout);
+
+rt_err_t rt_mq_init(rt_mq_t mq, const char *name, void *msgpool, rt_size_t msg_size, rt_size_t pool_size, rt_uint8_t flag);
+rt_err_t rt_mq_detach(rt_mq_t mq);
+rt_err_t rt_mq_send(rt_mq_t mq, const void *buffer, rt_size_t size);
+rt_err_t rt_mq_send_wait(rt_mq_t mq, const void *buffer, rt_size_t size, rt_int32_t timeout);
+rt_err_t rt_mq_recv(rt_mq_t mq, void *buffer, rt_size_t size, rt_int32_t timeout);
+
+rt_thread_t rt_thread_create(const char *name, void (*entry)(void *parameter), void *parameter,
+                             rt_uint32_t stack_size, rt_uint8_t priority, rt_uint32_t tick);
+rt_err_t rt_thread_delete(rt_thread_t thread);
+rt_err_t rt_thread_startup(rt_thread_t thread);
+rt_err_t rt_thread_mdelay(rt_int32_t ms);
+rt_err_t rt_thread_delay(rt_tick_t tick);
+
+rt_tick_t rt_tick_get(void);
+rt_tick_t rt_tick_from_millisecond(rt_int32_t ms);
+
+void *rt_malloc(rt_size_t size);
+void *rt_calloc(rt_size_t count, rt_size_t size);
+void rt_free(void *ptr);
+
+void *rt_memset(void *s, int c, rt_ubase_t count);
+void *rt_memcpy(void *dst, const void *src, rt_ubase_t count);
+void *rt_memmove(void *dest, const void *src, rt_ubase_t n);
+rt_int32_t rt_memcmp(const void *cs, const void *ct, rt_ubase_t count);
+rt_int32_t rt_strcmp(const char *cs, const char *ct);
+rt_size_t rt_strlen(const char *src);
+rt_int32_t rt_sprintf(char *buf, const char *format, ...);
+rt_int32_t rt_snprintf(char *buf, rt_size_t size, const char *format, ...);
+void rt_kprintf(const char *fmt, ...);
+void rt_assert_handler(const char *ex, const char *func, rt_size_t line);
+
+rt_device_t rt_device_find(const char *name);
+rt_err_t rt_device_register(rt_device_t dev, const char *name, rt_uint16_t flags);
+rt_err_t rt_device_unregister(rt_device_t dev);
+void rt_device_destroy(rt_device_t device);
+rt_err_t rt_device_open(rt_device_t dev, rt_uint16_t oflag);
+rt_err_t rt_device_close(rt_device_t dev);
+rt_size_t rt_device_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size);
+rt_size_t rt_device_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size);
+rt_err_t rt_device_control(rt_device_t dev, int cmd, void *arg);
+rt_err_t rt_device_set_tx_complete(rt_device_t dev, rt_err_t (*tx_done)(rt_device_t dev, void *buffer));
+
+int atoi(const char *nptr);
+
+/*
+ * Auto-init and msh exports become plain pointers, so a test can run
+ * st7735r_hw_init or call lcdstat by name.
+ */
+#define INIT_DEVICE_EXPORT(fn)                  int (*__rt_init_##fn)(void) = fn
+#define INIT_APP_EXPORT(fn)                     int (*__rt_init_##fn)(void) = fn
+#define MSH_CMD_EXPORT(cmd, desc)               void (*__msh_##cmd)(int, char **) = (void (*)(int, char **))cmd
+#define MSH_CMD_EXPORT_ALIAS(cmd, alias, desc)  void (*__msh_##alias)(int, char **) = (void (*)(int, char **))cmd
+
+#endif /* __RTTHREAD_H__ */
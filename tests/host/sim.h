@@ -0,0 +1,113 @@
+/*
+ * Host simulator for the st7735r package.
+ *
+ * sim_rtt.c stands in for the RT-Thread kernel, device framework, pins and
+ * SPI bus, so drv_st7735r.c builds and runs unchanged on Linux. Every SPI
+ * transfer is passed to the panel model in sim_panel.c, which decodes the
+ * command/data stream (by the level of the dc pin) into a virtual GRAM and
+ * answers RAMRD and RDDID.
+ */
+
+#ifndef __SIM_H__
+#define __SIM_H__
+
+#include <rtthread.h>
+#include <rtdevice.h>
+
+#define SIM_PANELS      2
+#define SIM_GRAM_WIDTH  132
+#define SIM_GRAM_HEIGHT 162
+
+/* one run of writes of the same color to a GRAM row, for the scan model */
+struct sim_run
+{
+	rt_uint16_t color;
+	double t0, t1;
+};
+
+struct sim_panel
+{
+	/* set by the test */
+	rt_base_t dc_pin;
+	rt_base_t te_pin;
+	int gram_width;             /* 132x162 for GM=011, 128x160 for GM=000 */
+	int gram_height;
+	int rd_dummy;               /* dummy clocks before the first RAMRD bit */
+	int latency_us;             /* fixed cost of every transfer */
+	int wire;                   /* sleep for the time the bytes take at hz */
+	rt_uint32_t err_hz;         /* above this clock ... */
+	rt_uint32_t err_every;      /* ... flip one bit every err_every bytes */
+	int scan_phase_us;          /* scan start relative to the FRMCTR1 write */
+
+	/* counters, cleared by sim_reset_counters */
+	unsigned long transfers;
+	unsigned long bytes;
+	unsigned long dc_toggles;
+	unsigned long pin_writes;
+	unsigned long cmds;
+	unsigned long pixels;
+	unsigned long caset, raset, ramwr;
+	unsigned long bus_takes;
+	unsigned long bus_holds;    /* outermost rt_spi_take_bus calls */
+	unsigned long cmd_hist[256];
+	unsigned long err_count;
+	double model_us;            /* cpu time spent decoding in this model */
+
+	/* controller state */
+	rt_uint32_t hz;
+	int dc_level;
+	int madctl, colmod;
+	int xs, xe, ys, ye;
+	int tfa, vsa, bfa, vsp;
+	int te_on;
+	rt_uint8_t frmctr[3];
+	rt_uint16_t gram[SIM_GRAM_HEIGHT][SIM_GRAM_WIDTH];
+
+	/* decoder state */
+	int cmd, nparam;
+	rt_uint8_t params[16];
+	rt_uint8_t acc[3];
+	int nacc;
+	int wx, wy;
+	int rd_phase, rd_bits, rd_byte;
+	rt_uint16_t rd_color;
+	unsigned long err_n;
+
+	/* scan model */
+	double scan_origin;
+	double xfer_t0;
+	rt_size_t xfer_i;
+	int hist_on;
+	struct sim_run *hist[SIM_GRAM_HEIGHT];
+	int hist_len[SIM_GRAM_HEIGHT], hist_cap[SIM_GRAM_HEIGHT];
+	int te_started;
+};
+
+extern struct sim_panel sim_panels[SIM_PANELS];
+
+/* the panel of the first spi device attached, lcd0 */
+#define sim (sim_panels[0])
+
+/* sim_rtt.c */
+extern int sim_real_delay;              /* rt_thread_mdelay really sleeps */
+extern unsigned long sim_delay_ms;      /* total of all rt_thread_mdelay calls */
+extern int sim_thread_fail;             /* the n-th next rt_thread_create fails, 0 never */
+extern int sim_ipc_live;                /* IPC objects initialised and not detached */
+extern int sim_threads_idle;            /* threads created, neither started nor deleted */
+double sim_now_us(void);
+double sim_cpu_us(void);                /* cpu time of the calling thread */
+void sim_sleep_until(double us);
+int sim_pin_level(rt_base_t pin);
+void sim_pin_irq(rt_base_t pin);
+
+/* sim_panel.c */
+void sim_spi_byte(struct sim_panel *p, const rt_uint8_t *tx, rt_uint8_t *rx);
+void sim_reset_counters(struct sim_panel *p);
+rt_uint16_t sim_pixel(struct sim_panel *p, int x, int y);
+int sim_dump_ppm(struct sim_panel *p, const char *path);
+int sim_dump_png(struct sim_panel *p, const char *path);
+void sim_scan_timing(struct sim_panel *p, double *line_us, int *porch, int *lines);
+void sim_hist_reset(struct sim_panel *p);
+int sim_torn(struct sim_panel *p, int *refreshes);
+
+#endif /* __SIM_H__ */
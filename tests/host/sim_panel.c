@@ -0,0 +1,563 @@
+/*
+ * ST7735R model for the host simulator.
+ *
+ * Bytes sent with dc low are commands and bytes sent with dc high are
+ * their parameters. CASET/RASET/MADCTL/COLMOD/RAMWR/RAMRD/RDDID and the
+ * scrolling, TE and frame rate registers are decoded, everything else is
+ * only counted. Pixels go through MADCTL into a GRAM of gram_width x
+ * gram_height, 132x162 or 128x160 depending on the GM pins of the module.
+ *
+ * The scan model refreshes the panel rows from the GRAM at the rate set by
+ * FRMCTR1, raises TE at the start of every frame after TEON, and with the
+ * write history on it counts refreshes that show parts of two frames.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "sim.h"
+
+#define SIM_PANEL_DEFAULT                       \
+	{                                           \
+		.dc_pin = 3,                            \
+		.te_pin = 5,                            \
+		.gram_width = SIM_GRAM_WIDTH,           \
+		.gram_height = SIM_GRAM_HEIGHT,         \
+		.rd_dummy = 8,                          \
+		.colmod = 6,                            \
+		.xe = SIM_GRAM_WIDTH - 1,               \
+		.ye = SIM_GRAM_HEIGHT - 1,              \
+	}
+
+struct sim_panel sim_panels[SIM_PANELS] = {SIM_PANEL_DEFAULT, SIM_PANEL_DEFAULT};
+
+static const rt_uint8_t sim_id[3] = {0x7C, 0x89, 0xF0};
+
+/* logical (x, y) under MADCTL to the GRAM cell, RT_FALSE outside the GRAM */
+static rt_bool_t sim_map(struct sim_panel *p, int x, int y, int *gx, int *gy)
+{
+	int cx = p->madctl & 0x20 ? y : x, cy = p->madctl & 0x20 ? x : y;
+
+	if (p->madctl & 0x40)
+		cx = p->gram_width - 1 - cx;
+	if (p->madctl & 0x80)
+		cy = p->gram_height - 1 - cy;
+	*gx = cx;
+	*gy = cy;
+	return cx >= 0 && cx < p->gram_width && cy >= 0 && cy < p->gram_height;
+}
+
+static void sim_hist_put(struct sim_panel *p, int gy, rt_uint16_t color)
+{
+	double t = p->xfer_t0 + (p->hz ? p->xfer_i * 8e6 / p->hz : 0);
+	struct sim_run *run;
+
+	if (p->hist_len[gy])
+	{
+		run = &p->hist[gy][p->hist_len[gy] - 1];
+		if (run->color == color)
+		{
+			run->t1 = t;
+			return;
+		}
+	}
+	if (p->hist_len[gy] == p->hist_cap[gy])
+	{
+		p->hist_cap[gy] = p->hist_cap[gy] ? p->hist_cap[gy] * 2 : 64;
+		p->hist[gy] = realloc(p->hist[gy], p->hist_cap[gy] * sizeof(struct sim_run));
+	}
+	run = &p->hist[gy][p->hist_len[gy]++];
+	run->color = color;
+	run->t0 = run->t1 = t;
+}
+
+static void sim_step(struct sim_panel *p)
+{
+	if (++p->wx > p->xe)
+	{
+		p->wx = p->xs;
+		if (++p->wy > p->ye)
+			p->wy = p->ys;
+	}
+}
+
+static void sim_write_pixel(struct sim_panel *p, rt_uint16_t color)
+{
+	int gx, gy;
+
+	if (sim_map(p, p->wx, p->wy, &gx, &gy))
+	{
+		p->gram[gy][gx] = color;
+		if (p->hist_on)
+			sim_hist_put(p, gy, color);
+	}
+	p->pixels++;
+	sim_step(p);
+}
+
+static rt_uint16_t sim_from444(unsigned c)
+{
+	unsigned r = c >> 8, g = (c >> 4) & 0xF, b = c & 0xF;
+
+	return ((r << 1 | r >> 3) << 11) | ((g << 2 | g >> 2) << 5) | (b << 1 | b >> 3);
+}
+
+/* RAMWR data, 12-bit sends two pixels in three bytes */
+static void sim_ramwr_byte(struct sim_panel *p, rt_uint8_t b)
+{
+	p->acc[p->nacc++] = b;
+	switch (p->colmod)
+	{
+	case 3:
+		if (p->nacc == 2)
+			sim_write_pixel(p, sim_from444(p->acc[0] << 4 | p->acc[1] >> 4));
+		else if (p->nacc == 3)
+		{
+			sim_write_pixel(p, sim_from444((p->acc[1] & 0xF) << 8 | p->acc[2]));
+			p->nacc = 0;
+		}
+		break;
+	case 5:
+		if (p->nacc == 2)
+		{
+			sim_write_pixel(p, p->acc[0] << 8 | p->acc[1]);
+			p->nacc = 0;
+		}
+		break;
+	default:
+		if (p->nacc == 3)
+		{
+			sim_write_pixel(p, (p->acc[0] >> 3) << 11 | (p->acc[1] >> 2) << 5 | p->acc[2] >> 3);
+			p->nacc = 0;
+		}
+		break;
+	}
+}
+
+static void *sim_te_main(void *arg)
+{
+	struct sim_panel *p = arg;
+	double line, frame, next;
+	int porch, lines;
+
+	for (;;)
+	{
+		sim_scan_timing(p, &line, &porch, &lines);
+		frame = line * lines;
+		next = p->scan_origin + (floor((sim_now_us() - p->scan_origin) / frame) + 1) * frame;
+		sim_sleep_until(next);
+		if (p->te_on)
+			sim_pin_irq(p->te_pin);
+	}
+	return NULL;
+}
+
+static void sim_cmd(struct sim_panel *p, rt_uint8_t c)
+{
+	pthread_t tid;
+
+	p->cmd = c;
+	p->nparam = 0;
+	p->cmds++;
+	p->cmd_hist[c]++;
+	switch (c)
+	{
+	case 0x01: /* SWRESET */
+		p->madctl = 0;
+		p->colmod = 6;
+		p->xs = p->ys = 0;
+		p->xe = p->gram_width - 1;
+		p->ye = p->gram_height - 1;
+		p->te_on = 0;
+		p->tfa = p->vsa = p->bfa = p->vsp = 0;
+		break;
+	case 0x04: /* RDDID */
+		p->rd_phase = 0;
+		break;
+	case 0x13: /* NORON ends scrolling */
+		p->vsa = 0;
+		break;
+	case 0x2C: /* RAMWR */
+		p->wx = p->xs;
+		p->wy = p->ys;
+		p->nacc = 0;
+		p->ramwr++;
+		break;
+	case 0x2E: /* RAMRD */
+		p->wx = p->xs;
+		p->wy = p->ys;
+		p->rd_phase = 0;
+		p->rd_bits = 0;
+		break;
+	case 0x34: /* TEOFF */
+		p->te_on = 0;
+		break;
+	case 0x35: /* TEON */
+		p->te_on = 1;
+		if (!p->te_started && pthread_create(&tid, NULL, sim_te_main, p) == 0)
+		{
+			pthread_detach(tid);
+			p->te_started = 1;
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+static int sim_u16(const rt_uint8_t *b)
+{
+	return b[0] << 8 | b[1];
+}
+
+static void sim_param(struct sim_panel *p, rt_uint8_t b)
+{
+	if (p->cmd == 0x2C)
+	{
+		sim_ramwr_byte(p, b);
+		return;
+	}
+	if (p->nparam < (int)sizeof(p->params))
+		p->params[p->nparam] = b;
+	p->nparam++;
+	switch (p->cmd)
+	{
+	case 0x2A: /* CASET */
+		if (p->nparam == 4)
+		{
+			p->xs = sim_u16(p->params);
+			p->xe = sim_u16(p->params + 2);
+			p->caset++;
+		}
+		break;
+	case 0x2B: /* RASET */
+		if (p->nparam == 4)
+		{
+			p->ys = sim_u16(p->params);
+			p->ye = sim_u16(p->params + 2);
+			p->raset++;
+		}
+		break;
+	case 0x33: /* VSCRDEF */
+		if (p->nparam == 6)
+		{
+			p->tfa = sim_u16(p->params);
+			p->vsa = sim_u16(p->params + 2);
+			p->bfa = sim_u16(p->params + 4);
+		}
+		break;
+	case 0x36: /* MADCTL */
+		p->madctl = b;
+		break;
+	case 0x37: /* VSCRSADD */
+		if (p->nparam == 2)
+			p->vsp = sim_u16(p->params);
+		break;
+	case 0x3A: /* COLMOD */
+		p->colmod = b & 7;
+		break;
+	case 0xB1: /* FRMCTR1, the scan restarts with the new timing */
+		if (p->nparam <= 3)
+			p->frmctr[p->nparam - 1] = b;
+		if (p->nparam == 3)
+			p->scan_origin = sim_now_us() + p->scan_phase_us;
+		break;
+	default:
+		break;
+	}
+}
+
+/* one bit of RAMRD: rd_dummy clocks, then 6 bits of every color in the top of a byte */
+static int sim_ramrd_bit(struct sim_panel *p)
+{
+	int bit;
+
+	if (p->rd_phase < p->rd_dummy)
+	{
+		p->rd_phase++;
+		return 1;
+	}
+	if (p->rd_bits == 0)
+	{
+		int k = (p->rd_phase - p->rd_dummy) % 3;
+
+		if (k == 0)
+		{
+			p->rd_color = sim_pixel(p, p->wx, p->wy);
+			sim_step(p);
+		}
+		p->rd_byte = k == 0 ? (p->rd_color >> 11) << 3 : k == 1 ? ((p->rd_color >> 5) & 0x3F) << 2 : (p->rd_color & 0x1F) << 3;
+		p->rd_bits = 8;
+		p->rd_phase++;
+	}
+	bit = (p->rd_byte >> 7) & 1;
+	p->rd_byte <<= 1;
+	p->rd_bits--;
+	return bit;
+}
+
+static rt_uint8_t sim_read(struct sim_panel *p)
+{
+	rt_uint8_t b = 0;
+	int i;
+
+	if (p->cmd == 0x2E)
+	{
+		for (i = 0; i < 8; ++i)
+			b = b << 1 | sim_ramrd_bit(p);
+		return b;
+	}
+	if (p->cmd == 0x04)
+	{
+		i = p->rd_phase++;
+		return i < 3 ? sim_id[i] : 0;
+	}
+	return 0;
+}
+
+void sim_spi_byte(struct sim_panel *p, const rt_uint8_t *tx, rt_uint8_t *rx)
+{
+	if (tx)
+	{
+		rt_uint8_t b = *tx;
+
+		/* a marginal link above err_hz */
+		if (p->err_hz && p->hz > p->err_hz && ++p->err_n % (p->err_every ? p->err_every : 61) == 0)
+		{
+			b ^= 1 << (p->err_n % 8);
+			p->err_count++;
+		}
+		if (p->dc_level)
+			sim_param(p, b);
+		else
+			sim_cmd(p, b);
+	}
+	if (rx)
+		*rx = sim_read(p);
+}
+
+void sim_reset_counters(struct sim_panel *p)
+{
+	p->transfers = p->bytes = p->dc_toggles = p->pin_writes = 0;
+	p->cmds = p->pixels = p->caset = p->raset = p->ramwr = p->bus_takes = p->bus_holds = 0;
+	p->model_us = 0;
+	memset(p->cmd_hist, 0, sizeof(p->cmd_hist));
+}
+
+/* the GRAM cell at logical (x, y) under the current MADCTL */
+rt_uint16_t sim_pixel(struct sim_panel *p, int x, int y)
+{
+	int gx, gy;
+
+	return sim_map(p, x, y, &gx, &gy) ? p->gram[gy][gx] : 0;
+}
+
+static void sim_rgb888(rt_uint16_t c, rt_uint8_t *out)
+{
+	out[0] = (c >> 11) * 255 / 31;
+	out[1] = ((c >> 5) & 0x3F) * 255 / 63;
+	out[2] = (c & 0x1F) * 255 / 31;
+}
+
+/* the whole GRAM, row 0 at the top, as a binary PPM */
+int sim_dump_ppm(struct sim_panel *p, const char *path)
+{
+	FILE *f = fopen(path, "wb");
+	rt_uint8_t rgb[3];
+	int x, y;
+
+	if (f == NULL)
+		return -1;
+	fprintf(f, "P6\n%d %d\n255\n", p->gram_width, p->gram_height);
+	for (y = 0; y < p->gram_height; ++y)
+	{
+		for (x = 0; x < p->gram_width; ++x)
+		{
+			sim_rgb888(p->gram[y][x], rgb);
+			fwrite(rgb, 1, 3, f);
+		}
+	}
+	return fclose(f) == 0 ? 0 : -1;
+}
+
+static rt_uint32_t sim_crc(rt_uint32_t crc, const rt_uint8_t *buf, size_t len)
+{
+	size_t i;
+	int k;
+
+	crc = ~crc;
+	for (i = 0; i < len; ++i)
+	{
+		crc ^= buf[i];
+		for (k = 0; k < 8; ++k)
+			crc = crc >> 1 ^ (0xEDB88320u & -(crc & 1));
+	}
+	return ~crc;
+}
+
+static void sim_be32(rt_uint8_t *b, rt_uint32_t v)
+{
+	b[0] = v >> 24;
+	b[1] = v >> 16;
+	b[2] = v >> 8;
+	b[3] = v;
+}
+
+static void sim_png_chunk(FILE *f, const char *type, const rt_uint8_t *data, size_t len)
+{
+	rt_uint8_t b[4];
+	rt_uint32_t crc;
+
+	sim_be32(b, len);
+	fwrite(b, 1, 4, f);
+	fwrite(type, 1, 4, f);
+	fwrite(data, 1, len, f);
+	crc = sim_crc(sim_crc(0, (const rt_uint8_t *)type, 4), data, len);
+	sim_be32(b, crc);
+	fwrite(b, 1, 4, f);
+}
+
+/*
+ * The whole GRAM as an RGB PNG. The image data is a zlib stream of stored
+ * deflate blocks, one per row, so no compression library is needed.
+ */
+int sim_dump_png(struct sim_panel *p, const char *path)
+{
+	static const rt_uint8_t signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+	const size_t row = 1 + 3 * p->gram_width, block = 5 + row;
+	rt_uint8_t ihdr[13] = {0}, *idat, *out;
+	rt_uint32_t a = 1, b = 0;
+	size_t len = 2 + block * p->gram_height + 4, i;
+	FILE *f;
+	int x, y;
+
+	idat = malloc(len);
+	if (idat == NULL)
+		return -1;
+	out = idat;
+	*out++ = 0x78;
+	*out++ = 0x01;
+	for (y = 0; y < p->gram_height; ++y)
+	{
+		rt_uint8_t *data;
+
+		*out++ = y == p->gram_height - 1;
+		*out++ = row & 0xFF;
+		*out++ = row >> 8;
+		*out++ = ~row & 0xFF;
+		*out++ = (~row >> 8) & 0xFF;
+		data = out;
+		*out++ = 0;
+		for (x = 0; x < p->gram_width; ++x, out += 3)
+			sim_rgb888(p->gram[y][x], out);
+		for (i = 0; i < row; ++i)
+		{
+			a = (a + data[i]) % 65521;
+			b = (b + a) % 65521;
+		}
+	}
+	sim_be32(out, b << 16 | a);
+
+	f = fopen(path, "wb");
+	if (f == NULL)
+	{
+		free(idat);
+		return -1;
+	}
+	sim_be32(ihdr, p->gram_width);
+	sim_be32(ihdr + 4, p->gram_height);
+	ihdr[8] = 8;
+	ihdr[9] = 2;
+	fwrite(signature, 1, sizeof(signature), f);
+	sim_png_chunk(f, "IHDR", ihdr, sizeof(ihdr));
+	sim_png_chunk(f, "IDAT", idat, len);
+	sim_png_chunk(f, "IEND", RT_NULL, 0);
+	free(idat);
+	return fclose(f) == 0 ? 0 : -1;
+}
+
+/* datasheet frame timing: fosc 850 kHz, one line is RTNA*2+40 clocks */
+void sim_scan_timing(struct sim_panel *p, double *line_us, int *porch, int *lines)
+{
+	*line_us = (p->frmctr[0] * 2 + 40) / 0.85;
+	*porch = p->frmctr[1] + p->frmctr[2] + 2;
+	*lines = 160 + *porch;
+}
+
+void sim_hist_reset(struct sim_panel *p)
+{
+	memset(p->hist_len, 0, sizeof(p->hist_len));
+	p->hist_on = 1;
+}
+
+/* GRAM row refreshed by scan line r, ML reverses the order */
+static int sim_scan_row(struct sim_panel *p, int r)
+{
+	int off = (p->gram_height - 160) / 2;
+
+	return p->madctl & 0x10 ? off + 159 - r : off + r;
+}
+
+/* the color of a row at time t, -1 while a run is being written, -2 before any */
+static int sim_row_at(struct sim_panel *p, int gy, double t)
+{
+	int i, k = -1;
+
+	for (i = 0; i < p->hist_len[gy] && p->hist[gy][i].t0 <= t; ++i)
+		k = i;
+	if (k < 0)
+		return -2;
+	return p->hist[gy][k].t1 > t ? -1 : p->hist[gy][k].color;
+}
+
+/*
+ * Refreshes between the first and the last recorded write that showed
+ * more than one frame, with every frame written in a single color.
+ */
+int sim_torn(struct sim_panel *p, int *refreshes)
+{
+	double line, frame, first = 1e300, last = 0;
+	int porch, lines, r, torn = 0, n = 0;
+	long k, k0, k1;
+
+	sim_scan_timing(p, &line, &porch, &lines);
+	frame = line * lines;
+	for (r = 0; r < 160; ++r)
+	{
+		int gy = sim_scan_row(p, r);
+
+		if (p->hist_len[gy] == 0)
+			continue;
+		if (p->hist[gy][0].t0 < first)
+			first = p->hist[gy][0].t0;
+		if (p->hist[gy][p->hist_len[gy] - 1].t1 > last)
+			last = p->hist[gy][p->hist_len[gy] - 1].t1;
+	}
+	k0 = (long)((first - p->scan_origin) / frame);
+	k1 = (long)((last - p->scan_origin) / frame) + 1;
+	for (k = k0; k <= k1; ++k)
+	{
+		double start = p->scan_origin + k * frame;
+		int seen = -3, bad = 0;
+
+		for (r = 0; r < 160 && !bad; ++r)
+		{
+			int gy = sim_scan_row(p, r), v;
+
+			if (p->hist_len[gy] == 0)
+				continue;
+			v = sim_row_at(p, gy, start + (porch + r) * line);
+			if (v == -2)
+				continue;
+			bad = v == -1 || (seen != -3 && v != seen);
+			seen = v;
+		}
+		n++;
+		torn += bad;
+	}
+	*refreshes = n;
+	return torn;
+}
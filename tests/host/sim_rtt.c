@@ -0,0 +1,879 @@
+/*
+ * RT-Thread stand-ins for the host simulator.
+ *
+ * Threads are pthreads and every IPC object waits on one condition
+ * variable, which is slow but simple and keeps the RT-Thread semantics the
+ * driver relies on: recursive mutexes, counting semaphores, events with
+ * AND/OR/CLEAR, fixed size message queues and mailboxes with timeouts.
+ *
+ * SPI transfers run in the calling thread, so the async pipeline really
+ * overlaps staging with transfers. Each one costs latency_us, and with
+ * wire set it also takes as long as its bytes need at the configured clock.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <drv_spi.h>
+#include "sim.h"
+
+#define SIM_PINS    256
+#define SIM_DEVICES 16
+
+int sim_real_delay;
+unsigned long sim_delay_ms;
+int sim_thread_fail;
+int sim_ipc_live;
+int sim_threads_idle;
+
+/* time */
+
+double sim_now_us(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+double sim_cpu_us(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+	return t.tv_sec * 1e6 + t.tv_nsec / 1e3;
+}
+
+void sim_sleep_until(double us)
+{
+	struct timespec t;
+
+	t.tv_sec = (time_t)(us / 1e6);
+	t.tv_nsec = (long)((us - t.tv_sec * 1e6) * 1e3);
+	while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &t, NULL) == EINTR)
+		;
+}
+
+rt_tick_t rt_tick_get(void)
+{
+	static double start;
+
+	if (start == 0)
+		start = sim_now_us();
+	return (rt_tick_t)((sim_now_us() - start) / 1000);
+}
+
+rt_tick_t rt_tick_from_millisecond(rt_int32_t ms)
+{
+	return ms;
+}
+
+rt_err_t rt_thread_mdelay(rt_int32_t ms)
+{
+	__atomic_fetch_add(&sim_delay_ms, ms, __ATOMIC_RELAXED);
+	if (sim_real_delay)
+		usleep(ms * 1000);
+	return RT_EOK;
+}
+
+rt_err_t rt_thread_delay(rt_tick_t tick)
+{
+	return rt_thread_mdelay(tick);
+}
+
+/* pins */
+
+static int pin_level[SIM_PINS];
+static void (*pin_hdr[SIM_PINS])(void *args);
+static void *pin_args[SIM_PINS];
+static int pin_irq_on[SIM_PINS];
+
+void rt_pin_mode(rt_base_t pin, rt_base_t mode)
+{
+	(void)pin;
+	(void)mode;
+}
+
+void rt_pin_write(rt_base_t pin, rt_base_t value)
+{
+	int i;
+
+	for (i = 0; i < SIM_PANELS; ++i)
+	{
+		if (sim_panels[i].dc_pin == pin && pin_level[pin] != value)
+			sim_panels[i].dc_toggles++;
+		sim_panels[i].pin_writes++;
+	}
+	pin_level[pin] = value;
+}
+
+int rt_pin_read(rt_base_t pin)
+{
+	return pin_level[pin];
+}
+
+int sim_pin_level(rt_base_t pin)
+{
+	return pin_level[pin];
+}
+
+rt_err_t rt_pin_attach_irq(rt_int32_t pin, rt_uint32_t mode, void (*hdr)(void *args), void *args)
+{
+	(void)mode;
+	pin_hdr[pin] = hdr;
+	pin_args[pin] = args;
+	return RT_EOK;
+}
+
+rt_err_t rt_pin_detach_irq(rt_int32_t pin)
+{
+	pin_hdr[pin] = RT_NULL;
+	pin_irq_on[pin] = 0;
+	return RT_EOK;
+}
+
+rt_err_t rt_pin_irq_enable(rt_base_t pin, rt_uint32_t enabled)
+{
+	pin_irq_on[pin] = enabled == PIN_IRQ_ENABLE;
+	return RT_EOK;
+}
+
+/* called on an edge of the pin, e.g. TE from the scan model */
+void sim_pin_irq(rt_base_t pin)
+{
+	if (pin_irq_on[pin] && pin_hdr[pin])
+		pin_hdr[pin](pin_args[pin]);
+}
+
+rt_err_t rt_pwm_enable(struct rt_device_pwm *device, int channel)
+{
+	(void)device;
+	(void)channel;
+	return RT_EOK;
+}
+
+rt_err_t rt_pwm_disable(struct rt_device_pwm *device, int channel)
+{
+	(void)device;
+	(void)channel;
+	return RT_EOK;
+}
+
+rt_err_t rt_pwm_set(struct rt_device_pwm *device, int channel, rt_uint32_t period, rt_uint32_t pulse)
+{
+	(void)device;
+	(void)channel;
+	(void)period;
+	(void)pulse;
+	return RT_EOK;
+}
+
+/* spi: all devices share one bus, the n-th device attached drives sim_panels[n] */
+
+static pthread_mutex_t spi_bus = PTHREAD_RECURSIVE_MUTEX_INITIALIZER_NP;
+static int spi_attached;
+/* nesting of rt_spi_take_bus, only changed by the holder */
+static int spi_depth;
+
+static struct sim_panel *spi_panel(struct rt_spi_device *device)
+{
+	return &sim_panels[(long)device->user_data];
+}
+
+rt_err_t rt_hw_spi_device_attach(const char *bus_name, const char *device_name, rt_base_t cs_pin)
+{
+	struct rt_spi_device *device;
+
+	(void)bus_name;
+	(void)cs_pin;
+	if (spi_attached == SIM_PANELS)
+		return -RT_ERROR;
+	device = calloc(1, sizeof(*device));
+	device->user_data = (void *)(long)spi_attached++;
+	device->parent.type = RT_Device_Class_SPIDevice;
+	return rt_device_register(&device->parent, device_name, RT_DEVICE_FLAG_RDWR);
+}
+
+rt_err_t rt_spi_configure(struct rt_spi_device *device, struct rt_spi_configuration *cfg)
+{
+	device->config = *cfg;
+	spi_panel(device)->hz = cfg->max_hz;
+	return RT_EOK;
+}
+
+rt_size_t rt_spi_transfer(struct rt_spi_device *device, const void *send_buf, void *recv_buf, rt_size_t length)
+{
+	struct sim_panel *p = spi_panel(device);
+	const rt_uint8_t *tx = send_buf;
+	rt_uint8_t *rx = recv_buf;
+	rt_size_t i;
+	double cpu;
+
+	pthread_mutex_lock(&spi_bus);
+	cpu = sim_cpu_us();
+	p->transfers++;
+	p->bytes += length;
+	p->dc_level = pin_level[p->dc_pin];
+	p->xfer_t0 = sim_now_us();
+	for (i = 0; i < length; ++i)
+	{
+		p->xfer_i = i;
+		sim_spi_byte(p, tx ? tx + i : RT_NULL, rx ? rx + i : RT_NULL);
+	}
+	p->model_us += sim_cpu_us() - cpu;
+	if (p->latency_us)
+		usleep(p->latency_us);
+	if (p->wire && p->hz)
+		sim_sleep_until(p->xfer_t0 + length * 8e6 / p->hz);
+	pthread_mutex_unlock(&spi_bus);
+	return length;
+}
+
+struct rt_spi_message *rt_spi_transfer_message(struct rt_spi_device *device, struct rt_spi_message *message)
+{
+	for (; message; message = message->next)
+		rt_spi_transfer(device, message->send_buf, message->recv_buf, message->length);
+	return RT_NULL;
+}
+
+rt_err_t rt_spi_take_bus(struct rt_spi_device *device)
+{
+	pthread_mutex_lock(&spi_bus);
+	spi_panel(device)->bus_takes++;
+	if (spi_depth++ == 0)
+		spi_panel(device)->bus_holds++;
+	return RT_EOK;
+}
+
+rt_err_t rt_spi_release_bus(struct rt_spi_device *device)
+{
+	(void)device;
+	spi_depth--;
+	pthread_mutex_unlock(&spi_bus);
+	return RT_EOK;
+}
+
+rt_err_t rt_spi_take(struct rt_spi_device *device)
+{
+	(void)device;
+	return RT_EOK;
+}
+
+rt_err_t rt_spi_release(struct rt_spi_device *device)
+{
+	(void)device;
+	return RT_EOK;
+}
+
+/* device framework */
+
+static rt_device_t devices[SIM_DEVICES];
+static int device_count;
+
+#ifdef RT_USING_DEVICE_OPS
+#define device_ops(dev) ((dev)->ops)
+#else
+#define device_ops(dev) (dev)
+#endif
+
+rt_device_t rt_device_find(const char *name)
+{
+	int i;
+
+	for (i = 0; i < device_count; ++i)
+		if (strncmp(devices[i]->parent.name, name, RT_NAME_MAX) == 0)
+			return devices[i];
+	return RT_NULL;
+}
+
+rt_err_t rt_device_register(rt_device_t dev, const char *name, rt_uint16_t flags)
+{
+	if (device_count == SIM_DEVICES || rt_device_find(name))
+		return -RT_ERROR;
+	strncpy(dev->parent.name, name, RT_NAME_MAX - 1);
+	dev->flag = flags;
+	dev->ref_count = 0;
+	dev->open_flag = 0;
+	devices[device_count++] = dev;
+	return RT_EOK;
+}
+
+rt_err_t rt_device_unregister(rt_device_t dev)
+{
+	int i;
+
+	for (i = 0; i < device_count; ++i)
+	{
+		if (devices[i] == dev)
+		{
+			devices[i] = devices[--device_count];
+			return RT_EOK;
+		}
+	}
+	return -RT_ERROR;
+}
+
+void rt_device_destroy(rt_device_t device)
+{
+	(void)device;
+}
+
+rt_err_t rt_device_open(rt_device_t dev, rt_uint16_t oflag)
+{
+	rt_err_t result;
+
+	if (!(dev->flag & RT_DEVICE_FLAG_ACTIVATED))
+	{
+		if (device_ops(dev)->init && (result = device_ops(dev)->init(dev)) != RT_EOK)
+			return result;
+		dev->flag |= RT_DEVICE_FLAG_ACTIVATED;
+	}
+	if (dev->ref_count == 0)
+	{
+		if (device_ops(dev)->open && (result = device_ops(dev)->open(dev, oflag)) != RT_EOK)
+			return result;
+		dev->open_flag = oflag;
+	}
+	dev->ref_count++;
+	return RT_EOK;
+}
+
+rt_err_t rt_device_close(rt_device_t dev)
+{
+	if (dev->ref_count == 0)
+		return -RT_ERROR;
+	dev->ref_count--;
+	if (dev->ref_count)
+		return RT_EOK;
+	dev->open_flag = 0;
+	return device_ops(dev)->close ? device_ops(dev)->close(dev) : RT_EOK;
+}
+
+rt_size_t rt_device_read(rt_device_t dev, rt_off_t pos, void *buffer, rt_size_t size)
+{
+	return device_ops(dev)->read ? device_ops(dev)->read(dev, pos, buffer, size) : 0;
+}
+
+rt_size_t rt_device_write(rt_device_t dev, rt_off_t pos, const void *buffer, rt_size_t size)
+{
+	return device_ops(dev)->write ? device_ops(dev)->write(dev, pos, buffer, size) : 0;
+}
+
+rt_err_t rt_device_control(rt_device_t dev, int cmd, void *arg)
+{
+	return device_ops(dev)->control ? device_ops(dev)->control(dev, cmd, arg) : -RT_ENOSYS;
+}
+
+rt_err_t rt_device_set_tx_complete(rt_device_t dev, rt_err_t (*tx_done)(rt_device_t dev, void *buffer))
+{
+	dev->tx_complete = tx_done;
+	return RT_EOK;
+}
+
+/* ipc: every object waits on one condition variable */
+
+static pthread_mutex_t ipc_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t ipc_cond = PTHREAD_COND_INITIALIZER;
+
+/* wait under ipc_lock until ready(obj), timeout in ticks (ms) */
+static rt_err_t ipc_wait(int (*ready)(void *obj), void *obj, rt_int32_t timeout)
+{
+	struct timespec deadline;
+
+	if (timeout > 0)
+	{
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += timeout / 1000;
+		deadline.tv_nsec += (timeout % 1000) * 1000000L;
+		if (deadline.tv_nsec >= 1000000000L)
+		{
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000000000L;
+		}
+	}
+	while (!ready(obj))
+	{
+		if (timeout == 0)
+			return -RT_ETIMEOUT;
+		if (timeout < 0)
+			pthread_cond_wait(&ipc_cond, &ipc_lock);
+		else if (pthread_cond_timedwait(&ipc_cond, &ipc_lock, &deadline) == ETIMEDOUT && !ready(obj))
+			return -RT_ETIMEOUT;
+	}
+	return RT_EOK;
+}
+
+static void ipc_wake(void)
+{
+	pthread_cond_broadcast(&ipc_cond);
+}
+
+struct sim_sem
+{
+	rt_uint32_t value;
+};
+
+static int sem_ready(void *obj)
+{
+	return ((struct sim_sem *)obj)->value > 0;
+}
+
+rt_err_t rt_sem_init(rt_sem_t sem, const char *name, rt_uint32_t value, rt_uint8_t flag)
+{
+	struct sim_sem *s = calloc(1, sizeof(*s));
+
+	(void)flag;
+	strncpy(sem->parent.parent.name, name, RT_NAME_MAX - 1);
+	s->value = value;
+	sem->parent.impl = s;
+	sim_ipc_live++;
+	return RT_EOK;
+}
+
+rt_err_t rt_sem_detach(rt_sem_t sem)
+{
+	free(sem->parent.impl);
+	sem->parent.impl = RT_NULL;
+	sim_ipc_live--;
+	return RT_EOK;
+}
+
+rt_err_t rt_sem_take(rt_sem_t sem, rt_int32_t time)
+{
+	struct sim_sem *s = sem->parent.impl;
+	rt_err_t result;
+
+	pthread_mutex_lock(&ipc_lock);
+	result = ipc_wait(sem_ready, s, time);
+	if (result == RT_EOK)
+		s->value--;
+	pthread_mutex_unlock(&ipc_lock);
+	return result;
+}
+
+rt_err_t rt_sem_release(rt_sem_t sem)
+{
+	pthread_mutex_lock(&ipc_lock);
+	((struct sim_sem *)sem->parent.impl)->value++;
+	ipc_wake();
+	pthread_mutex_unlock(&ipc_lock);
+	return RT_EOK;
+}
+
+struct sim_mutex
+{
+	pthread_t owner;
+	int hold;
+};
+
+static int mutex_ready(void *obj)
+{
+	struct sim_mutex *m = obj;
+
+	return m->hold == 0 || pthread_equal(m->owner, pthread_self());
+}
+
+rt_err_t rt_mutex_init(rt_mutex_t mutex, const char *name, rt_uint8_t flag)
+{
+	(void)flag;
+	strncpy(mutex->parent.parent.name, name, RT_NAME_MAX - 1);
+	mutex->parent.impl = calloc(1, sizeof(struct sim_mutex));
+	sim_ipc_live++;
+	return RT_EOK;
+}
+
+rt_err_t rt_mutex_detach(rt_mutex_t mutex)
+{
+	free(mutex->parent.impl);
+	mutex->parent.impl = RT_NULL;
+	sim_ipc_live--;
+	return RT_EOK;
+}
+
+rt_err_t rt_mutex_take(rt_mutex_t mutex, rt_int32_t time)
+{
+	struct sim_mutex *m = mutex->parent.impl;
+	rt_err_t result;
+
+	pthread_mutex_lock(&ipc_lock);
+	result = ipc_wait(mutex_ready, m, time);
+	if (result == RT_EOK)
+	{
+		m->owner = pthread_self();
+		m->hold++;
+	}
+	pthread_mutex_unlock(&ipc_lock);
+	return result;
+}
+
+rt_err_t rt_mutex_release(rt_mutex_t mutex)
+{
+	struct sim_mutex *m = mutex->parent.impl;
+	rt_err_t result = -RT_ERROR;
+
+	pthread_mutex_lock(&ipc_lock);
+	if (m->hold && pthread_equal(m->owner, pthread_self()))
+	{
+		m->hold--;
+		ipc_wake();
+		result = RT_EOK;
+	}
+	pthread_mutex_unlock(&ipc_lock);
+	return result;
+}
+
+struct sim_event
+{
+	rt_uint32_t set;
+	rt_uint32_t want;
+	rt_uint8_t opt;
+};
+
+static int event_ready(void *obj)
+{
+	struct sim_event *e = obj;
+
+	if (e->opt & RT_EVENT_FLAG_AND)
+		return (e->set & e->want) == e->want;
+	return (e->set & e->want) != 0;
+}
+
+rt_err_t rt_event_init(rt_event_t event, const char *name, rt_uint8_t flag)
+{
+	(void)flag;
+	strncpy(event->parent.parent.name, name, RT_NAME_MAX - 1);
+	event->parent.impl = calloc(1, sizeof(struct sim_event));
+	sim_ipc_live++;
+	return RT_EOK;
+}
+
+rt_err_t rt_event_detach(rt_event_t event)
+{
+	free(event->parent.impl);
+	event->parent.impl = RT_NULL;
+	sim_ipc_live--;
+	return RT_EOK;
+}
+
+rt_err_t rt_event_send(rt_event_t event, rt_uint32_t set)
+{
+	pthread_mutex_lock(&ipc_lock);
+	((struct sim_event *)event->parent.impl)->set |= set;
+	ipc_wake();
+	pthread_mutex_unlock(&ipc_lock);
+	return RT_EOK;
+}
+
+rt_err_t rt_event_recv(rt_event_t event, rt_uint32_t set, rt_uint8_t opt, rt_int32_t timeout, rt_uint32_t *recved)
+{
+	struct sim_event *e = event->parent.impl;
+	rt_err_t result;
+
+	pthread_mutex_lock(&ipc_lock);
+	e->want = set;
+	e->opt = opt;
+	result = ipc_wait(event_ready, e, timeout);
+	if (result == RT_EOK)
+	{
+		if (recved)
+			*recved = e->set & set;
+		if (opt & RT_EVENT_FLAG_CLEAR)
+			e->set &= ~set;
+	}
+	pthread_mutex_unlock(&ipc_lock);
+	return result;
+}
+
+/* message queues and mailboxes are both rings of fixed size messages */
+struct sim_queue
+{
+	rt_uint8_t *pool;
+	rt_size_t msg_size, capacity, head, count;
+};
+
+static int queue_has_msg(void *obj)
+{
+	return ((struct sim_queue *)obj)->count > 0;
+}
+
+static int queue_has_room(void *obj)
+{
+	struct sim_queue *q = obj;
+
+	return q->count < q->capacity;
+}
+
+static void *queue_create(rt_size_t msg_size, rt_size_t capacity)
+{
+	struct sim_queue *q = calloc(1, sizeof(*q));
+
+	q->msg_size = msg_size;
+	q->capacity = capacity;
+	q->pool = calloc(capacity, msg_size);
+	return q;
+}
+
+static void queue_delete(struct rt_ipc_object *ipc)
+{
+	struct sim_queue *q = ipc->impl;
+
+	if (q)
+		free(q->pool);
+	free(q);
+	ipc->impl = RT_NULL;
+	sim_ipc_live--;
+}
+
+static rt_err_t queue_send(struct rt_ipc_object *ipc, const void *msg, rt_int32_t timeout)
+{
+	struct sim_queue *q = ipc->impl;
+	rt_err_t result;
+
+	pthread_mutex_lock(&ipc_lock);
+	result = ipc_wait(queue_has_room, q, timeout);
+	if (result == RT_EOK)
+	{
+		memcpy(q->pool + (q->head + q->count) % q->capacity * q->msg_size, msg, q->msg_size);
+		q->count++;
+		ipc_wake();
+	}
+	pthread_mutex_unlock(&ipc_lock);
+	return result == RT_EOK ? RT_EOK : -RT_EFULL;
+}
+
+static rt_err_t queue_recv(struct rt_ipc_object *ipc, void *msg, rt_int32_t timeout)
+{
+	struct sim_queue *q = ipc->impl;
+	rt_err_t result;
+
+	pthread_mutex_lock(&ipc_lock);
+	result = ipc_wait(queue_has_msg, q, timeout);
+	if (result == RT_EOK)
+	{
+		memcpy(msg, q->pool + q->head * q->msg_size, q->msg_size);
+		q->head = (q->head + 1) % q->capacity;
+		q->count--;
+		ipc_wake();
+	}
+	pthread_mutex_unlock(&ipc_lock);
+	return result;
+}
+
+rt_err_t rt_mb_init(rt_mailbox_t mb, const char *name, void *msgpool, rt_size_t size, rt_uint8_t flag)
+{
+	(void)msgpool;
+	(void)flag;
+	strncpy(mb->parent.parent.name, name, RT_NAME_MAX - 1);
+	mb->parent.impl = queue_create(sizeof(rt_ubase_t), size);
+	sim_ipc_live++;
+	return RT_EOK;
+}
+
+rt_err_t rt_mb_detach(rt_mailbox_t mb)
+{
+	queue_delete(&mb->parent);
+	return RT_EOK;
+}
+
+rt_err_t rt_mb_send(rt_mailbox_t mb, rt_ubase_t value)
+{
+	return queue_send(&mb->parent, &value, 0);
+}
+
+rt_err_t rt_mb_send_wait(rt_mailbox_t mb, rt_ubase_t value, rt_int32_t timeout)
+{
+	return queue_send(&mb->parent, &value, timeout);
+}
+
+rt_err_t rt_mb_recv(rt_mailbox_t mb, rt_ubase_t *value, rt_int32_t timeout)
+{
+	return queue_recv(&mb->parent, value, timeout);
+}
+
+rt_err_t rt_mq_init(rt_mq_t mq, const char *name, void *msgpool, rt_size_t msg_size, rt_size_t pool_size, rt_uint8_t flag)
+{
+	(void)msgpool;
+	(void)flag;
+	strncpy(mq->parent.parent.name, name, RT_NAME_MAX - 1);
+	/* the kernel keeps a list pointer in front of every message */
+	mq->parent.impl = queue_create(msg_size, pool_size / (RT_ALIGN(msg_size, RT_ALIGN_SIZE) + sizeof(void *)));
+	sim_ipc_live++;
+	return RT_EOK;
+}
+
+rt_err_t rt_mq_detach(rt_mq_t mq)
+{
+	queue_delete(&mq->parent);
+	return RT_EOK;
+}
+
+rt_err_t rt_mq_send(rt_mq_t mq, const void *buffer, rt_size_t size)
+{
+	(void)size;
+	return queue_send(&mq->parent, buffer, 0);
+}
+
+rt_err_t rt_mq_send_wait(rt_mq_t mq, const void *buffer, rt_size_t size, rt_int32_t timeout)
+{
+	(void)size;
+	return queue_send(&mq->parent, buffer, timeout);
+}
+
+rt_err_t rt_mq_recv(rt_mq_t mq, void *buffer, rt_size_t size, rt_int32_t timeout)
+{
+	(void)size;
+	return queue_recv(&mq->parent, buffer, timeout);
+}
+
+/* threads */
+
+struct sim_thread
+{
+	void (*entry)(void *parameter);
+	void *parameter;
+};
+
+static void *thread_main(void *arg)
+{
+	struct sim_thread *t = arg;
+
+	t->entry(t->parameter);
+	return NULL;
+}
+
+rt_thread_t rt_thread_create(const char *name, void (*entry)(void *parameter), void *parameter,
+                             rt_uint32_t stack_size, rt_uint8_t priority, rt_uint32_t tick)
+{
+	rt_thread_t thread;
+	struct sim_thread *t;
+
+	(void)stack_size;
+	(void)priority;
+	(void)tick;
+	if (sim_thread_fail > 0 && --sim_thread_fail == 0)
+		return RT_NULL;
+	thread = calloc(1, sizeof(*thread));
+	t = calloc(1, sizeof(*t));
+	strncpy(thread->parent.name, name, RT_NAME_MAX - 1);
+	t->entry = entry;
+	t->parameter = parameter;
+	thread->impl = t;
+	sim_threads_idle++;
+	return thread;
+}
+
+/* only threads that were never started can be deleted here */
+rt_err_t rt_thread_delete(rt_thread_t thread)
+{
+	if (thread->impl == RT_NULL)
+		return -RT_EBUSY;
+	free(thread->impl);
+	free(thread);
+	sim_threads_idle--;
+	return RT_EOK;
+}
+
+rt_err_t rt_thread_startup(rt_thread_t thread)
+{
+	pthread_t tid;
+
+	if (pthread_create(&tid, NULL, thread_main, thread->impl) != 0)
+		return -RT_ERROR;
+	pthread_detach(tid);
+	/* thread_main owns the entry from now on */
+	thread->impl = RT_NULL;
+	sim_threads_idle--;
+	return RT_EOK;
+}
+
+/* memory and strings */
+
+void *rt_malloc(rt_size_t size)
+{
+	return malloc(size);
+}
+
+void *rt_calloc(rt_size_t count, rt_size_t size)
+{
+	return calloc(count, size);
+}
+
+void rt_free(void *ptr)
+{
+	free(ptr);
+}
+
+void *rt_memset(void *s, int c, rt_ubase_t count)
+{
+	return memset(s, c, count);
+}
+
+void *rt_memcpy(void *dst, const void *src, rt_ubase_t count)
+{
+	return memcpy(dst, src, count);
+}
+
+void *rt_memmove(void *dest, const void *src, rt_ubase_t n)
+{
+	return memmove(dest, src, n);
+}
+
+rt_int32_t rt_memcmp(const void *cs, const void *ct, rt_ubase_t count)
+{
+	return memcmp(cs, ct, count);
+}
+
+rt_int32_t rt_strcmp(const char *cs, const char *ct)
+{
+	return strcmp(cs, ct);
+}
+
+rt_size_t rt_strlen(const char *src)
+{
+	return strlen(src);
+}
+
+rt_int32_t rt_sprintf(char *buf, const char *format, ...)
+{
+	va_list args;
+	int n;
+
+	va_start(args, format);
+	n = vsprintf(buf, format, args);
+	va_end(args);
+	return n;
+}
+
+rt_int32_t rt_snprintf(char *buf, rt_size_t size, const char *format, ...)
+{
+	va_list args;
+	int n;
+
+	va_start(args, format);
+	n = vsnprintf(buf, size, format, args);
+	va_end(args);
+	return n;
+}
+
+void rt_kprintf(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	vprintf(fmt, args);
+	va_end(args);
+}
+
+void rt_assert_handler(const char *ex, const char *func, rt_size_t line)
+{
+	fprintf(stderr, "(%s) assertion failed at function:%s, line number:%lu\n", ex, func, (unsigned long)line);
+	abort();
+}
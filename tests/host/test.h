@@ -0,0 +1,138 @@
+/*
+ * Helpers shared by the host tests. Every test is its own program that
+ * prints what it measured and exits non-zero if any check failed. The
+ * Makefile lists the package options each one is built with.
+ */
+
+#ifndef __TEST_H__
+#define __TEST_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include "drv_st7735r.h"
+#include "sim.h"
+
+extern int (*__rt_init_st7735r_hw_init)(void);
+
+static int test_failed;
+
+#define CHECK(cond)                                                             \
+	do                                                                          \
+	{                                                                           \
+		if (!(cond))                                                            \
+		{                                                                       \
+			if (test_failed++ < 10)                                             \
+				printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+		}                                                                       \
+	} while (0)
+
+/* register lcd0 from the menuconfig pins like the auto-init does, then open it */
+static inline rt_st7735r_t test_open(rt_uint16_t oflag)
+{
+	rt_device_t dev;
+
+	__rt_init_st7735r_hw_init();
+	dev = rt_device_find("lcd0");
+	if (dev == RT_NULL || rt_device_open(dev, oflag) != RT_EOK)
+	{
+		printf("lcd0 did not open\n");
+		exit(1);
+	}
+	return (rt_st7735r_t)dev;
+}
+
+static inline struct rt_device_graphic_ops *test_ops(rt_st7735r_t lcd)
+{
+	return rt_graphix_ops((&lcd->parent));
+}
+
+/* an rgb565 color as it comes back from the GRAM in the current interface format */
+static inline rt_uint16_t test_wire(struct sim_panel *p, rt_uint16_t c)
+{
+	unsigned r = c >> 12, g = (c >> 7) & 0xF, b = (c >> 1) & 0xF;
+
+	if (p->colmod != 3)
+		return c;
+	return ((r << 1 | r >> 3) << 11) | ((g << 2 | g >> 2) << 5) | (b << 1 | b >> 3);
+}
+
+/* pixels of a w x h rgb565 image at (x0, y0) that the panel does not show */
+static inline int test_compare(struct sim_panel *p, const rt_uint16_t *img, int x0, int y0, int w, int h)
+{
+	int x, y, bad = 0;
+
+	for (y = 0; y < h; ++y)
+		for (x = 0; x < w; ++x)
+			bad += sim_pixel(p, x0 + x, y0 + y) != test_wire(p, img[y * w + x]);
+	return bad;
+}
+
+/*
+ * GRAM cell that shows logical (x, y) of a 128x160 panel in orientation
+ * `ori`, for a module whose visible area starts at GRAM (offx, offy)
+ */
+static inline void test_gram_xy(int ori, int offx, int offy, int x, int y, int *gx, int *gy)
+{
+	static const int madctl[4] = {0, 0xA0, 0xC0, 0x60};
+	int m = madctl[ori & 3], cx = m & 0x20 ? y : x, cy = m & 0x20 ? x : y;
+
+	if (m & 0x40)
+		cx = 127 - cx;
+	if (m & 0x80)
+		cy = 159 - cy;
+	*gx = cx + offx;
+	*gy = cy + offy;
+}
+
+/*
+ * RLE565 stream of `n` pixels like tools/st7735r_img.py writes it, runs of
+ * three or more and literals in between, with `split` > 0 cutting packets
+ * at random lengths up to it. Returns the bytes written to `out`.
+ */
+static inline int test_rle_encode(const rt_uint16_t *px, int n, rt_uint8_t *out, int split)
+{
+	int i = 0, o = 0, len, k;
+
+	while (i < n)
+	{
+		int run = 1, max = split > 0 ? 1 + rand() % split : ST7735R_RLE_MAX_LONG;
+
+		while (i + run < n && px[i + run] == px[i] && run < max)
+			run++;
+		if (run >= 3)
+			len = run;
+		else
+		{
+			len = 1;
+			while (i + len < n && len < max && !(i + len + 2 < n && px[i + len] == px[i + len + 1] && px[i + len] == px[i + len + 2]))
+				len++;
+		}
+		out[o] = run >= 3 ? ST7735R_RLE_RUN : 0;
+		if (len > ST7735R_RLE_MAX_SHORT)
+		{
+			out[o++] |= ST7735R_RLE_LONG | (len - 1) >> 8;
+			out[o++] = len - 1;
+		}
+		else
+			out[o++] |= len - 1;
+		for (k = 0; k < (run >= 3 ? 1 : len); ++k)
+		{
+			out[o++] = px[i + k];
+			out[o++] = px[i + k] >> 8;
+		}
+		i += len;
+	}
+	return o;
+}
+
+static inline int test_done(const char *name)
+{
+	printf("%s: %s\n", name, test_failed ? "FAILED" : "ok");
+	return test_failed != 0;
+}
+
+#endif /* __TEST_H__ */
@@ -0,0 +1,131 @@
+/*
+ * Non-blocking writes: rt_device_write returns while the frame is still
+ * on the wire, WAIT_FLUSH polls and waits, tx_complete hands every buffer
+ * back once. An open that cannot create the pipeline threads fails and
+ * leaves nothing behind. With a framebuffer, graphic ops wait for the
+ * queued writes to be mirrored into it.
+ */
+
+#include "test.h"
+
+static rt_uint16_t frame[3][128 * 160];
+static int completed[3];
+
+static rt_err_t tx_done(rt_device_t dev, void *buffer)
+{
+	int i;
+
+	(void)dev;
+	for (i = 0; i < 3; ++i)
+		if (buffer == frame[i])
+			completed[i]++;
+	return RT_EOK;
+}
+
+int main(void)
+{
+	rt_device_t dev;
+	rt_st7735r_t lcd;
+	struct rt_st7735r_rect all = {0, 0, 128, 160};
+	rt_int32_t poll = RT_WAITING_NO;
+	double t0, t1, t2;
+	int i, k, ipc;
+
+	__rt_init_st7735r_hw_init();
+	dev = rt_device_find("lcd0");
+	lcd = (rt_st7735r_t)dev;
+	for (k = 1; k <= 2; ++k)
+	{
+		ipc = sim_ipc_live;
+		sim_thread_fail = k;
+		CHECK(rt_device_open(dev, RT_DEVICE_FLAG_DMA_TX) != RT_EOK);
+		CHECK(lcd->async == RT_NULL && dev->ref_count == 0);
+		CHECK(sim_ipc_live == ipc && sim_threads_idle == 0);
+	}
+	sim_thread_fail = 0;
+	CHECK(rt_device_open(dev, RT_DEVICE_FLAG_DMA_TX) == RT_EOK && lcd->async != RT_NULL);
+
+	rt_device_set_tx_complete(dev, tx_done);
+	for (k = 0; k < 3; ++k)
+		for (i = 0; i < 128 * 160; ++i)
+			frame[k][i] = i * 7 + k * 0x1111;
+
+	/* 200 us per transfer, about 10 ms per frame */
+	sim.latency_us = 200;
+	for (k = 0; k < 3; ++k)
+	{
+		rt_device_control(dev, RT_ST7735R_SET_RECT, &all);
+		t0 = sim_now_us();
+		CHECK(rt_device_write(dev, RT_ST7735R_WRITE_COLOR_PIXEL, frame[k], 128 * 160) == 128 * 160);
+		t1 = sim_now_us();
+		CHECK(rt_device_control(dev, RT_ST7735R_WAIT_FLUSH, &poll) == -RT_EBUSY);
+		CHECK(rt_device_control(dev, RT_ST7735R_WAIT_FLUSH, RT_NULL) == RT_EOK);
+		t2 = sim_now_us();
+		printf("frame %d: write returned after %.0f us, flushed after %.0f us\n", k, t1 - t0, t2 - t0);
+		CHECK(completed[k] == 1);
+		CHECK(test_compare(&sim, frame[k], 0, 0, 128, 160) == 0);
+	}
+
+	/* queue all three back to back, the last one wins */
+	for (k = 0; k < 3; ++k)
+	{
+		rt_device_control(dev, RT_ST7735R_SET_RECT, &all);
+		rt_device_write(dev, RT_ST7735R_WRITE_COLOR_PIXEL, frame[k], 128 * 160);
+	}
+	CHECK(rt_device_control(dev, RT_ST7735R_WAIT_FLUSH, RT_NULL) == RT_EOK);
+	CHECK(completed[0] == 2 && completed[1] == 2 && completed[2] == 2);
+	CHECK(test_compare(&sim, frame[2], 0, 0, 128, 160) == 0);
+
+	/* a blocking call in between waits for the queue */
+	rt_device_write(dev, RT_ST7735R_WRITE_COLOR_PIXEL, frame[0], 128 * 160);
+	st7735r_clear(lcd, 0x1234);
+	for (i = 0; i < 128 * 160; ++i)
+		frame[1][i] = 0x1234;
+	CHECK(test_compare(&sim, frame[1], 0, 0, 128, 160) == 0);
+	/* a new clock waits for the queue, the frame on the wire stays below the marginal link */
+	{
+		rt_uint32_t hz, fast = 30000000;
+		unsigned long errs = sim.err_count;
+
+		rt_device_control(dev, RT_ST7735R_GET_SPI_HZ, &hz);
+		sim.err_hz = 22000000;
+		rt_device_control(dev, RT_ST7735R_SET_RECT, &all);
+		rt_device_write(dev, RT_ST7735R_WRITE_COLOR_PIXEL, frame[2], 128 * 160);
+		CHECK(rt_device_control(dev, RT_ST7735R_SET_SPI_HZ, &fast) == RT_EOK);
+		CHECK(sim.err_count == errs);
+		CHECK(test_compare(&sim, frame[2], 0, 0, 128, 160) == 0);
+		rt_device_control(dev, RT_ST7735R_SET_SPI_HZ, &hz);
+		sim.err_hz = 0;
+		st7735r_clear(lcd, 0x1234);
+	}
+
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+	/* graphic ops draw into the framebuffer only after the queued frame is mirrored into it */
+	{
+		struct rt_device_graphic_ops *ops = test_ops(lcd);
+		struct rt_device_rect_info r = {0, 0, 128, 160};
+		rt_uint16_t c = 0xF81F, got = 0;
+
+		CHECK(memcmp(lcd->framebuffer, frame[1], sizeof(frame[1])) == 0);
+		memcpy(frame[1], frame[0], sizeof(frame[1]));
+		rt_device_control(dev, RT_ST7735R_SET_RECT, &all);
+		rt_device_write(dev, RT_ST7735R_WRITE_COLOR_PIXEL, frame[0], 128 * 160);
+		ops->draw_hline((const char *)&c, 0, 128, 150);
+		ops->set_pixel((const char *)&c, 5, 155);
+		ops->blit_line((const char *)frame[2], 0, 158, 128);
+		ops->get_pixel((char *)&got, 5, 155);
+		CHECK(got == c);
+		for (i = 0; i < 128; ++i)
+		{
+			frame[1][150 * 128 + i] = c;
+			frame[1][158 * 128 + i] = frame[2][i];
+		}
+		frame[1][155 * 128 + 5] = c;
+		rt_device_control(dev, RTGRAPHIC_CTRL_RECT_UPDATE, &r);
+		CHECK(rt_device_control(dev, RT_ST7735R_WAIT_FLUSH, RT_NULL) == RT_EOK);
+		CHECK(memcmp(lcd->framebuffer, frame[1], sizeof(frame[1])) == 0);
+		CHECK(test_compare(&sim, frame[1], 0, 0, 128, 160) == 0);
+	}
+#endif
+	return test_done("async");
+}
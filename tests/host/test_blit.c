@@ -0,0 +1,116 @@
+/*
+ * BLIT_RECT: clipped sub-rect blits out of a sprite sheet, every transform
+ * in every orientation, one RAMWR each and the active rect left alone.
+ */
+
+#include "test.h"
+
+static rt_uint16_t sheet[64 * 48];
+static rt_uint16_t expect[160 * 160];
+static const int ori_madctl[4] = {0, 0xA0, 0xC0, 0x60};
+
+/* panel pixel (x, y) in orientation `ori` of a panel whose visible area starts at (offx, offy) */
+static rt_uint16_t panel_pixel(struct sim_panel *p, int ori, int offx, int offy, int x, int y)
+{
+	int gx, gy;
+
+	test_gram_xy(ori, offx, offy, x, y, &gx, &gy);
+	return p->gram[gy][gx];
+}
+
+static void blit_panel(rt_st7735r_t lcd, rt_uint8_t panel, int gram_width, int gram_height, int offx, int offy)
+{
+	rt_device_t dev = &lcd->parent;
+	rt_uint8_t ori;
+	int k, i, j, x, y;
+
+	/* the offsets only change with the init that applies the variant */
+	{
+		struct rt_st7735r_rect a = {7, 9, 3, 3}, b = {0, 0, 1, 1};
+		int xs, ys;
+
+		rt_device_control(dev, RT_ST7735R_SET_RECT, &a);
+		xs = sim.xs;
+		ys = sim.ys;
+		rt_device_control(dev, RT_ST7735R_SET_RECT, &b);
+		rt_device_control(dev, RT_ST7735R_SET_PANEL, &panel);
+		rt_device_control(dev, RT_ST7735R_SET_RECT, &a);
+		CHECK(sim.xs == xs && sim.ys == ys);
+	}
+	sim.gram_width = gram_width;
+	sim.gram_height = gram_height;
+	rt_device_control(dev, RT_ST7735R_REINIT, RT_NULL);
+	CHECK(lcd->panel == panel);
+	for (ori = 0; ori < 4; ++ori)
+	{
+		struct rt_st7735r_fill fill = {{3, 5, 10, 7}, 0xF800};
+		struct rt_st7735r_rect before;
+		int w, h, bad = 0;
+
+		CHECK(rt_device_control(dev, RT_ST7735R_SET_ORI, &ori) == RT_EOK);
+		w = lcd->width;
+		h = lcd->height;
+		CHECK(w == (ori & 1 ? 160 : 128) && h == (ori & 1 ? 128 : 160));
+		CHECK(lcd->lcd_info.width == w && lcd->lcd_info.height == h);
+		memset(expect, 0, sizeof(expect));
+		rt_device_control(dev, RT_ST7735R_FILL_RECT, &fill);
+		for (y = 5; y < 12; ++y)
+			for (x = 3; x < 13; ++x)
+				expect[y * w + x] = 0xF800;
+
+		before = lcd->rect;
+		for (k = 0; k < 400; ++k)
+		{
+			struct rt_st7735r_blit b = {RT_ST7735R_WRITE_COLOR_PIXEL, sheet, 64 * 2, rand() % 40, rand() % 30, 1 + rand() % 24, 1 + rand() % 18, rand() % (w + 30) - 15, rand() % (h + 30) - 15, rand() % 8};
+			int tr = b.transform & RT_ST7735R_BLIT_TRANSPOSE, dw = tr ? b.height : b.width, dh = tr ? b.width : b.height;
+
+			sim_reset_counters(&sim);
+			CHECK(rt_device_control(dev, RT_ST7735R_BLIT_RECT, &b) == RT_EOK);
+			CHECK(sim.ramwr <= 1);
+			CHECK((sim.madctl & 0xE0) == ori_madctl[ori]);
+			for (j = 0; j < b.height; ++j)
+				for (i = 0; i < b.width; ++i)
+				{
+					int dx = tr ? j : i, dy = tr ? i : j;
+
+					if (b.transform & RT_ST7735R_BLIT_MIRROR_X)
+						dx = dw - 1 - dx;
+					if (b.transform & RT_ST7735R_BLIT_MIRROR_Y)
+						dy = dh - 1 - dy;
+					x = b.x + dx;
+					y = b.y + dy;
+					if (x >= 0 && y >= 0 && x < w && y < h)
+						expect[y * w + x] = sheet[(b.src_y + j) * 64 + b.src_x + i];
+				}
+		}
+		CHECK(memcmp(&before, &lcd->rect, sizeof(before)) == 0);
+		for (y = 0; y < h; ++y)
+			for (x = 0; x < w; ++x)
+			{
+				bad += panel_pixel(&sim, ori, offx, offy, x, y) != expect[y * w + x];
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+				bad += lcd->framebuffer[y * w + x] != expect[y * w + x];
+#endif
+			}
+		printf("panel %d, %dx%d GRAM, ori %d %dx%d: mismatch %d\n", panel, sim.gram_width, sim.gram_height, ori, w, h, bad);
+		CHECK(bad == 0);
+	}
+}
+
+int main(void)
+{
+	rt_st7735r_t lcd = test_open(0);
+	struct rt_st7735r_blit index4 = {RT_ST7735R_WRITE_INDEX4_PIXEL, sheet, 10, 0, 0, 4, 4, 0, 0, 0};
+	int i;
+
+	srand(3);
+	for (i = 0; i < 64 * 48; ++i)
+		sheet[i] = rand();
+	blit_panel(lcd, RT_ST7735R_PANEL_GREENTAB, 132, 162, 2, 1);
+	blit_panel(lcd, RT_ST7735R_PANEL_BLACKTAB, 132, 162, 4, 2);
+	blit_panel(lcd, RT_ST7735R_PANEL_REDTAB, 128, 160, 0, 0);
+
+	/* formats below 8 bits have no byte stride */
+	CHECK(rt_device_control(&lcd->parent, RT_ST7735R_BLIT_RECT, &index4) == -RT_EINVAL);
+	return test_done("blit");
+}
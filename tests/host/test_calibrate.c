@@ -0,0 +1,62 @@
+/*
+ * SPI write clock calibration against a link that starts flipping bits
+ * above 22 MHz: the clock settles below that, the panel keeps what it
+ * showed and writes at the new clock arrive clean.
+ */
+
+#include "test.h"
+
+static rt_uint16_t before[160 * 128];
+
+int main(void)
+{
+	rt_st7735r_t lcd = test_open(0);
+	rt_device_t dev = &lcd->parent;
+	struct rt_st7735r_rect r = {5, 6, 20, 30};
+	struct rt_st7735r_fill fill = {{0, 0, 128, 160}, 0x1234};
+	rt_uint32_t hz = 0, got = 0, start;
+	unsigned long errs;
+	int i, x, y, madctl;
+
+	rt_device_control(dev, RT_ST7735R_GET_SPI_HZ, &start);
+	srand(3);
+	for (i = 0; i < 50; ++i)
+	{
+		struct rt_st7735r_fill f;
+
+		x = rand() % 128;
+		y = rand() % 160;
+		f = (struct rt_st7735r_fill){{x, y, 1 + rand() % (128 - x), 1 + rand() % (160 - y)}, rand()};
+		rt_device_control(dev, RT_ST7735R_FILL_RECT, &f);
+	}
+	rt_device_control(dev, RT_ST7735R_SET_RECT, &r);
+	for (y = 0; y < 160; ++y)
+		for (x = 0; x < 128; ++x)
+			before[y * 128 + x] = sim_pixel(&sim, x, y);
+	madctl = sim.madctl;
+
+	/* without RAMRD there is nothing to check the link with */
+	lcd->ramrd = RT_FALSE;
+	CHECK(rt_device_control(dev, RT_ST7735R_CALIBRATE_SPI, &hz) == -RT_ENOSYS);
+	rt_device_control(dev, RT_ST7735R_GET_SPI_HZ, &got);
+	CHECK(got == start && hz == 0);
+	lcd->ramrd = RT_TRUE;
+
+	sim.err_hz = 22000000;
+	CHECK(rt_device_control(dev, RT_ST7735R_CALIBRATE_SPI, &hz) == RT_EOK);
+	rt_device_control(dev, RT_ST7735R_GET_SPI_HZ, &got);
+	printf("calibrated from %lu to %lu Hz, %lu bit errors injected on the way\n", (unsigned long)start, (unsigned long)hz, sim.err_count);
+	CHECK(hz == got && sim.hz == hz);
+	CHECK(hz >= start && hz <= sim.err_hz);
+	CHECK(test_compare(&sim, before, 0, 0, 128, 160) == 0);
+	CHECK(sim.madctl == madctl);
+	CHECK(memcmp(&lcd->rect, &r, sizeof(r)) == 0);
+
+	errs = sim.err_count;
+	rt_device_control(dev, RT_ST7735R_FILL_RECT, &fill);
+	CHECK(sim.err_count == errs);
+	for (i = 0; i < 160 * 128; ++i)
+		before[i] = 0x1234;
+	CHECK(test_compare(&sim, before, 0, 0, 128, 160) == 0);
+	return test_done("calibrate");
+}
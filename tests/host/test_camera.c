@@ -0,0 +1,134 @@
+/*
+ * Camera frames cropped and scaled onto random rects in every mode,
+ * against a model of the nearest and bilinear scalers, and paced whole
+ * frames with the vsync build.
+ */
+
+#include "test.h"
+
+#define CAM_W       188
+#define CAM_H       120
+#define CAM_STRIDE  200
+
+static rt_uint8_t cam[CAM_H * CAM_STRIDE];
+
+static rt_uint16_t shade(const struct rt_st7735r_camera *c, int g)
+{
+	if (c->mode != RT_ST7735R_CAMERA_GRAY && g >= c->threshold)
+		return c->fg_color;
+	if (c->mode == RT_ST7735R_CAMERA_BINARY)
+		return c->bg_color;
+	return ((g >> 3) << 11) | ((g >> 2) << 5) | (g >> 3);
+}
+
+/* the gray level at destination (dx, dy), bilinear is allowed two steps of rounding either way */
+static rt_bool_t matches(const struct rt_st7735r_camera *c, int cw, int ch, int w, int h, int dx, int dy, rt_uint16_t shown)
+{
+	const rt_uint8_t *o = cam + c->crop_y * CAM_STRIDE + c->crop_x;
+	double fx, fy, ax, ay, v;
+	int x0, y0, x1, y1, g, d;
+
+	if (c->scale == RT_ST7735R_SCALE_NEAREST)
+		return shown == shade(c, o[((2 * dy + 1) * ch) / (2 * h) * CAM_STRIDE + ((2 * dx + 1) * cw) / (2 * w)]);
+	fx = (dx + 0.5) * cw / w - 0.5;
+	fy = (dy + 0.5) * ch / h - 0.5;
+	fx = fx < 0 ? 0 : fx > cw - 1 ? cw - 1 : fx;
+	fy = fy < 0 ? 0 : fy > ch - 1 ? ch - 1 : fy;
+	x0 = (int)fx;
+	y0 = (int)fy;
+	x1 = x0 + 1 < cw ? x0 + 1 : x0;
+	y1 = y0 + 1 < ch ? y0 + 1 : y0;
+	ax = fx - x0;
+	ay = fy - y0;
+	v = (o[y0 * CAM_STRIDE + x0] * (1 - ax) + o[y0 * CAM_STRIDE + x1] * ax) * (1 - ay) + (o[y1 * CAM_STRIDE + x0] * (1 - ax) + o[y1 * CAM_STRIDE + x1] * ax) * ay;
+	g = (int)(v + 0.5);
+	for (d = -2; d <= 2; ++d)
+		if (g + d >= 0 && g + d < 256 && shade(c, g + d) == shown)
+			return RT_TRUE;
+	return RT_FALSE;
+}
+
+int main(void)
+{
+	rt_st7735r_t lcd = test_open(0);
+	rt_device_t dev = &lcd->parent;
+	int it, x, y, bad = 0;
+	double t0;
+
+	srand(3);
+	for (y = 0; y < CAM_H; ++y)
+		for (x = 0; x < CAM_W; ++x)
+			cam[y * CAM_STRIDE + x] = (x * 3 + y * 5 + rand() % 20) & 0xFF;
+	for (it = 0; it < 200; ++it)
+	{
+		struct rt_st7735r_camera c = {.frame = cam, .width = CAM_W, .height = CAM_H, .stride = CAM_STRIDE};
+		struct rt_st7735r_rect r;
+		int cw, ch;
+
+		if (it % 3)
+		{
+			c.crop_x = rand() % 100;
+			c.crop_y = rand() % 60;
+			c.crop_width = 1 + rand() % (CAM_W - c.crop_x);
+			c.crop_height = 1 + rand() % (CAM_H - c.crop_y);
+		}
+		c.scale = rand() % 2;
+		c.mode = rand() % 3;
+		c.threshold = rand();
+		c.fg_color = rand();
+		c.bg_color = rand();
+		r.x = rand() % 128;
+		r.y = rand() % 160;
+		r.width = 1 + rand() % (128 - r.x);
+		r.height = 1 + rand() % (160 - r.y);
+		if (it == 0)
+			r = (struct rt_st7735r_rect){0, 0, 128, 160};
+		rt_device_control(dev, RT_ST7735R_SET_RECT, &r);
+		CHECK(rt_device_control(dev, RT_ST7735R_SHOW_CAMERA, &c) == RT_EOK);
+		cw = c.crop_width ? c.crop_width : CAM_W;
+		ch = c.crop_width ? c.crop_height : CAM_H;
+		for (y = 0; y < r.height; ++y)
+			for (x = 0; x < r.width; ++x)
+				bad += !matches(&c, cw, ch, r.width, r.height, x, y, sim_pixel(&sim, r.x + x, r.y + y));
+	}
+	printf("200 random frames: mismatch %d\n", bad);
+	CHECK(bad == 0);
+
+	{
+		struct rt_st7735r_rect all = {0, 0, 128, 160};
+		struct rt_st7735r_camera c = {.frame = cam, .width = CAM_W, .height = CAM_H, .stride = CAM_STRIDE};
+
+		rt_device_control(dev, RT_ST7735R_SET_RECT, &all);
+		t0 = sim_now_us();
+		for (it = 0; it < 100; ++it)
+			st7735r_show_camera(lcd, &c);
+		printf("%dx%d to 128x160 nearest: %.1f us per frame with the simulator\n", CAM_W, CAM_H, (sim_now_us() - t0) / 100);
+	}
+#ifdef PKG_ST7735R_USING_VSYNC
+	/* whole frames are paced like pixel writes, with the scan model */
+	{
+		struct rt_st7735r_camera c = {.frame = cam, .width = CAM_W, .height = CAM_H, .stride = CAM_STRIDE};
+		rt_base_t te_pin = -1;
+		rt_uint8_t on = 1;
+		int refreshes, torn;
+
+		CHECK(rt_device_control(dev, RT_ST7735R_SET_TE_PIN, &te_pin) == RT_EOK);
+		CHECK(rt_device_control(dev, RT_ST7735R_SET_VSYNC, &on) == RT_EOK);
+		sim_hist_reset(&sim);
+		bad = 0;
+		for (it = 0; it < 10; ++it)
+		{
+			c.threshold = it * 25;
+			c.mode = RT_ST7735R_CAMERA_BINARY;
+			CHECK(st7735r_show_camera(lcd, &c) == RT_EOK);
+		}
+		for (y = 0; y < 160; ++y)
+			for (x = 0; x < 128; ++x)
+				bad += !matches(&c, CAM_W, CAM_H, 128, 160, x, y, sim_pixel(&sim, x, y));
+		torn = sim_torn(&sim, &refreshes);
+		printf("paced: mismatch %d, %d of %d refreshes torn\n", bad, torn, refreshes);
+		CHECK(bad == 0);
+	}
+#endif
+	return test_done("camera");
+}
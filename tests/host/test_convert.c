@@ -0,0 +1,252 @@
+/*
+ * Every converter against its scalar reference on random lengths and
+ * unaligned buffers, the small formats exhaustively, the RLE decoder in
+ * random chunks and the 12/18-bit packer with odd pixels carried between
+ * calls. The convert-swar build hides SSE2 so the word paths run too.
+ */
+
+#include "test.h"
+#include "st7735r_convert.h"
+
+#define MAX_PIXELS  300
+/* room for offsets and a guard band behind the output */
+#define BUF_SIZE    (MAX_PIXELS * 4 + 64)
+
+struct cvt_pair
+{
+	const char *name;
+	st7735r_cvt_t cvt, ref;
+	/* source bits per pixel and the alignment of its pixel type */
+	int bits, align;
+};
+
+static const struct cvt_pair pairs[] =
+{
+	{"rgb565", st7735r_cvt_rgb565, st7735r_cvt_rgb565_ref, 16, 2},
+	{"gray8", st7735r_cvt_gray8, st7735r_cvt_gray8_ref, 8, 1},
+	{"rgb888", st7735r_cvt_rgb888, st7735r_cvt_rgb888_ref, 24, 1},
+	{"argb8888", st7735r_cvt_argb8888, st7735r_cvt_argb8888_ref, 32, 4},
+	{"rgb332", st7735r_cvt_rgb332, st7735r_cvt_rgb332_ref, 8, 1},
+	{"index1", st7735r_cvt_index1, st7735r_cvt_index1_ref, 1, 1},
+	{"index2", st7735r_cvt_index2, st7735r_cvt_index2_ref, 2, 1},
+	{"index4", st7735r_cvt_index4, st7735r_cvt_index4_ref, 4, 1},
+	{"index8", st7735r_cvt_index8, st7735r_cvt_index8_ref, 8, 1},
+};
+
+static rt_uint16_t palette[256];
+static rt_uint8_t in[BUF_SIZE] __attribute__((aligned(16)));
+static rt_uint8_t out[BUF_SIZE] __attribute__((aligned(16)));
+static rt_uint8_t want[BUF_SIZE] __attribute__((aligned(16)));
+
+/* run both on the same input, the bytes around the output must stay untouched */
+static int cvt_compare(const struct cvt_pair *p, const void *src, int dst_off, int count, const struct st7735r_cvt_ctx *ctx)
+{
+	memset(out, 0xA5, sizeof(out));
+	memset(want, 0xA5, sizeof(want));
+	p->cvt(out + dst_off, src, count, ctx);
+	p->ref(want + dst_off, src, count, ctx);
+	return memcmp(out, want, sizeof(out)) != 0;
+}
+
+static void test_pairs(void)
+{
+	struct st7735r_cvt_ctx ctx = {palette, 0, RT_NULL};
+	unsigned k;
+	int i, it;
+
+	for (k = 0; k < sizeof(pairs) / sizeof(pairs[0]); ++k)
+	{
+		const struct cvt_pair *p = &pairs[k];
+		int bad = 0;
+
+		for (it = 0; it < 4000; ++it)
+		{
+			int count = it < MAX_PIXELS ? it : rand() % (MAX_PIXELS + 1);
+			int src_off = (rand() % 16) & ~(p->align - 1), dst_off = rand() % 16;
+
+			for (i = 0; i < BUF_SIZE; ++i)
+				in[i] = rand();
+			if (p->bits == 32)
+			{
+				/* mostly the opaque and clear shortcuts, some blends */
+				for (i = 0; i < count; ++i)
+					in[src_off + i * 4 + 3] = (const rt_uint8_t[]){0x00, 0xFF, in[src_off + i * 4 + 3]}[rand() % 3];
+			}
+			ctx.bg_color = rand();
+			bad += cvt_compare(p, in + src_off, dst_off, count, &ctx);
+		}
+		printf("%-9s random: %d mismatches\n", p->name, bad);
+		CHECK(bad == 0);
+	}
+}
+
+/* every source value of the byte formats, every alpha and channel pair of argb8888 */
+static void test_exhaustive(void)
+{
+	static rt_uint32_t argb[256 * 256];
+	static rt_uint8_t wide_out[256 * 256 * 2], wide_want[256 * 256 * 2];
+	struct st7735r_cvt_ctx ctx = {palette, 0, RT_NULL};
+	int i, off, bg, bad = 0;
+
+	for (off = 0; off < 16; ++off)
+	{
+		for (i = 0; i < 256; ++i)
+			in[off + i] = i;
+		bad += cvt_compare(&pairs[1], in + off, off, 256, &ctx);
+		bad += cvt_compare(&pairs[4], in + off, 15 - off, 256, &ctx);
+		bad += cvt_compare(&pairs[8], in + off, off ^ 1, 256, &ctx);
+	}
+	for (i = 0; i < 256 * 256; ++i)
+		argb[i] = (rt_uint32_t)(i >> 8) << 24 | (i & 0xFF) * 0x010101u;
+	for (bg = 0; bg < 16; ++bg)
+	{
+		ctx.bg_color = bg ? rand() : 0xFFFF;
+		st7735r_cvt_argb8888(wide_out, argb, 256 * 256, &ctx);
+		st7735r_cvt_argb8888_ref(wide_want, argb, 256 * 256, &ctx);
+		bad += memcmp(wide_out, wide_want, sizeof(wide_out)) != 0;
+	}
+	/* rgb565be is a plain copy */
+	for (i = 0; i < 256; ++i)
+		in[i] = rand();
+	st7735r_cvt_rgb565be(out + 3, in + 1, 100, &ctx);
+	bad += memcmp(out + 3, in + 1, 200) != 0;
+	printf("exhaustive: %d mismatches\n", bad);
+	CHECK(bad == 0);
+}
+
+/* decode in random chunks with skips in between, against the raw pixels */
+static void test_rle(void)
+{
+	static rt_uint16_t px[4096];
+	static rt_uint8_t stream[4096 * 3], got[4096 * 2], raw[4096 * 2];
+	struct st7735r_rle rle;
+	struct st7735r_cvt_ctx ctx = {RT_NULL, 0, &rle};
+	int it, i, bad = 0;
+
+	for (it = 0; it < 200; ++it)
+	{
+		int n = 1 + rand() % 4096, pos = 0;
+
+		for (i = 0; i < n; ++i)
+			px[i] = i && rand() % 4 ? px[i - 1] : (rt_uint16_t)rand();
+		if (it % 10 == 0)
+			for (i = 0; i < n; ++i)
+				px[i] = 0x1234;
+		test_rle_encode(px, n, stream, it % 2 ? 1 + rand() % 100 : 0);
+		st7735r_cvt_rgb565_ref(raw, px, n, RT_NULL);
+		st7735r_rle_init(&rle, stream);
+		while (pos < n)
+		{
+			int len = 1 + rand() % (n - pos < 200 ? n - pos : 200);
+
+			if (rand() % 4 == 0)
+				st7735r_rle_skip(&rle, len);
+			else
+			{
+				st7735r_cvt_rle565(got, RT_NULL, len, &ctx);
+				bad += memcmp(got, raw + pos * 2, len * 2) != 0;
+			}
+			pos += len;
+		}
+		/* the whole stream in one call */
+		st7735r_rle_init(&rle, stream);
+		st7735r_cvt_rle565(got, RT_NULL, n, &ctx);
+		bad += memcmp(got, raw, n * 2) != 0;
+	}
+	printf("rle: %d mismatches\n", bad);
+	CHECK(bad == 0);
+}
+
+/* the wire bytes of a stream of rgb565 pixels, pixel by pixel */
+static int pack_model(int bits, const rt_uint16_t *px, int n, rt_uint8_t *wire)
+{
+	int i, o = 0;
+
+	for (i = 0; i < n; ++i)
+	{
+		unsigned c = px[i], r = c >> 11, g = (c >> 5) & 0x3F, b = c & 0x1F;
+
+		if (bits == 18)
+		{
+			wire[o++] = r << 3 | r >> 2;
+			wire[o++] = g << 2 | g >> 4;
+			wire[o++] = b << 3 | b >> 2;
+		}
+		else if (bits == 16)
+		{
+			wire[o++] = c >> 8;
+			wire[o++] = c;
+		}
+		else if (i % 2 == 0)
+		{
+			wire[o++] = (r >> 1) << 4 | g >> 2;
+			wire[o++] = (b >> 1) << 4;
+		}
+		else
+		{
+			wire[o - 1] |= r >> 1;
+			wire[o++] = (g >> 2) << 4 | b >> 1;
+		}
+	}
+	return o;
+}
+
+/*
+ * Stage random chunks where st7735r_pack_src puts them, pack them in place
+ * and append what comes out, like the driver does with its tx buffer.
+ */
+static void test_pack(void)
+{
+	static const rt_uint8_t depths[] = {12, 16, 18};
+	static rt_uint16_t px[2048];
+	static rt_uint8_t wire[2048 * 3], want_wire[2048 * 3];
+	static rt_uint8_t buf[256 * 3 + 8];
+	unsigned d;
+	int it, i, bad = 0;
+
+	for (d = 0; d < sizeof(depths); ++d)
+	{
+		for (it = 0; it < 500; ++it)
+		{
+			struct st7735r_pack pack = {depths[d], RT_FALSE, {0, 0}};
+			int n = 1 + rand() % 2048, pos = 0, o = 0;
+
+			for (i = 0; i < n; ++i)
+				px[i] = rand();
+			while (pos < n)
+			{
+				/* odd sized rooms leave a pixel to carry into the next call */
+				rt_uint32_t room = st7735r_pack_room(&pack, 3 + rand() % (sizeof(buf) - 3));
+				rt_uint32_t len = room < (rt_uint32_t)(n - pos) ? room : (rt_uint32_t)(n - pos);
+				rt_uint8_t *src = st7735r_pack_src(&pack, buf, len);
+
+				if (len == 0)
+					continue;
+				st7735r_cvt_rgb565(src, px + pos, len, RT_NULL);
+				i = st7735r_pack(&pack, buf, len);
+				memcpy(wire + o, buf, i);
+				o += i;
+				pos += len;
+			}
+			o += st7735r_pack_finish(&pack, wire + o);
+			i = pack_model(depths[d], px, n, want_wire);
+			bad += o != i || memcmp(wire, want_wire, i) != 0;
+		}
+	}
+	printf("pack: %d mismatches\n", bad);
+	CHECK(bad == 0);
+}
+
+int main(void)
+{
+	int i;
+
+	srand(7735);
+	for (i = 0; i < 256; ++i)
+		palette[i] = rand();
+	test_pairs();
+	test_exhaustive();
+	test_rle();
+	test_pack();
+	return test_done("convert");
+}
@@ -0,0 +1,136 @@
+/*
+ * Display lists: random frames of fills, blits in several formats, glyphs
+ * and an RLE blit, rendered band by band over the whole panel or a part.
+ */
+
+#include "test.h"
+
+static struct rt_st7735r_dlist dl;
+static rt_uint16_t expect[160 * 128];
+static rt_uint16_t src565[64 * 64], rle_px[64 * 64], pal[16];
+static rt_uint8_t idx1[64 * 64 / 8 + 1], idx4[64 * 64 / 2 + 1], rle[64 * 64 * 3 + 64], glyph[8 * 16];
+
+static void put(int x, int y, rt_uint16_t c)
+{
+	if (x < 128 && y < 160)
+		expect[y * 128 + x] = c;
+}
+
+int main(void)
+{
+	rt_st7735r_t lcd = test_open(0);
+	rt_device_t dev = &lcd->parent;
+	int frame, p, i, j, x, y;
+
+	srand(1);
+	for (i = 0; i < 16; ++i)
+		pal[i] = rand();
+	rt_device_control(dev, RT_ST7735R_SET_PALETTE, pal);
+	for (frame = 0; frame < 40; ++frame)
+	{
+		rt_uint16_t bg = rand();
+		int prims = 5 + rand() % 25, rle_done = 0;
+
+		st7735r_dlist_init(&dl, bg);
+		for (i = 0; i < 128 * 160; ++i)
+			expect[i] = bg;
+		for (i = 0; i < 64 * 64; ++i)
+			src565[i] = rand();
+		for (i = 0; i < (int)sizeof(idx1); ++i)
+			idx1[i] = rand();
+		for (i = 0; i < (int)sizeof(idx4); ++i)
+			idx4[i] = rand();
+		for (i = 0; i < (int)sizeof(glyph); ++i)
+			glyph[i] = rand();
+		for (p = 0; p < prims; ++p)
+		{
+			int op = rand() % 7, w = 1 + rand() % 64, h = 1 + rand() % 64, b;
+			rt_uint16_t c = rand();
+
+			x = rand() % 128;
+			y = rand() % 160;
+			if (op == 6 && rle_done)
+				op = 0;
+			switch (op)
+			{
+			case 0:
+			case 1:
+				/* some fills run off the right edge */
+				if (op == 1 && (rand() & 1))
+				{
+					w = 128 - x + rand() % 10;
+					h = 1;
+				}
+				st7735r_dlist_fill(&dl, x, y, w, h, c);
+				for (j = 0; j < h; ++j)
+					for (i = 0; i < w; ++i)
+						put(x + i, y + j, c);
+				break;
+			case 2:
+				st7735r_dlist_blit(&dl, x, y, w, h, RT_ST7735R_WRITE_COLOR_PIXEL, src565);
+				for (j = 0; j < h; ++j)
+					for (i = 0; i < w; ++i)
+						put(x + i, y + j, src565[j * w + i]);
+				break;
+			case 3:
+				st7735r_dlist_blit(&dl, x, y, w, h, RT_ST7735R_WRITE_INDEX1_PIXEL, idx1);
+				for (j = 0; j < h; ++j)
+					for (i = 0; i < w; ++i)
+					{
+						b = j * w + i;
+						put(x + i, y + j, pal[(idx1[b / 8] >> (7 - b % 8)) & 1]);
+					}
+				break;
+			case 4:
+				st7735r_dlist_blit(&dl, x, y, w, h, RT_ST7735R_WRITE_INDEX4_PIXEL, idx4);
+				for (j = 0; j < h; ++j)
+					for (i = 0; i < w; ++i)
+					{
+						b = j * w + i;
+						put(x + i, y + j, pal[(idx4[b / 2] >> (b % 2 ? 0 : 4)) & 15]);
+					}
+				break;
+			case 5:
+				w = 1 + rand() % 16;
+				h = 1 + rand() % 8;
+				st7735r_dlist_glyph(&dl, x, y, w, h, glyph, c);
+				for (j = 0; j < h; ++j)
+					for (i = 0; i < w; ++i)
+						if (glyph[j * ((w + 7) / 8) + i / 8] & (0x80 >> (i % 8)))
+							put(x + i, y + j, c);
+				break;
+			default:
+				for (i = 0; i < w * h; ++i)
+					rle_px[i] = rand() % 3 ? c : rand();
+				test_rle_encode(rle_px, w * h, rle, 80);
+				rle_done = 1;
+				st7735r_dlist_blit(&dl, x, y, w, h, RT_ST7735R_WRITE_RLE565_PIXEL, rle);
+				for (j = 0; j < h; ++j)
+					for (i = 0; i < w; ++i)
+						put(x + i, y + j, rle_px[j * w + i]);
+				break;
+			}
+		}
+
+		sim_reset_counters(&sim);
+		if (frame % 4 == 3)
+		{
+			struct rt_st7735r_rect a = {3, 7, 118, 140};
+			int bad = 0;
+
+			CHECK(st7735r_dlist_render(lcd, &dl, &a) == RT_EOK);
+			for (y = a.y; y < a.y + a.height; ++y)
+				for (x = a.x; x < a.x + a.width; ++x)
+					bad += sim_pixel(&sim, x, y) != expect[y * 128 + x];
+			CHECK(bad == 0);
+		}
+		else
+		{
+			CHECK(rt_device_control(dev, RT_ST7735R_DLIST_RENDER, &dl) == RT_EOK);
+			CHECK(test_compare(&sim, expect, 0, 0, 128, 160) == 0);
+		}
+		if (frame < 3)
+			printf("frame %d, %d primitives, %d kept: %lu pixels, %lu bytes in %lu transfers\n", frame, prims, dl.count, sim.pixels, sim.bytes, sim.transfers);
+	}
+	return test_done("dlist");
+}
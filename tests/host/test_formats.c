@@ -0,0 +1,43 @@
+/*
+ * Indexed and 32-bit write formats: index formats need a palette, argb
+ * takes the color channels.
+ */
+
+#include "test.h"
+
+int main(void)
+{
+	rt_st7735r_t lcd = test_open(0);
+	rt_device_t dev = &lcd->parent;
+	struct rt_st7735r_rect r = {3, 5, 101, 37}, small = {0, 0, 10, 5};
+	static rt_uint16_t pal[16], expect[101 * 37];
+	static rt_uint8_t idx[2000];
+	rt_uint32_t argb[50];
+	rt_uint16_t red[50];
+	int i;
+
+	for (i = 0; i < 16; ++i)
+		pal[i] = i * 0x1111;
+	for (i = 0; i < (int)sizeof(idx); ++i)
+		idx[i] = rand();
+
+	/* no palette yet */
+	CHECK(rt_device_write(dev, RT_ST7735R_WRITE_INDEX4_PIXEL, idx, 10) == 0);
+
+	CHECK(rt_device_control(dev, RT_ST7735R_SET_PALETTE, pal) == RT_EOK);
+	rt_device_control(dev, RT_ST7735R_SET_RECT, &r);
+	CHECK(rt_device_write(dev, RT_ST7735R_WRITE_INDEX4_PIXEL, idx, 101 * 37) == 101 * 37);
+	for (i = 0; i < 101 * 37; ++i)
+		expect[i] = pal[(idx[i / 2] >> (i & 1 ? 0 : 4)) & 0xF];
+	CHECK(test_compare(&sim, expect, 3, 5, 101, 37) == 0);
+
+	for (i = 0; i < 50; ++i)
+	{
+		argb[i] = 0xFFFF0000;
+		red[i] = 0xF800;
+	}
+	rt_device_control(dev, RT_ST7735R_SET_RECT, &small);
+	CHECK(rt_device_write(dev, RT_ST7735R_WRITE_ARGB8888_PIXEL, argb, 50) == 50);
+	CHECK(test_compare(&sim, red, 0, 0, 10, 5) == 0);
+	return test_done("formats");
+}
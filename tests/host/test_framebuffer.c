@@ -0,0 +1,43 @@
+/*
+ * Framebuffer mode: RECT_UPDATE sends only the dirty part, device writes
+ * go to the panel and the framebuffer both, reads come from the
+ * framebuffer.
+ */
+
+#include "test.h"
+
+int main(void)
+{
+	rt_st7735r_t lcd = test_open(0);
+	rt_device_t dev = &lcd->parent;
+	struct rt_device_graphic_info info;
+	struct rt_device_rect_info update = {5, 10, 25, 10};
+	struct rt_st7735r_rect r = {0, 8, 10, 4};
+	rt_uint16_t px[40], rb[40], *fb;
+	rt_uint32_t caps = 0;
+	int x, y, i;
+
+	CHECK(rt_device_control(dev, RTGRAPHIC_CTRL_GET_INFO, &info) == RT_EOK);
+	CHECK(info.framebuffer != RT_NULL);
+	rt_device_control(dev, RT_ST7735R_GET_CAPS, &caps);
+	CHECK(caps & RT_ST7735R_CAP_FRAMEBUFFER);
+	fb = (rt_uint16_t *)info.framebuffer;
+
+	for (y = 10; y < 20; ++y)
+		for (x = 5; x < 30; ++x)
+			fb[y * 128 + x] = 0xF800;
+	sim_reset_counters(&sim);
+	rt_device_control(dev, RTGRAPHIC_CTRL_RECT_UPDATE, &update);
+	printf("25x10 update: %lu bytes in %lu transfers\n", sim.bytes, sim.transfers);
+	CHECK(sim.pixels == 25 * 10);
+	CHECK(test_compare(&sim, fb, 0, 0, 128, 160) == 0);
+
+	rt_device_control(dev, RT_ST7735R_SET_RECT, &r);
+	for (i = 0; i < 40; ++i)
+		px[i] = i;
+	CHECK(rt_device_write(dev, RT_ST7735R_WRITE_COLOR_PIXEL, px, 40) == 40);
+	CHECK(rt_device_read(dev, RT_ST7735R_READ_COLOR_PIXEL, rb, 40) == 40);
+	CHECK(memcmp(px, rb, sizeof(px)) == 0);
+	CHECK(test_compare(&sim, fb, 0, 0, 128, 160) == 0);
+	return test_done("framebuffer");
+}
@@ -0,0 +1,117 @@
+/*
+ * The RT-Thread graphic ops, with the number of windows and RAMWR runs
+ * each pattern costs on the wire. Shapes partly or wholly off the panel
+ * are clipped.
+ */
+
+#include "test.h"
+
+static rt_uint16_t expect[160][128];
+
+int main(void)
+{
+	rt_st7735r_t lcd = test_open(0);
+	struct rt_device_graphic_ops *ops = test_ops(lcd);
+	rt_uint16_t c, line[60];
+	int x, y, i;
+
+	sim_reset_counters(&sim);
+	for (y = 20; y < 40; ++y)
+		for (x = 10; x < 50; ++x)
+		{
+			c = x * 31 + y;
+			ops->set_pixel((const char *)&c, x, y);
+			expect[y][x] = c;
+		}
+	printf("800 set_pixel: %lu transfers, %lu bytes, caset %lu raset %lu ramwr %lu\n", sim.transfers, sim.bytes, sim.caset, sim.raset, sim.ramwr);
+
+	sim_reset_counters(&sim);
+	c = 0x1234;
+	for (y = 50; y < 90; ++y)
+	{
+		ops->draw_hline((const char *)&c, 5, 105, y);
+		for (x = 5; x < 105; ++x)
+			expect[y][x] = c;
+	}
+	printf("40 hlines: %lu transfers, caset %lu raset %lu ramwr %lu\n", sim.transfers, sim.caset, sim.raset, sim.ramwr);
+
+	sim_reset_counters(&sim);
+	for (y = 100; y < 140; ++y)
+	{
+		for (i = 0; i < 60; ++i)
+			line[i] = expect[y][20 + i] = y * 100 + i;
+		ops->blit_line((const char *)line, 20, y, 60);
+	}
+	printf("40 blit_lines: %lu transfers, caset %lu raset %lu ramwr %lu\n", sim.transfers, sim.caset, sim.raset, sim.ramwr);
+
+	sim_reset_counters(&sim);
+	c = 0x0F0F;
+	for (x = 110; x < 120; ++x)
+	{
+		ops->draw_vline((const char *)&c, x, 0, 150);
+		for (y = 0; y < 150; ++y)
+			expect[y][x] = c;
+	}
+	printf("10 vlines: %lu transfers, caset %lu raset %lu ramwr %lu\n", sim.transfers, sim.caset, sim.raset, sim.ramwr);
+
+	/* shapes sticking out of the panel are clipped */
+	c = 0x7BEF;
+	ops->draw_hline((const char *)&c, -20, 10, 145);
+	ops->draw_hline((const char *)&c, 200, 120, 146);
+	ops->draw_vline((const char *)&c, 3, -5, 4);
+	ops->draw_vline((const char *)&c, 125, 150, 400);
+	for (i = 0; i < 10; ++i)
+		expect[145][i] = expect[150 + i][125] = c;
+	for (i = 0; i < 8; ++i)
+		expect[146][120 + i] = c;
+	for (i = 0; i < 4; ++i)
+		expect[i][3] = c;
+	for (i = 0; i < 60; ++i)
+		line[i] = 0xA000 + i;
+	ops->blit_line((const char *)line, -7, 152, 20);
+	ops->blit_line((const char *)line, 120, 153, 60);
+	for (i = 0; i < 13; ++i)
+		expect[152][i] = line[7 + i];
+	for (i = 0; i < 8; ++i)
+		expect[153][120 + i] = line[i];
+
+	/* and the ones entirely outside send nothing */
+	sim_reset_counters(&sim);
+	ops->set_pixel((const char *)&c, -1, 5);
+	ops->set_pixel((const char *)&c, 5, -1);
+	ops->set_pixel((const char *)&c, 128, 0);
+	ops->set_pixel((const char *)&c, 0, 160);
+	ops->draw_hline((const char *)&c, -10, -1, 5);
+	ops->draw_hline((const char *)&c, 0, 50, -3);
+	ops->draw_hline((const char *)&c, 0, 50, 160);
+	ops->draw_hline((const char *)&c, 128, 140, 5);
+	ops->draw_vline((const char *)&c, -1, 0, 10);
+	ops->draw_vline((const char *)&c, 128, 0, 10);
+	ops->draw_vline((const char *)&c, 5, -10, -2);
+	ops->blit_line((const char *)line, -60, 5, 60);
+	ops->blit_line((const char *)line, 0, -1, 60);
+	ops->blit_line((const char *)line, 128, 5, 60);
+	CHECK(sim.transfers == 0);
+
+	c = 0xDEAD;
+	ops->get_pixel((char *)&c, -1, 0);
+	ops->get_pixel((char *)&c, 0, -1);
+	ops->get_pixel((char *)&c, 128, 0);
+	CHECK(c == 0xDEAD);
+#if defined(PKG_ST7735R_USING_FRAMEBUFFER) || defined(PKG_ST7735R_USING_READBACK)
+	ops->get_pixel((char *)&c, 5, 145);
+	CHECK(c == 0x7BEF);
+#endif
+
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+	/* the graphic ops only drew into the framebuffer */
+	{
+		struct rt_device_rect_info r = {0, 0, 128, 160};
+
+		CHECK(memcmp(lcd->framebuffer, expect, sizeof(expect)) == 0);
+		rt_device_control(&lcd->parent, RTGRAPHIC_CTRL_RECT_UPDATE, &r);
+	}
+#endif
+	CHECK(test_compare(&sim, expect[0], 0, 0, 128, 160) == 0);
+	return test_done("graphic_ops");
+}
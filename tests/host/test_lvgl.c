@@ -0,0 +1,80 @@
+/*
+ * The LVGL display port: frames of a moving scene refreshed in strips of
+ * the draw buffers, flushed with non-blocking writes.
+ */
+
+#include "test.h"
+#include "st7735r_lvgl.h"
+
+#define FRAMES 30
+
+static int frame_no, width, height;
+static rt_uint16_t expect[160 * 128];
+
+static rt_uint16_t scene(int x, int y)
+{
+	int k;
+
+	for (k = 0; k < 6; ++k)
+	{
+		int bx = (frame_no * (k + 1) * 3 + k * 37) % width, by = (frame_no * (k + 2) + k * 23) % height;
+
+		if (x >= bx && x < bx + 30 && y >= by && y < by + 20)
+			return 0x1000 * (k + 1) + 0x3F;
+	}
+	return ((x * 31 / width) << 11) | ((y * 63 / height) << 5) | ((x + y + frame_no) & 31);
+}
+
+static void render(lv_color_t *buf, const lv_area_t *area)
+{
+	int x, y, i = 0;
+
+	for (y = area->y1; y <= area->y2; ++y)
+		for (x = area->x1; x <= area->x2; ++x)
+		{
+			rt_uint16_t c = scene(x, y);
+
+			buf[i++].full = LV_COLOR_16_SWAP ? (rt_uint16_t)(c << 8 | c >> 8) : c;
+		}
+}
+
+int main(void)
+{
+	struct st7735r_lvgl_stats st;
+	lv_disp_t *disp;
+	double t0, ms;
+	int x, y;
+
+	__rt_init_st7735r_hw_init();
+	disp = st7735r_lvgl_init("lcd0");
+	CHECK(disp != RT_NULL);
+	if (disp == RT_NULL)
+		return test_done("lvgl");
+	width = disp->driver->hor_res;
+	height = disp->driver->ver_res;
+	CHECK(width == 128 && height == 160);
+
+	st7735r_lvgl_reset_stats();
+	sim_reset_counters(&sim);
+	t0 = sim_now_us();
+	for (frame_no = 0; frame_no < FRAMES; ++frame_no)
+	{
+		lv_area_t all = {0, 0, width - 1, height - 1};
+
+		lv_stub_refr(disp, &all, render);
+	}
+	lv_stub_wait(disp);
+	rt_device_control(rt_device_find("lcd0"), RT_ST7735R_WAIT_FLUSH, RT_NULL);
+	ms = (sim_now_us() - t0) / 1000;
+
+	frame_no--;
+	for (y = 0; y < height; ++y)
+		for (x = 0; x < width; ++x)
+			expect[y * width + x] = scene(x, y);
+	CHECK(test_compare(&sim, expect, 0, 0, width, height) == 0);
+	st7735r_lvgl_get_stats(&st);
+	CHECK(st.pixels == FRAMES * 128 * 160);
+	printf("%d frames in %.0f ms, %u flushes, %u ms in flush_cb, %u ms waiting, %lu bytes in %lu transfers\n",
+	       FRAMES, ms, st.flushes, st.flush_ticks, st.wait_ticks, sim.bytes, sim.transfers);
+	return test_done("lvgl");
+}
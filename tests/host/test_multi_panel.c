@@ -0,0 +1,126 @@
+/*
+ * Two panels on one bus with a shared dc pin, drawn from two threads at
+ * once. Each panel has to end up with exactly its own writes. Every write
+ * and fill holds the bus from its window to its last pixel, so the other
+ * panel never gets in between.
+ */
+
+#include <pthread.h>
+
+#include "test.h"
+
+#define OPS 3000
+
+static rt_uint16_t expect[2][160][128];
+static rt_uint16_t frame[128 * 160];
+static rt_st7735r_t lcds[2];
+
+#ifdef PKG_ST7735R_USING_ASYNC
+#define OPEN_FLAG   RT_DEVICE_FLAG_DMA_TX
+#else
+#define OPEN_FLAG   0
+#endif
+
+static void *writer(void *arg)
+{
+	int p = (int)(long)arg, it, i, j;
+	unsigned seed = p + 1;
+	rt_device_t dev = &lcds[p]->parent;
+	struct rt_device_graphic_ops *ops = test_ops(lcds[p]);
+	static __thread rt_uint16_t px[128 * 40];
+
+	for (it = 0; it < OPS; ++it)
+	{
+		int x = rand_r(&seed) % 128, y = rand_r(&seed) % 160, w = 1 + rand_r(&seed) % (128 - x), h = 1 + rand_r(&seed) % (160 - y);
+		rt_uint16_t c = rand_r(&seed);
+
+		switch (it % 5)
+		{
+		case 0:
+			ops->set_pixel((const char *)&c, x, y);
+			expect[p][y][x] = c;
+			break;
+		case 1:
+			ops->draw_hline((const char *)&c, x, x + w, y);
+			for (i = 0; i < w; ++i)
+				expect[p][y][x + i] = c;
+			break;
+		case 2:
+			ops->draw_vline((const char *)&c, x, y, y + h);
+			for (j = 0; j < h; ++j)
+				expect[p][y + j][x] = c;
+			break;
+		case 3:
+			for (i = 0; i < w; ++i)
+				px[i] = expect[p][y][x + i] = c + i;
+			ops->blit_line((const char *)px, x, y, w);
+			break;
+		default:
+		{
+			struct rt_st7735r_rect r = {x, y, w, h > 40 ? 40 : h};
+
+			for (i = 0; i < r.width * r.height; ++i)
+				px[i] = expect[p][y + i / w][x + i % w] = c ^ i;
+			rt_device_control(dev, RT_ST7735R_SET_RECT, &r);
+			rt_device_write(dev, RT_ST7735R_WRITE_COLOR_PIXEL, px, r.width * r.height);
+			/* a queued write borrows px */
+			rt_device_control(dev, RT_ST7735R_WAIT_FLUSH, RT_NULL);
+			break;
+		}
+		}
+	}
+	return RT_NULL;
+}
+
+int main(void)
+{
+	pthread_t th[2];
+	double t0;
+	long i;
+
+	for (i = 0; i < 2; ++i)
+	{
+		sim_panels[i].latency_us = 5;
+		lcds[i] = st7735r_user_init("spi0", 10 + i, 4, 3, 2, 128, 160, 0);
+		CHECK(lcds[i] != RT_NULL);
+		if (lcds[i] == RT_NULL || rt_device_open(&lcds[i]->parent, OPEN_FLAG) != RT_EOK)
+			return test_done("multi_panel");
+	}
+	CHECK(test_ops(lcds[0]) != test_ops(lcds[1]));
+
+	/* one bus hold per operation, however many transfers it takes */
+	{
+		struct sim_panel *p = &sim_panels[0];
+		rt_device_t dev = &lcds[0]->parent;
+		struct rt_st7735r_rect all = {0, 0, 128, 160};
+
+		for (i = 0; i < 128 * 160; ++i)
+			frame[i] = i;
+		rt_device_control(dev, RT_ST7735R_SET_RECT, &all);
+		sim_reset_counters(p);
+		CHECK(rt_device_write(dev, RT_ST7735R_WRITE_COLOR_PIXEL, frame, 128 * 160) == 128 * 160);
+		rt_device_control(dev, RT_ST7735R_WAIT_FLUSH, RT_NULL);
+		printf("write: %lu transfers in %lu bus holds\n", p->transfers, p->bus_holds);
+		CHECK(p->transfers > 2 && p->bus_holds == 1);
+		sim_reset_counters(p);
+		st7735r_show_color_pixel(lcds[0], frame, 128 * 160);
+		CHECK(p->transfers > 2 && p->bus_holds == 1);
+		sim_reset_counters(p);
+		st7735r_fill_rect(lcds[0], 10, 20, 100, 120, 0x1234);
+		CHECK(p->caset == 2 && p->bus_holds == 1);
+		sim_reset_counters(p);
+		st7735r_clear(lcds[0], 0);
+		CHECK(p->ramwr == 1 && p->bus_holds == 1);
+	}
+
+	t0 = sim_now_us();
+	for (i = 0; i < 2; ++i)
+		pthread_create(&th[i], RT_NULL, writer, (void *)i);
+	for (i = 0; i < 2; ++i)
+		pthread_join(th[i], RT_NULL);
+	printf("2 x %d ops from two threads: %.0f ms, %lu + %lu bytes\n", OPS, (sim_now_us() - t0) / 1000, sim_panels[0].bytes, sim_panels[1].bytes);
+	/* orientation 0 of the black tab starts at GRAM (4, 2) */
+	for (i = 0; i < 2; ++i)
+		CHECK(test_compare(&sim_panels[i], expect[i][0], 4, 2, 128, 160) == 0);
+	return test_done("multi_panel");
+}
@@ -0,0 +1,54 @@
+/*
+ * RAMRD readback: rt_device_read and get_pixel return what the GRAM holds
+ * after random fills and pixels, at the read clock.
+ */
+
+#include "test.h"
+
+static rt_uint16_t buf[128 * 160];
+
+int main(void)
+{
+	rt_st7735r_t lcd = test_open(0);
+	rt_device_t dev = &lcd->parent;
+	struct rt_device_graphic_ops *ops = test_ops(lcd);
+	rt_uint32_t caps = 0, write_hz = sim.hz;
+	int it, i, j;
+
+	rt_device_control(dev, RT_ST7735R_GET_CAPS, &caps);
+	printf("caps %lx, write clock %lu\n", (unsigned long)caps, (unsigned long)write_hz);
+	CHECK(caps & RT_ST7735R_CAP_RAMRD);
+	CHECK(caps & RT_ST7735R_CAP_READ);
+
+	srand(1);
+	for (it = 0; it < 300; ++it)
+	{
+		int x = rand() % lcd->width, y = rand() % lcd->height, w = 1 + rand() % (lcd->width - x), h = 1 + rand() % (lcd->height - y);
+		struct rt_st7735r_fill f = {{x, y, w, h}, rand()};
+		struct rt_st7735r_rect r;
+		rt_uint16_t c = rand(), p;
+		int px, py;
+
+		rt_device_control(dev, RT_ST7735R_FILL_RECT, &f);
+		ops->set_pixel((const char *)&c, rand() % lcd->width, rand() % lcd->height);
+
+		x = rand() % lcd->width;
+		y = rand() % lcd->height;
+		w = 1 + rand() % (lcd->width - x);
+		h = 1 + rand() % (lcd->height - y);
+		r = (struct rt_st7735r_rect){x, y, w, h};
+		rt_device_control(dev, RT_ST7735R_SET_RECT, &r);
+		CHECK(rt_device_read(dev, RT_ST7735R_READ_COLOR_PIXEL, buf, w * h) == (rt_size_t)(w * h));
+		for (j = 0; j < h; ++j)
+			for (i = 0; i < w; ++i)
+				CHECK(buf[j * w + i] == sim_pixel(&sim, x + i, y + j));
+
+		px = rand() % lcd->width;
+		py = rand() % lcd->height;
+		ops->get_pixel((char *)&p, px, py);
+		CHECK(p == sim_pixel(&sim, px, py));
+	}
+	/* reads run slower and the write clock comes back after */
+	CHECK(sim.hz == write_hz);
+	return test_done("readback");
+}
@@ -0,0 +1,134 @@
+/*
+ * The render queue with four producer threads: fills, outlines and blits
+ * posted to their own columns, merged and drawn by the render thread.
+ * Every blit buffer is released once. An open without a render thread
+ * fails and posts are refused.
+ */
+
+#include <pthread.h>
+
+#include "test.h"
+
+#define PRODUCERS   4
+#define OPS         4000
+
+static rt_uint16_t expect[160][128];
+static rt_uint16_t bufs[PRODUCERS][64][32 * 40];
+static int released[PRODUCERS][OPS];
+static int blits;
+static rt_st7735r_t lcd;
+
+static void release(const void *buffer, void *arg)
+{
+	(void)buffer;
+	__atomic_fetch_add((int *)arg, 1, __ATOMIC_RELAXED);
+}
+
+static void post(const struct rt_st7735r_render_cmd *cmd)
+{
+	while (st7735r_render_post(lcd, cmd, RT_WAITING_FOREVER) != RT_EOK)
+		;
+}
+
+static void *producer(void *arg)
+{
+	int p = (int)(long)arg, bx = p * 32, it, i, j;
+	unsigned seed = p + 7;
+
+	for (it = 0; it < OPS; ++it)
+	{
+		struct rt_st7735r_render_cmd c = {0};
+		int x = rand_r(&seed) % 32, y = rand_r(&seed) % 160, w = 1 + rand_r(&seed) % (32 - x), h = 1 + rand_r(&seed) % (160 - y);
+		int k = rand_r(&seed) % 5;
+
+		if (h > 40)
+			h = 40;
+		c.rect = (struct rt_st7735r_rect){bx + x, y, w, h};
+		c.value = rand_r(&seed);
+		if (k <= 1)
+		{
+			c.op = RT_ST7735R_RENDER_FILL;
+			for (j = 0; j < h; ++j)
+				for (i = 0; i < w; ++i)
+					expect[y + j][bx + x + i] = c.value;
+		}
+		else if (k == 2)
+		{
+			c.op = RT_ST7735R_RENDER_RECT;
+			for (i = 0; i < w; ++i)
+				expect[y][bx + x + i] = expect[y + h - 1][bx + x + i] = c.value;
+			for (j = 0; j < h; ++j)
+				expect[y + j][bx + x] = expect[y + j][bx + x + w - 1] = c.value;
+		}
+		else
+		{
+			rt_uint16_t *b = bufs[p][it % 64];
+
+			for (i = 0; i < w * h; ++i)
+				b[i] = c.value + i * 3;
+			for (j = 0; j < h; ++j)
+				for (i = 0; i < w; ++i)
+					expect[y + j][bx + x + i] = b[j * w + i];
+			c.op = RT_ST7735R_RENDER_BLIT;
+			c.format = RT_ST7735R_WRITE_COLOR_PIXEL;
+			c.buffer = b;
+			c.release = release;
+			c.arg = &released[p][it];
+			__atomic_fetch_add(&blits, 1, __ATOMIC_RELAXED);
+			/* the second half of a blit split in two continues the first */
+			if (k == 4 && h > 1)
+			{
+				struct rt_st7735r_render_cmd half = c;
+
+				half.rect.height = h / 2;
+				half.release = RT_NULL;
+				post(&half);
+				c.rect.y += h / 2;
+				c.rect.height -= h / 2;
+				c.buffer = b + w * (h / 2);
+			}
+		}
+		post(&c);
+		/* the buffers are reused after 64 posts */
+		if (it % 32 == 31)
+			st7735r_render_sync(lcd);
+	}
+	return RT_NULL;
+}
+
+int main(void)
+{
+	struct rt_st7735r_render_stats st;
+	struct rt_st7735r_render_cmd fill = {0};
+	pthread_t th[PRODUCERS];
+	int i, j, once = 1, total = 0, ipc;
+
+	__rt_init_st7735r_hw_init();
+	lcd = (rt_st7735r_t)rt_device_find("lcd0");
+	ipc = sim_ipc_live;
+	sim_thread_fail = 1;
+	CHECK(rt_device_open(&lcd->parent, 0) != RT_EOK);
+	CHECK(lcd->render == RT_NULL && sim_ipc_live == ipc && sim_threads_idle == 0);
+	CHECK(st7735r_render_post(lcd, &fill, RT_WAITING_NO) == -RT_ERROR);
+	CHECK(rt_device_open(&lcd->parent, 0) == RT_EOK && lcd->render != RT_NULL);
+	sim.latency_us = 2;
+	for (i = 0; i < PRODUCERS; ++i)
+		pthread_create(&th[i], RT_NULL, producer, (void *)(long)i);
+	for (i = 0; i < PRODUCERS; ++i)
+		pthread_join(th[i], RT_NULL);
+	CHECK(rt_device_control(&lcd->parent, RT_ST7735R_RENDER_SYNC, RT_NULL) == RT_EOK);
+	CHECK(test_compare(&sim, expect[0], 0, 0, 128, 160) == 0);
+
+	for (i = 0; i < PRODUCERS; ++i)
+		for (j = 0; j < OPS; ++j)
+		{
+			once &= released[i][j] <= 1;
+			total += released[i][j];
+		}
+	CHECK(once);
+	CHECK(total == blits);
+
+	rt_device_control(&lcd->parent, RT_ST7735R_GET_RENDER_STATS, &st);
+	printf("posted %u, executed %u, merged %u, batches %u, ring full %u, depth max %u\n", st.posted, st.executed, st.merged, st.batches, st.full, st.depth_max);
+	return test_done("render");
+}
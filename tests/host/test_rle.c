@@ -0,0 +1,78 @@
+/*
+ * RLE565 and index8 images through rt_device_write and show_pixel in every
+ * interface pixel format, whole frames and the start of a stream in odd
+ * sized windows.
+ */
+
+#include "test.h"
+
+static rt_uint16_t img[128 * 160], img8[128 * 160], pal[256];
+static rt_uint8_t rle[128 * 160 * 3], idx[128 * 160];
+
+/* flat blocks with a noisy band, so there are long runs and literals */
+static void make_images(void)
+{
+	int x, y, i;
+
+	for (i = 0; i < 256; ++i)
+		pal[i] = rand();
+	for (y = 0; y < 160; ++y)
+		for (x = 0; x < 128; ++x)
+		{
+			i = y * 128 + x;
+			img[i] = y >= 60 && y < 70 ? rand() : (x / 21) * 0x2104 + (y / 13) * 0x0841;
+			idx[i] = (x * 3 + y * 7) & 0xFF;
+			img8[i] = pal[idx[i]];
+		}
+}
+
+int main(void)
+{
+#ifdef PKG_ST7735R_USING_ASYNC
+	rt_st7735r_t lcd = test_open(RT_DEVICE_FLAG_DMA_TX);
+#else
+	rt_st7735r_t lcd = test_open(0);
+#endif
+	static const rt_uint8_t colmods[] = {RT_ST7735R_COLMOD_16BIT, RT_ST7735R_COLMOD_12BIT, RT_ST7735R_COLMOD_18BIT};
+	rt_device_t dev = &lcd->parent;
+	struct rt_st7735r_rect all = {0, 0, 128, 160}, s1 = {33, 17, 64, 37}, s2 = {3, 101, 61, 41};
+	unsigned m;
+	int n;
+
+	make_images();
+	n = test_rle_encode(img, 128 * 160, rle, 0);
+	printf("rle image: %d bytes, %d raw\n", n, 128 * 160 * 2);
+	CHECK(rt_device_control(dev, RT_ST7735R_SET_PALETTE, pal) == RT_EOK);
+	for (m = 0; m < sizeof(colmods); ++m)
+	{
+		rt_uint8_t colmod = colmods[m];
+
+		rt_device_control(dev, RT_ST7735R_SET_COLMOD, &colmod);
+		rt_device_control(dev, RT_ST7735R_SET_RECT, &all);
+		sim_reset_counters(&sim);
+		CHECK(rt_device_write(dev, RT_ST7735R_WRITE_RLE565_PIXEL, rle, 128 * 160) == 128 * 160);
+		rt_device_control(dev, RT_ST7735R_WAIT_FLUSH, RT_NULL);
+		printf("colmod %d rle: %lu bytes in %lu transfers\n", colmod, sim.bytes, sim.transfers);
+		CHECK(test_compare(&sim, img, 0, 0, 128, 160) == 0);
+
+		sim_reset_counters(&sim);
+		CHECK(rt_device_write(dev, RT_ST7735R_WRITE_INDEX8_PIXEL, idx, 128 * 160) == 128 * 160);
+		rt_device_control(dev, RT_ST7735R_WAIT_FLUSH, RT_NULL);
+		printf("colmod %d index8: %lu bytes in %lu transfers\n", colmod, sim.bytes, sim.transfers);
+		CHECK(test_compare(&sim, img8, 0, 0, 128, 160) == 0);
+
+		/* the first pixels of the stream in a smaller window */
+		rt_device_control(dev, RT_ST7735R_SET_RECT, &s1);
+		rt_device_write(dev, RT_ST7735R_WRITE_RLE565_PIXEL, rle, 64 * 37);
+		rt_device_control(dev, RT_ST7735R_WAIT_FLUSH, RT_NULL);
+		CHECK(test_compare(&sim, img, 33, 17, 64, 37) == 0);
+
+		rt_device_control(dev, RT_ST7735R_SET_RECT, &s2);
+		rt_device_write(dev, RT_ST7735R_WRITE_RLE565_PIXEL, rle, 61 * 41);
+		rt_device_control(dev, RT_ST7735R_WAIT_FLUSH, RT_NULL);
+		CHECK(test_compare(&sim, img, 3, 101, 61, 41) == 0);
+		CHECK(st7735r_show_pixel(lcd, RT_ST7735R_WRITE_INDEX8_PIXEL, idx, 61 * 41) == RT_EOK);
+		CHECK(test_compare(&sim, img8, 3, 101, 61, 41) == 0);
+	}
+	return test_done("rle");
+}
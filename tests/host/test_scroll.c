@@ -0,0 +1,101 @@
+/*
+ * Hardware scrolling: lines drawn through SET_SCROLL_LINE land where the
+ * panel shows them after any scroll offset, for a whole-screen area, a
+ * part of the screen and a one-line area, in every orientation of panels
+ * on a 132x162 and a 128x160 GRAM.
+ */
+
+#include "test.h"
+
+static rt_uint16_t mem[200];
+
+/* what the panel shows at logical (x, y), after the vertical scroll */
+static rt_uint16_t shown(struct sim_panel *p, int ori, int offx, int offy, int x, int y)
+{
+	int gx, gy;
+
+	test_gram_xy(ori, offx, offy, x, y, &gx, &gy);
+	if (p->vsa && gy >= p->tfa && gy < p->tfa + p->vsa)
+		gy = p->tfa + (gy - p->tfa + p->vsp - p->tfa) % p->vsa;
+	return p->gram[gy][gx];
+}
+
+static void scroll_panel(rt_st7735r_t lcd, rt_uint8_t panel, int gram_width, int gram_height, int offx, int offy)
+{
+	rt_device_t dev = &lcd->parent;
+	rt_uint8_t ori;
+	int a, it, l, k, bad = 0;
+
+	sim.gram_width = gram_width;
+	sim.gram_height = gram_height;
+	rt_device_control(dev, RT_ST7735R_SET_PANEL, &panel);
+	rt_device_control(dev, RT_ST7735R_REINIT, RT_NULL);
+	for (a = 0; a < 12; ++a)
+	{
+		int landscape, lines, across;
+		struct rt_st7735r_scroll_area ar;
+		int off = 0;
+
+		ori = a / 3;
+		CHECK(rt_device_control(dev, RT_ST7735R_SET_ORI, &ori) == RT_EOK);
+		landscape = lcd->ori & 1;
+		lines = landscape ? lcd->width : lcd->height;
+		across = landscape ? lcd->height : lcd->width;
+		ar = a % 3 == 0 ? (struct rt_st7735r_scroll_area){0, lines} : a % 3 == 1 ? (struct rt_st7735r_scroll_area){10, lines - 30} : (struct rt_st7735r_scroll_area){5, 1};
+
+		CHECK(rt_device_control(dev, RT_ST7735R_SET_SCROLL_AREA, &ar) == RT_EOK);
+		CHECK(sim.tfa + sim.vsa + sim.bfa == gram_height);
+		for (l = 0; l < lines; ++l)
+		{
+			rt_uint16_t line = l;
+
+			mem[l] = rand();
+			rt_device_control(dev, RT_ST7735R_SET_SCROLL_LINE, &line);
+			st7735r_fill_color(lcd, mem[l]);
+		}
+		srand(a);
+		for (it = 0; it < 300; ++it)
+		{
+			if (it % 2)
+			{
+				rt_uint16_t o = rand() % 400;
+
+				rt_device_control(dev, RT_ST7735R_SET_SCROLL, &o);
+				off = o % ar.height;
+			}
+			else
+			{
+				rt_uint16_t line = rand() % lines, c = rand();
+				int m = line >= ar.top && line < ar.top + ar.height ? ar.top + (line - ar.top + off) % ar.height : line;
+
+				rt_device_control(dev, RT_ST7735R_SET_SCROLL_LINE, &line);
+				st7735r_fill_color(lcd, c);
+				mem[m] = c;
+			}
+			for (l = 0; l < lines; ++l)
+			{
+				int m = l >= ar.top && l < ar.top + ar.height ? ar.top + (l - ar.top + off) % ar.height : l;
+
+				for (k = 0; k < across; k += 7)
+					bad += shown(&sim, ori, offx, offy, landscape ? l : k, landscape ? k : l) != mem[m];
+			}
+		}
+		printf("panel %d, ori %d, %dx%d GRAM, area %d+%d: mismatch %d\n", panel, lcd->ori, sim.gram_width, sim.gram_height, ar.top, ar.height, bad);
+	}
+	CHECK(bad == 0);
+}
+
+int main(void)
+{
+	rt_st7735r_t lcd = test_open(0);
+	struct rt_st7735r_scroll_area none = {0, 0};
+
+	scroll_panel(lcd, RT_ST7735R_PANEL_BLACKTAB, 132, 162, 4, 2);
+	scroll_panel(lcd, RT_ST7735R_PANEL_REDTAB, 128, 160, 0, 0);
+	scroll_panel(lcd, RT_ST7735R_PANEL_GREENTAB, 132, 162, 2, 1);
+
+	sim.cmd_hist[0x13] = 0;
+	CHECK(rt_device_control(&lcd->parent, RT_ST7735R_SET_SCROLL_AREA, &none) == RT_EOK);
+	CHECK(sim.cmd_hist[0x13] == 1);
+	return test_done("scroll");
+}
@@ -0,0 +1,57 @@
+/*
+ * Write statistics and the lcdstat shell command, which leaves devices of
+ * other drivers alone.
+ */
+
+#include "test.h"
+
+extern void (*__msh_lcdstat)(int, char **);
+
+static int other_calls;
+
+/* a device of some other driver that accepts every control */
+static rt_err_t other_control(rt_device_t dev, int cmd, void *args)
+{
+	(void)dev;
+	(void)cmd;
+	(void)args;
+	other_calls++;
+	return RT_EOK;
+}
+
+int main(void)
+{
+	rt_st7735r_t lcd = test_open(0);
+	rt_device_t dev = &lcd->parent;
+	struct rt_st7735r_stats st;
+	char *argv[] = {"lcdstat", RT_NULL};
+	int i;
+
+	CHECK(rt_device_control(dev, RT_ST7735R_RESET_STATS, RT_NULL) == RT_EOK);
+	sim_reset_counters(&sim);
+	for (i = 0; i < 5; ++i)
+		st7735r_clear(lcd, i);
+	CHECK(rt_device_control(dev, RT_ST7735R_GET_STATS, &st) == RT_EOK);
+	CHECK(st.pixels == 5 * 128 * 160);
+	CHECK(st.bytes == sim.bytes);
+	/* a chain of repeated messages counts as one transfer */
+	CHECK(st.transfers > 0 && st.transfers <= sim.transfers);
+	CHECK(st.ramwr == 5);
+	CHECK(st.errors == 0);
+	__msh_lcdstat(1, argv);
+	{
+		static struct rt_device other;
+		char *other_argv[] = {"lcdstat", "cam0", RT_NULL};
+#ifdef RT_USING_DEVICE_OPS
+		static const struct rt_device_ops other_ops = {.control = other_control};
+
+		other.ops = &other_ops;
+#else
+		other.control = other_control;
+#endif
+		CHECK(rt_device_register(&other, "cam0", RT_DEVICE_FLAG_RDWR) == RT_EOK);
+		__msh_lcdstat(2, other_argv);
+		CHECK(other_calls == 0);
+	}
+	return test_done("stats");
+}
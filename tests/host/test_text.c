@@ -0,0 +1,151 @@
+/*
+ * DRAW_TEXT with the built-in 5x7 font and a small proportional 4-bit
+ * font: random strings, clipped at every edge, against a model of the
+ * renderer. Then a page of text against the same glyphs drawn pixel by
+ * pixel with the graphic ops.
+ */
+
+#include "test.h"
+
+static rt_uint16_t expect[160][128];
+
+/* 3x4 cells, 'a' to 'c', coverage ramps */
+static const rt_uint8_t aa_bits[] =
+{
+	0x0F, 0x80, 0x12, 0x30, 0x45, 0x60, 0x78, 0x90,
+	0xAB, 0xC0, 0xDE, 0xF0, 0xFF, 0xF0, 0x00, 0x00,
+	0x1F, 0x10, 0x2E, 0x20, 0x3D, 0x30, 0x4C, 0x40,
+};
+static const rt_uint8_t aa_widths[] = {3, 2, 3};
+static const struct rt_st7735r_font aa = {RT_ST7735R_FONT_4BIT, 3, 4, 'a', 3, aa_widths, aa_bits};
+
+static const char lorem[] = "The quick brown fox jumps over the lazy dog. 0123456789 !?";
+
+static rt_uint16_t blend(rt_uint16_t fg, rt_uint16_t bg, int a)
+{
+	int r = ((fg >> 11) * a + (bg >> 11) * (15 - a) + 7) / 15;
+	int g = (((fg >> 5) & 63) * a + ((bg >> 5) & 63) * (15 - a) + 7) / 15;
+	int b = ((fg & 31) * a + (bg & 31) * (15 - a) + 7) / 15;
+
+	return r << 11 | g << 5 | b;
+}
+
+static void expect_text(rt_st7735r_t lcd, const struct rt_st7735r_text *t)
+{
+	const struct rt_st7735r_font *f = t->font ? t->font : &st7735r_font_5x7;
+	const unsigned char *s;
+	int x = t->x, y = t->y, stride = (f->width * f->bpp + 7) / 8, i, j;
+
+	for (s = (const unsigned char *)t->str; *s; ++s)
+	{
+		int in = *s >= f->first && *s - f->first < f->count, w;
+
+		if (*s == '\n')
+		{
+			x = t->x;
+			y += f->height;
+			continue;
+		}
+		w = f->widths && in && f->widths[*s - f->first] < f->width ? f->widths[*s - f->first] : f->width;
+		for (j = 0; j < f->height; ++j)
+			for (i = 0; i < w; ++i)
+			{
+				int px = x + i, py = y + j, v = 0;
+
+				if (px < 0 || py < 0 || px >= lcd->width || py >= lcd->height)
+					continue;
+				if (in)
+				{
+					const rt_uint8_t *row = f->bitmap + (*s - f->first) * stride * f->height + j * stride;
+					int bit = i * f->bpp;
+
+					v = (row[bit / 8] >> (8 - f->bpp - bit % 8)) & ((1 << f->bpp) - 1);
+				}
+				expect[py][px] = f->bpp == 1 ? (v ? t->fg_color : t->bg_color) : blend(t->fg_color, t->bg_color, v);
+			}
+		x += w;
+	}
+}
+
+int main(void)
+{
+	rt_st7735r_t lcd = test_open(0);
+	rt_device_t dev = &lcd->parent;
+	struct rt_device_graphic_ops *ops = test_ops(lcd);
+	struct rt_st7735r_fill clear = {{0, 0, 128, 160}, 0};
+	struct rt_st7735r_rect r = {3, 4, 10, 10};
+	struct rt_st7735r_text_stats st;
+	struct rt_st7735r_text t;
+	unsigned long set_bytes, set_transfers, set_windows;
+	char buf[80], page[20 * 32];
+	int it, i, l, c, x, y, p = 0, lines = 20, cols = 128 / 6;
+	double t0;
+
+	srand(5);
+	rt_device_control(dev, RT_ST7735R_FILL_RECT, &clear);
+	rt_device_control(dev, RT_ST7735R_SET_RECT, &r);
+	for (it = 0; it < 400; ++it)
+	{
+		int n = rand() % 40;
+
+		for (i = 0; i < n; ++i)
+			buf[i] = rand() % 9 == 0 ? '\n' : rand() % 50 == 0 ? 1 + rand() % 255 : 32 + rand() % 95;
+		buf[n] = 0;
+		t = (struct rt_st7735r_text){rand() % 3 == 0 ? &aa : RT_NULL, buf, rand() % (128 + 60) - 30, rand() % (160 + 40) - 20, rand(), rand()};
+		if (rand() % 4 == 0)
+		{
+			t.fg_color = 0xFFFF;
+			t.bg_color = 0;
+		}
+		CHECK(rt_device_control(dev, RT_ST7735R_DRAW_TEXT, &t) == RT_EOK);
+		expect_text(lcd, &t);
+	}
+	CHECK(test_compare(&sim, expect[0], 0, 0, 128, 160) == 0);
+	CHECK(memcmp(&lcd->rect, &r, sizeof(r)) == 0);
+	rt_device_control(dev, RT_ST7735R_GET_TEXT_STATS, &st);
+	printf("400 random strings: %u glyphs, %u cache hits, %u misses, %u runs\n", st.glyphs, st.hits, st.misses, st.runs);
+
+	/* a page of 5x7 text, glyph by glyph with set_pixel and then as text */
+	sim_reset_counters(&sim);
+	for (l = 0; l < lines; ++l)
+		for (c = 0; c < cols; ++c)
+		{
+			unsigned char ch = lorem[(l * cols + c) % (sizeof(lorem) - 1)];
+			const rt_uint8_t *g = st7735r_font_5x7.bitmap + (ch - 32) * 8;
+
+			for (y = 0; y < 8; ++y)
+				for (x = 0; x < 6; ++x)
+				{
+					rt_uint16_t col = g[y] & (0x80 >> x) ? 0xFFFF : 0x001F;
+
+					ops->set_pixel((const char *)&col, c * 6 + x, l * 8 + y);
+				}
+		}
+	set_bytes = sim.bytes;
+	set_transfers = sim.transfers;
+	set_windows = sim.caset;
+
+	for (l = 0; l < lines; ++l)
+	{
+		for (c = 0; c < cols; ++c)
+			page[p++] = lorem[(l * cols + c) % (sizeof(lorem) - 1)];
+		page[p++] = '\n';
+	}
+	page[p] = 0;
+	t = (struct rt_st7735r_text){RT_NULL, page, 0, 0, 0xFFFF, 0x001F};
+	rt_device_control(dev, RT_ST7735R_RESET_TEXT_STATS, RT_NULL);
+	sim_reset_counters(&sim);
+	CHECK(rt_device_control(dev, RT_ST7735R_DRAW_TEXT, &t) == RT_EOK);
+	expect_text(lcd, &t);
+	CHECK(test_compare(&sim, expect[0], 0, 0, 128, 160) == 0);
+	printf("%d glyphs with set_pixel: %lu bytes, %lu transfers, %lu windows\n", lines * cols, set_bytes, set_transfers, set_windows);
+	printf("%d glyphs as text:        %lu bytes, %lu transfers, %lu windows\n", lines * cols, sim.bytes, sim.transfers, sim.caset);
+	CHECK(sim.bytes < set_bytes);
+
+	t0 = sim_now_us();
+	for (i = 0; i < 200; ++i)
+		rt_device_control(dev, RT_ST7735R_DRAW_TEXT, &t);
+	rt_device_control(dev, RT_ST7735R_GET_TEXT_STATS, &st);
+	printf("page again: %.1f us with the simulator, %u hits, %u misses\n", (sim_now_us() - t0) / 200, st.hits, st.misses);
+	return test_done("text");
+}
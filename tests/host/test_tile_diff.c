@@ -0,0 +1,73 @@
+/*
+ * Whole frames through SUBMIT_FRAME: only the tiles that changed are sent
+ * and the panel always ends up showing the last frame, also after drawing
+ * behind the tile hashes and after a format change.
+ */
+
+#include "test.h"
+
+static rt_uint16_t frame[128 * 160], gray565[128 * 160];
+static rt_uint8_t gray[128 * 160];
+
+int main(void)
+{
+	rt_st7735r_t lcd = test_open(0);
+	rt_device_t dev = &lcd->parent;
+	struct rt_st7735r_frame fr = {RT_ST7735R_WRITE_COLOR_PIXEL, frame};
+	struct rt_st7735r_tile_stats st;
+	unsigned long bytes = 0;
+	int f, k, i, j;
+
+	srand(1);
+	for (i = 0; i < 128 * 160; ++i)
+		frame[i] = rand();
+	for (f = 0; f < 200; ++f)
+	{
+		int changes = f % 50 == 0 ? 40 : rand() % 4;
+
+		for (k = 0; k < changes; ++k)
+		{
+			int x = rand() % 128, y = rand() % 160, w = 1 + rand() % 24, h = 1 + rand() % 24;
+
+			if (f % 37 == 5)
+			{
+				x = 0;
+				w = 128;
+			}
+			for (j = y; j < y + h && j < 160; ++j)
+				for (i = x; i < x + w && i < 128; ++i)
+					frame[j * 128 + i] = rand();
+		}
+		if (f == 120)
+		{
+			struct rt_st7735r_fill fill = {{10, 10, 30, 30}, 0x1234};
+
+			rt_device_control(dev, RT_ST7735R_FILL_RECT, &fill);
+			rt_device_control(dev, RT_ST7735R_INVALIDATE_TILES, RT_NULL);
+		}
+		sim_reset_counters(&sim);
+		CHECK(rt_device_control(dev, RT_ST7735R_SUBMIT_FRAME, &fr) == RT_EOK);
+		bytes += sim.bytes;
+		CHECK(test_compare(&sim, frame, 0, 0, 128, 160) == 0);
+	}
+	rt_device_control(dev, RT_ST7735R_GET_TILE_STATS, &st);
+	printf("%u frames, %u tiles, %u skipped, %u windows, %lu bytes per frame against %d for a full one\n", st.frames, st.tiles, st.skipped, st.windows, bytes / 200, 128 * 160 * 2);
+	CHECK(st.skipped > st.tiles / 2);
+
+	/* a grayscale frame after rgb565 ones is sent whole once */
+	for (i = 0; i < 128 * 160; ++i)
+		gray[i] = rand();
+	fr = (struct rt_st7735r_frame){RT_ST7735R_WRITE_GRAYSCALE_PIXEL, gray};
+	for (f = 0; f < 20; ++f)
+	{
+		for (k = 0; k < 30; ++k)
+			gray[rand() % (128 * 160)] = rand();
+		CHECK(rt_device_control(dev, RT_ST7735R_SUBMIT_FRAME, &fr) == RT_EOK);
+		for (i = 0; i < 128 * 160; ++i)
+			gray565[i] = ((gray[i] >> 3) << 11) | ((gray[i] >> 2) << 5) | (gray[i] >> 3);
+		CHECK(test_compare(&sim, gray565, 0, 0, 128, 160) == 0);
+	}
+	rt_device_control(dev, RT_ST7735R_GET_TILE_STATS, &st);
+	printf("last frame: %u of %u tiles skipped\n", st.last_skipped, st.last_tiles);
+	return test_done("tile_diff");
+}
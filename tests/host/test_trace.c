@@ -0,0 +1,32 @@
+/*
+ * The trace hook sees every byte the bus does.
+ */
+
+#include "test.h"
+
+static unsigned long trace_bytes, trace_transfers, trace_cmds;
+
+static void trace(struct rt_st7735r *dev, rt_bool_t data, const void *buf, rt_size_t len)
+{
+	(void)dev;
+	(void)buf;
+	trace_bytes += len;
+	trace_transfers++;
+	if (!data)
+		trace_cmds++;
+}
+
+int main(void)
+{
+	rt_st7735r_t lcd = test_open(0);
+
+	CHECK(rt_device_control(&lcd->parent, RT_ST7735R_SET_TRACE, (void *)trace) == RT_EOK);
+	sim_reset_counters(&sim);
+	st7735r_clear(lcd, 0x1234);
+	printf("trace: %lu bytes, %lu transfers, %lu commands\n", trace_bytes, trace_transfers, trace_cmds);
+	printf("bus:   %lu bytes, %lu transfers, %lu commands\n", sim.bytes, sim.transfers, sim.cmds);
+	CHECK(trace_bytes == sim.bytes);
+	CHECK(trace_transfers == sim.transfers);
+	CHECK(trace_cmds == sim.cmds);
+	return test_done("trace");
+}
@@ -0,0 +1,60 @@
+/*
+ * Vsync pacing with the TE input and with the scan model: TEON is sent,
+ * paced frames arrive whole and nothing deadlocks, with blocking and
+ * non-blocking writes. The refreshes that showed two frames are printed,
+ * they depend on the host scheduler and are not checked.
+ */
+
+#include <unistd.h>
+
+#include "test.h"
+
+#define FRAMES 20
+
+static rt_uint16_t frame[128 * 160];
+
+static void run(rt_st7735r_t lcd, rt_base_t te_pin)
+{
+	rt_device_t dev = &lcd->parent;
+	struct rt_st7735r_rect all = {0, 0, 128, 160};
+	rt_uint8_t on = 1;
+	int f, i, refreshes, torn;
+	double t0;
+
+	CHECK(rt_device_control(dev, RT_ST7735R_SET_TE_PIN, &te_pin) == RT_EOK);
+	CHECK(rt_device_control(dev, RT_ST7735R_SET_VSYNC, &on) == RT_EOK);
+	CHECK(rt_device_control(dev, RT_ST7735R_WAIT_VSYNC, RT_NULL) == RT_EOK);
+	rt_device_control(dev, RT_ST7735R_SET_RECT, &all);
+	sim_hist_reset(&sim);
+	t0 = sim_now_us();
+	for (f = 0; f < FRAMES; ++f)
+	{
+		for (i = 0; i < 128 * 160; ++i)
+			frame[i] = 0x1000 + f * 0x0101;
+		CHECK(rt_device_write(dev, RT_ST7735R_WRITE_COLOR_PIXEL, frame, 128 * 160) == 128 * 160);
+		rt_device_control(dev, RT_ST7735R_WAIT_FLUSH, RT_NULL);
+		usleep(rand() % 8000);
+	}
+	CHECK(test_compare(&sim, frame, 0, 0, 128, 160) == 0);
+	torn = sim_torn(&sim, &refreshes);
+	printf("%s: %d frames in %.0f ms, %d of %d refreshes torn\n", te_pin >= 0 ? "TE pin" : "scan model", FRAMES, (sim_now_us() - t0) / 1000, torn, refreshes);
+	on = 0;
+	rt_device_control(dev, RT_ST7735R_SET_VSYNC, &on);
+}
+
+int main(void)
+{
+#ifdef PKG_ST7735R_USING_ASYNC
+	rt_st7735r_t lcd = test_open(RT_DEVICE_FLAG_DMA_TX);
+#else
+	rt_st7735r_t lcd = test_open(0);
+#endif
+
+	CHECK(sim.te_on && sim.cmd_hist[0x35] > 0);
+	sim.wire = 1;
+	sim_real_delay = 1;
+	srand(5);
+	run(lcd, sim.te_pin);
+	run(lcd, -1);
+	return test_done("vsync");
+}
@@ -0,0 +1,145 @@
+/*
+ * Random writes, fills and graphic op lines in every interface pixel
+ * format, compared against a model of the panel. Fills are clipped to the
+ * panel, or refused outside it.
+ */
+
+#include "test.h"
+
+static rt_uint16_t expect[160][128];
+static rt_uint16_t px[128 * 160];
+
+static void expect_rect(int x, int y, int w, int h, rt_uint16_t c)
+{
+	int i, j;
+
+	for (j = 0; j < h; ++j)
+		for (i = 0; i < w; ++i)
+			expect[y + j][x + i] = c;
+}
+
+int main(void)
+{
+#ifdef PKG_ST7735R_USING_ASYNC
+	rt_st7735r_t lcd = test_open(RT_DEVICE_FLAG_DMA_TX);
+#else
+	rt_st7735r_t lcd = test_open(0);
+#endif
+	static const rt_uint8_t colmods[] = {RT_ST7735R_COLMOD_12BIT, RT_ST7735R_COLMOD_16BIT, RT_ST7735R_COLMOD_18BIT};
+	struct rt_device_graphic_ops *ops = test_ops(lcd);
+	rt_device_t dev = &lcd->parent;
+	rt_int32_t forever = RT_WAITING_FOREVER;
+	unsigned m;
+	int i, it;
+
+	for (m = 0; m < sizeof(colmods); ++m)
+	{
+		struct rt_st7735r_rect all = {0, 0, 128, 160};
+		rt_uint8_t colmod = colmods[m], got = 0;
+
+		CHECK(rt_device_control(dev, RT_ST7735R_SET_COLMOD, &colmod) == RT_EOK);
+		rt_device_control(dev, RT_ST7735R_GET_COLMOD, &got);
+		CHECK(got == colmod && sim.colmod == colmod);
+
+		/* a full frame */
+		sim_reset_counters(&sim);
+		for (i = 0; i < 128 * 160; ++i)
+			px[i] = i * 7 + m;
+		rt_device_control(dev, RT_ST7735R_SET_RECT, &all);
+		CHECK(rt_device_write(dev, RT_ST7735R_WRITE_COLOR_PIXEL, px, 128 * 160) == 128 * 160);
+		rt_device_control(dev, RT_ST7735R_WAIT_FLUSH, &forever);
+		for (i = 0; i < 128 * 160; ++i)
+			expect[i / 128][i % 128] = test_wire(&sim, px[i]);
+		printf("colmod %d frame: %lu bytes in %lu transfers, %lu dc toggles\n", colmod, sim.bytes, sim.transfers, sim.dc_toggles);
+
+		srand(colmod);
+		for (it = 0; it < 400; ++it)
+		{
+			int x = rand() % 128, y = rand() % 160, w = 1 + rand() % (128 - x), h = 1 + rand() % (160 - y);
+			rt_uint16_t c = rand();
+
+			switch (it % 6)
+			{
+			case 0:
+			{
+				struct rt_st7735r_rect r = {x, y, w, h};
+
+				rt_device_control(dev, RT_ST7735R_SET_RECT, &r);
+				for (i = 0; i < w * h; ++i)
+				{
+					px[i] = rand();
+					expect[y + i / w][x + i % w] = test_wire(&sim, px[i]);
+				}
+				CHECK(rt_device_write(dev, RT_ST7735R_WRITE_COLOR_PIXEL, px, w * h) == (rt_size_t)(w * h));
+				rt_device_control(dev, RT_ST7735R_WAIT_FLUSH, &forever);
+				break;
+			}
+			case 1:
+			{
+				/* every other fill sticks out past the bottom right corner */
+				struct rt_st7735r_fill f = {{x, y, w, h}, c};
+
+				if (it % 4 == 1)
+				{
+					f.rect.width = 128 - x + rand() % 64;
+					f.rect.height = 160 - y + rand() % 64;
+					w = 128 - x;
+					h = 160 - y;
+				}
+				CHECK(rt_device_control(dev, RT_ST7735R_FILL_RECT, &f) == RT_EOK);
+				expect_rect(x, y, w, h, test_wire(&sim, c));
+				break;
+			}
+			case 2:
+				ops->draw_hline((const char *)&c, x, x + w, y);
+				expect_rect(x, y, w, 1, test_wire(&sim, c));
+				break;
+			case 3:
+				ops->draw_vline((const char *)&c, x, y, y + h);
+				expect_rect(x, y, 1, h, test_wire(&sim, c));
+				break;
+			case 4:
+				for (i = 0; i < w; ++i)
+				{
+					px[i] = rand();
+					expect[y][x + i] = test_wire(&sim, px[i]);
+				}
+				ops->blit_line((const char *)px, x, y, w);
+				break;
+			default:
+				for (i = 0; i < 7; ++i)
+				{
+					ops->set_pixel((const char *)&c, (x + i) % 128, y);
+					expect[y][(x + i) % 128] = test_wire(&sim, c);
+				}
+				break;
+			}
+		}
+#ifdef PKG_ST7735R_USING_FRAMEBUFFER
+		/* the graphic ops only drew into the framebuffer */
+		{
+			struct rt_device_rect_info r = {0, 0, 128, 160};
+
+			rt_device_control(dev, RTGRAPHIC_CTRL_RECT_UPDATE, &r);
+		}
+#endif
+		rt_device_control(dev, RT_ST7735R_WAIT_FLUSH, &forever);
+		i = test_compare(&sim, expect[0], 0, 0, 128, 160);
+		printf("colmod %d random ops: mismatch %d\n", colmod, i);
+		CHECK(i == 0);
+	}
+
+	/* an empty fill sends nothing, one outside the panel is refused */
+	{
+		struct rt_st7735r_fill empty = {{10, 10, 0, 5}, 0xFFFF};
+		struct rt_st7735r_fill right = {{128, 0, 10, 10}, 0xFFFF};
+		struct rt_st7735r_fill below = {{0, 160, 10, 10}, 0xFFFF};
+
+		sim_reset_counters(&sim);
+		CHECK(rt_device_control(dev, RT_ST7735R_FILL_RECT, &empty) == RT_EOK);
+		CHECK(rt_device_control(dev, RT_ST7735R_FILL_RECT, &right) == -RT_EINVAL);
+		CHECK(rt_device_control(dev, RT_ST7735R_FILL_RECT, &below) == -RT_EINVAL);
+		CHECK(sim.bytes == 0);
+	}
+	return test_done("write");
+}
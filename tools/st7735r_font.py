@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021 Lee Chun Hei, Leslie
+# SPDX-License-Identifier: MIT
+"""
+Rasterise a TrueType or OpenType font into a struct rt_st7735r_font for the
+st7735r_tft text renderer.
+
+Every character gets a cell of the same size, the line height of the font
+by the widest advance. With --bpp 4 the pixels are anti-aliased coverage
+from 0 to 15, with --bpp 1 they are thresholded at half coverage. Without
+--mono the advance of every character is written to a widths table, so the
+text is drawn proportional.
+
+    st7735r_font.py DejaVuSans.ttf --size 12 -o font_sans12.c
+    st7735r_font.py Terminus.ttf --size 16 --bpp 1 --mono --name font_term16
+"""
+
+import argparse
+import os
+import re
+import sys
+
+
+def rasterise(font, first, last, bpp):
+    from PIL import Image, ImageDraw
+    ascent, descent = font.getmetrics()
+    height = ascent + descent
+    advances = [int(round(font.getlength(chr(c)))) for c in range(first, last + 1)]
+    width = max(advances)
+    glyphs = []
+    for c in range(first, last + 1):
+        image = Image.new('L', (width, height), 0)
+        ImageDraw.Draw(image).text((0, 0), chr(c), fill=255, font=font)
+        levels = [(v * 15 + 127) // 255 if bpp == 4 else int(v >= 128) for v in image.tobytes()]
+        glyphs.append([levels[y * width:(y + 1) * width] for y in range(height)])
+    return width, height, advances, glyphs
+
+
+def pack(glyphs, bpp):
+    out = bytearray()
+    for rows in glyphs:
+        for row in rows:
+            acc = used = 0
+            # MSB first, rows padded to whole bytes
+            for level in row:
+                acc = (acc << bpp) | level
+                used += bpp
+                if used == 8:
+                    out.append(acc)
+                    acc = used = 0
+            if used:
+                out.append(acc << (8 - used))
+    return bytes(out)
+
+
+def c_array(name, values, per_line):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append('    ' + ', '.join('0x%02X' % v for v in values[i:i + per_line]) + ',')
+    return 'static const rt_uint8_t %s[%d] =\n{\n%s\n};\n' % (name, len(values), '\n'.join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Rasterise a font for the st7735r_tft text renderer')
+    parser.add_argument('input')
+    parser.add_argument('-o', '--output', help='C file to write, stdout by default')
+    parser.add_argument('-s', '--size', type=int, required=True, help='pixel size')
+    parser.add_argument('-b', '--bpp', type=int, default=4, choices=[1, 4])
+    parser.add_argument('-r', '--range', default='32-126', help='first-last character code')
+    parser.add_argument('-m', '--mono', action='store_true', help='monospace, no widths table')
+    parser.add_argument('-n', '--name', help='font name, font_<input file name> by default')
+    args = parser.parse_args()
+
+    try:
+        from PIL import ImageFont
+    except ImportError:
+        sys.exit('Pillow is needed to rasterise %s' % args.input)
+    first, last = (int(v, 0) for v in args.range.split('-'))
+    if not 0 <= first <= last <= 255:
+        sys.exit('character codes must be within 0-255')
+    font = ImageFont.truetype(args.input, args.size)
+    width, height, advances, glyphs = rasterise(font, first, last, args.bpp)
+    if width > 255 or height > 255:
+        sys.exit('%dx%d cells do not fit rt_st7735r_font' % (width, height))
+    name = args.name or 'font_' + re.sub(r'\W', '_', os.path.splitext(os.path.basename(args.input))[0])
+    bitmap = pack(glyphs, args.bpp)
+
+    out = ['/* %s at %d px: %dx%d cells, %d-bit, %d bytes, generated by st7735r_font.py */\n'
+           % (os.path.basename(args.input), args.size, width, height, args.bpp, len(bitmap) + (0 if args.mono else len(advances)))]
+    out.append('/* needs PKG_ST7735R_GLYPH_MAX_PIXELS of at least %d */\n\n' % (width * height))
+    out.append('#include "drv_st7735r.h"\n\n')
+    out.append(c_array(name + '_bitmap', list(bitmap), 16) + '\n')
+    if not args.mono:
+        out.append(c_array(name + '_widths', advances, 16) + '\n')
+    out.append('const struct rt_st7735r_font %s =\n{\n' % name)
+    out.append('    .bpp = RT_ST7735R_FONT_%dBIT,\n' % args.bpp)
+    out.append('    .width = %d,\n    .height = %d,\n' % (width, height))
+    out.append('    .first = %d,\n    .count = %d,\n' % (first, last - first + 1))
+    out.append('    .widths = %s,\n' % ('RT_NULL' if args.mono else name + '_widths'))
+    out.append('    .bitmap = %s_bitmap,\n};\n' % name)
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.writelines(out)
+    else:
+        sys.stdout.writelines(out)
+
+
+if __name__ == '__main__':
+    main()
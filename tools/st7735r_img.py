@@ -0,0 +1,199 @@
+#!/usr/bin/env python3
+# Copyright (c) 2021 Lee Chun Hei, Leslie
+# SPDX-License-Identifier: MIT
+"""
+Encode an image into a C array for the st7735r_tft package.
+
+The output is written for rt_device_write() with one of these formats:
+
+    rle     RT_ST7735R_WRITE_RLE565_PIXEL
+    index1  RT_ST7735R_WRITE_INDEX1_PIXEL, palette of up to 2 colors
+    index2  RT_ST7735R_WRITE_INDEX2_PIXEL, palette of up to 4 colors
+    index4  RT_ST7735R_WRITE_INDEX4_PIXEL, palette of up to 16 colors
+    index8  RT_ST7735R_WRITE_INDEX8_PIXEL, palette of up to 256 colors
+    auto    the smallest of the above that holds the image losslessly
+
+The input is any image Pillow can open, or raw little endian rgb565 when
+--size is given. Every encoding is decoded again and compared with the
+input before it is written.
+
+    st7735r_img.py splash.png -o splash.h
+    st7735r_img.py icons.bin --size 32x32 --format index4 --name icon_wifi
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+RLE_RUN = 0x80
+RLE_LONG = 0x40
+RLE_MAX_SHORT = 64
+RLE_MAX_LONG = 16384
+
+INDEX_BITS = {'index1': 1, 'index2': 2, 'index4': 4, 'index8': 8}
+
+
+def load(path, size):
+    if size:
+        width, height = (int(v) for v in size.lower().split('x'))
+        with open(path, 'rb') as f:
+            data = f.read()
+        if len(data) != width * height * 2:
+            sys.exit('%s: expected %d bytes for %dx%d rgb565, got %d' % (path, width * height * 2, width, height, len(data)))
+        return width, height, list(struct.unpack('<%dH' % (width * height), data))
+    try:
+        from PIL import Image
+    except ImportError:
+        sys.exit('Pillow is needed to read %s, or pass raw rgb565 with --size' % path)
+    image = Image.open(path).convert('RGB')
+    pixels = [((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3) for r, g, b in image.getdata()]
+    return image.width, image.height, pixels
+
+
+def rle_header(run, length):
+    flag = RLE_RUN if run else 0
+    if length <= RLE_MAX_SHORT:
+        return bytes([flag | (length - 1)])
+    return bytes([flag | RLE_LONG | ((length - 1) >> 8), (length - 1) & 0xFF])
+
+
+def rle_encode(pixels):
+    out = bytearray()
+    literal = []
+
+    def flush():
+        while literal:
+            part = literal[:RLE_MAX_LONG]
+            del literal[:RLE_MAX_LONG]
+            out.extend(rle_header(False, len(part)))
+            out.extend(struct.pack('<%dH' % len(part), *part))
+
+    i = 0
+    while i < len(pixels):
+        run = 1
+        while i + run < len(pixels) and run < RLE_MAX_LONG and pixels[i + run] == pixels[i]:
+            run += 1
+        # a run of 2 only pays off when it does not split a literal
+        if run >= 3 or (run == 2 and not literal):
+            flush()
+            out.extend(rle_header(True, run))
+            out.extend(struct.pack('<H', pixels[i]))
+        else:
+            literal.extend(pixels[i:i + run])
+        i += run
+    flush()
+    return bytes(out)
+
+
+def rle_decode(data, count):
+    pixels = []
+    pos = 0
+    while len(pixels) < count:
+        header = data[pos]
+        length = header & 0x3F
+        pos += 1
+        if header & RLE_LONG:
+            length = (length << 8) | data[pos]
+            pos += 1
+        length += 1
+        if header & RLE_RUN:
+            pixels.extend(struct.unpack_from('<H', data, pos) * length)
+            pos += 2
+        else:
+            pixels.extend(struct.unpack_from('<%dH' % length, data, pos))
+            pos += length * 2
+    return pixels[:count]
+
+
+def index_encode(pixels, bits):
+    palette = sorted(set(pixels))
+    if len(palette) > 1 << bits:
+        return None, None
+    lookup = {color: i for i, color in enumerate(palette)}
+    out = bytearray()
+    acc = used = 0
+    # packed MSB first across row ends, like the driver reads them
+    for color in pixels:
+        acc = (acc << bits) | lookup[color]
+        used += bits
+        if used == 8:
+            out.append(acc)
+            acc = used = 0
+    if used:
+        out.append(acc << (8 - used))
+    return palette, bytes(out)
+
+
+def index_decode(data, palette, bits, count):
+    mask = (1 << bits) - 1
+    return [palette[(data[i * bits // 8] >> (8 - bits - i * bits % 8)) & mask] for i in range(count)]
+
+
+def encode(pixels, fmt):
+    if fmt == 'rle':
+        data = rle_encode(pixels)
+        if rle_decode(data, len(pixels)) != pixels:
+            sys.exit('rle round trip failed')
+        return None, data
+    bits = INDEX_BITS[fmt]
+    palette, data = index_encode(pixels, bits)
+    if palette is None:
+        return None, None
+    if index_decode(data, palette, bits, len(pixels)) != pixels:
+        sys.exit('%s round trip failed' % fmt)
+    return palette, data
+
+
+def c_array(ctype, name, values, per_line, digits):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append('    ' + ', '.join('0x%0*X' % (digits, v) for v in values[i:i + per_line]) + ',')
+    return 'static const %s %s[%d] =\n{\n%s\n};\n' % (ctype, name, len(values), '\n'.join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Encode an image for the st7735r_tft compressed write formats')
+    parser.add_argument('input')
+    parser.add_argument('-o', '--output', help='C file to write, stdout by default')
+    parser.add_argument('-f', '--format', default='auto', choices=['auto', 'rle'] + sorted(INDEX_BITS))
+    parser.add_argument('-n', '--name', help='array name, the input file name by default')
+    parser.add_argument('-s', '--size', help='WxH of a raw little endian rgb565 input')
+    args = parser.parse_args()
+
+    width, height, pixels = load(args.input, args.size)
+    name = args.name or re.sub(r'\W', '_', os.path.splitext(os.path.basename(args.input))[0])
+
+    formats = ['rle'] + sorted(INDEX_BITS) if args.format == 'auto' else [args.format]
+    best = None
+    for fmt in formats:
+        palette, data = encode(pixels, fmt)
+        if data is None:
+            continue
+        size = len(data) + (len(palette) * 2 if palette else 0)
+        if best is None or size < best[0]:
+            best = (size, fmt, palette, data)
+    if best is None:
+        sys.exit('%d colors do not fit %s' % (len(set(pixels)), args.format))
+    size, fmt, palette, data = best
+
+    out = ['/* %s: %dx%d, %s, %d bytes (%d as rgb565), generated by st7735r_img.py */\n'
+           % (os.path.basename(args.input), width, height, fmt, size, width * height * 2)]
+    out.append('#define %s_WIDTH %d\n' % (name.upper(), width))
+    out.append('#define %s_HEIGHT %d\n' % (name.upper(), height))
+    code = 'RT_ST7735R_WRITE_RLE565_PIXEL' if fmt == 'rle' else 'RT_ST7735R_WRITE_%s_PIXEL' % fmt.upper()
+    out.append('#define %s_FORMAT %s\n\n' % (name.upper(), code))
+    if palette:
+        out.append(c_array('rt_uint16_t', name + '_palette', palette, 8, 4) + '\n')
+    out.append(c_array('rt_uint8_t', name, list(data), 16, 2))
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.writelines(out)
+    else:
+        sys.stdout.writelines(out)
+
+
+if __name__ == '__main__':
+    main()